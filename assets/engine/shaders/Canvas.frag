@@ -0,0 +1,17 @@
+#version 330 core
+
+uniform sampler2D tex;
+
+in vec2 tex_coord;
+in vec4 color;
+
+void main()
+{
+	// Untextured quads sample a white block of the atlas.
+	gl_FragData[0] = texture(tex, tex_coord) * color;
+	
+	if (gl_FragData[0].a < 0.3)
+		discard;
+	
+	gl_FragData[3] = vec4(0.2, 0.2, 0.2, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 330 core
+
+layout (location = 0) in vec2 a_position;
+layout (location = 1) in vec2 a_tex_coord;
+layout (location = 2) in vec4 a_color;
+
+uniform mat4 projection;
+
+out vec2 tex_coord;
+out vec4 color;
+
+void main()
+{
+	tex_coord = a_tex_coord;
+	color = a_color;
+	
+	gl_Position = projection * vec4(a_position, 0.0, 1.0);
+}
\ No newline at end of file
@@ -13,17 +13,14 @@ uniform sampler2DShadow shadow_map_near;
 
 uniform mat4 inv_proj;
 uniform mat4 inv_view;
-uniform mat4 light_matrix_far;
-uniform mat4 light_matrix_middle;
-uniform mat4 light_matrix_near;
+
+#include "Uniforms.glsl"
 
 uniform vec3 cam_pos;
 uniform vec3 light_pos;
 uniform bool clouds_enabled;
 uniform bool lighting_enabled;
-uniform vec3 light_dir;
 uniform vec3 ambient;
-uniform vec3 view_pos;
 uniform vec3 light_color;
 uniform float specular_strength;
 uniform float specular_power;
@@ -211,8 +208,8 @@ vec3 get_specular()
 	if (material == vec3(1.0, 0.0, 0.0))
 		return vec3(1.0);
 	
-	vec3 view_dir = (view_pos - position) / distance_from_camera;
-	vec3 reflect_dir = reflect(light_dir, normal);
+	vec3 view_dir = (camera_position - position) / distance_from_camera;
+	vec3 reflect_dir = reflect(light_direction, normal);
 	float spec = pow(max(dot(view_dir, reflect_dir), 0.0), 32);
 	return 200.0 * spec * light_color;
 }
@@ -222,7 +219,7 @@ vec3 lighting()
 	if (!lighting_enabled)
 		return vec3(1.0);
 	
-	float diff = dot(normal, light_dir);
+	float diff = dot(normal, light_direction);
 	vec3 diffuse = diff * vec3(1.5);
 	vec3 specular = get_specular() * vec3(0.01);
 	float ssao = 1.0;
@@ -300,7 +297,7 @@ void main()
 
 	position = texture2D(g_position, tex_coords).rgb;
 	normal = texture2D(g_normal, tex_coords).rgb;
-	distance_from_camera = length(view_pos - position);
+	distance_from_camera = length(camera_position - position);
 	
 	if (material == vec3(0.2, 0.2, 0.2))
 	{
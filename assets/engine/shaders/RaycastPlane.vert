@@ -4,7 +4,8 @@ layout (location = 0) in vec3 a_position;
 layout (location = 1) in vec3 a_normal;
 layout (location = 2) in vec2 a_tex_coord;
 
-uniform mat4 view;
+#include "Uniforms.glsl"
+
 uniform mat4 model;
 
 out vec3 position;
@@ -2,18 +2,18 @@
 
 uniform sampler2D tex;
 
-uniform vec3 color_id;
-uniform vec4 color;
 uniform bool texture_enabled;
 
 in vec2 tex_coord;
 in vec3 normal;
 in vec3 position;
+in vec4 object_color;
+flat in vec3 object_color_id;
 
 void main()
 {
-	float alpha = color.a;
-	vec3 source = color.rgb;
+	float alpha = object_color.a;
+	vec3 source = object_color.rgb;
 		
 	if (texture_enabled)
 	{
@@ -28,5 +28,5 @@ void main()
 	gl_FragData[0] = vec4(source, 1.0);
 	gl_FragData[1] = vec4(position, 1.0);
 	gl_FragData[2] = vec4(normal, 1.0);
-	gl_FragData[3] = vec4(color_id, 1.0);
+	gl_FragData[3] = vec4(object_color_id, 1.0);
 }
\ No newline at end of file
@@ -4,20 +4,33 @@ layout (location = 0) in vec3 a_position;
 layout (location = 1) in vec3 a_normal;
 layout (location = 2) in vec2 a_tex_coord;
 
-uniform mat4 view;
+// Per instance, read instead of the uniforms when drawn instanced by the render queue.
+layout (location = 3) in mat4 a_model;
+layout (location = 7) in vec4 a_color;
+layout (location = 8) in vec3 a_color_id;
+
+#include "Uniforms.glsl"
+
 uniform mat4 model;
+uniform vec4 color;
+uniform vec3 color_id;
+uniform bool instanced;
 
 out vec2 tex_coord;
 out vec3 normal;
 out vec3 position;
+out vec4 object_color;
+flat out vec3 object_color_id;
 
 void main()
 {
-	vec4 pos = model * vec4(a_position, 1.0);
+	vec4 pos = (instanced ? a_model : model) * vec4(a_position, 1.0);
 	
 	tex_coord = a_tex_coord.xy;
 	normal = a_normal;
 	position = pos.xyz;	
+	object_color = instanced ? a_color : color;
+	object_color_id = instanced ? a_color_id : color_id;
 	
 	gl_Position = view * pos;
 }
\ No newline at end of file
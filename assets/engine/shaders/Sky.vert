@@ -2,8 +2,7 @@
 
 layout (location = 0) in vec3 a_position;
 
-uniform mat4 view;
-uniform vec3 camera_position;
+#include "Uniforms.glsl"
 
 out vec3 position;
 
@@ -18,7 +18,6 @@ uniform vec2 selection_pos;
 uniform float selection_radius;
 uniform float selection_width;
 uniform vec4 selection_color;
-uniform vec3 light_direction;
 uniform vec3 terrain_size;
 uniform float water_height;
 
@@ -2,7 +2,8 @@
 
 layout (location = 0) in vec3 a_position;
 
-uniform mat4 view;
+#include "Uniforms.glsl"
+
 uniform mat4 model;
 uniform vec2 offset;
 
@@ -0,0 +1,23 @@
+// Blocks filled by the renderer, FrameData once per frame and ViewData once per pass.
+// Included with #include "Uniforms.glsl" after the #version line, see graphics/uniformblocks.h.
+
+layout (std140) uniform FrameData
+{
+	vec2 window_size;
+	float time;
+};
+
+layout (std140) uniform ViewData
+{
+	// Projection times view of the camera of the pass.
+	mat4 view;
+	mat4 view_matrix;
+	mat4 projection_matrix;
+
+	mat4 light_matrix_far;
+	mat4 light_matrix_middle;
+	mat4 light_matrix_near;
+
+	vec3 camera_position;
+	vec3 light_direction;
+};
@@ -3,11 +3,10 @@
 uniform sampler2D normals;
 uniform sampler2D reflection_tex;
 
-uniform vec3 light_direction;
+#include "Uniforms.glsl"
+
 uniform vec3 light_color;
 uniform vec3 ambient;
-uniform vec3 camera_position;
-uniform float time;
 
 in vec3 position;
 in vec4 screenspace_position;
@@ -1,8 +1,10 @@
 #include "application.h"
 
+#include "binaryserializer.h"
 #include "core/memory.h"
 #include "core/platform/android.h"
 #include "core/platform/platform.h"
+#include "core/threadpool.h"
 #include "core/time.h"
 #include "game/scene.h"
 #include "game/scenemanager.h"
@@ -60,12 +62,18 @@ void Application::InitRenderer() {
 void Application::InitEngine() {
     VIEW->set_application(this);
 
+    StartupTrace::begin("core");
+
     Time::Init();
     ContentManager::Init();
+    ThreadPool::init();
     Serializer::init();
+    BinarySerializer::init();
     CoreNames::init();
     StringUtils::init();
 
+    StartupTrace::begin("input and types");
+
     Mouse::init();
     Keyboard::init();
     MessageHandler::init();
@@ -80,19 +88,31 @@ void Application::InitEngine() {
     INPUT->parent = this;
 
     if (graphics_enabled) {
+        StartupTrace::begin("window and context");
+
         InitGL();
         InitSDL();
         platform->InitGL();
         InitPhysics();
     }
 
+    StartupTrace::begin("audio and fonts");
+
     Audio::init();
     Font::Init();
+
+    StartupTrace::begin("content");
+
     CONTENT->setup();
 
     if (graphics_enabled) {
+        StartupTrace::begin("default resources");
+
         CONTENT->load_default_resources();
         CanvasData::init();
+
+        StartupTrace::begin("renderer");
+
         InitRenderer();
     }
 }
@@ -105,11 +125,19 @@ void Application::FinishDraw() { RENDERER->finish(); }
 
 void Application::Loop() {
     InitEngine();
+
+    StartupTrace::begin("application");
+
     init();
     VIEW->init(WINDOWSIZE_F / 2.0f);
 
     T_LOG("Finished Initialization");
 
+    const Shader::LoadStats& shaders = Shader::get_load_stats();
+    T_LOG("Shaders: " + String(shaders.compiled) + " compiled in " +
+          String(shaders.compile_time * 1000.0f) + " ms, " + String(shaders.cached) +
+          " loaded from the program cache in " + String(shaders.cache_time * 1000.0f) + " ms");
+
     SDL_Event event;
     bool running = true;
 
@@ -119,6 +147,8 @@ void Application::Loop() {
 
     default_target = new RenderTarget;
 
+    StartupTrace::begin("first frame");
+
     // Main Loop
     while (running) {
         TIME->Update();
@@ -159,6 +189,9 @@ void Application::Loop() {
 
         // Sync Update Loop to 60 FPS
         if (i.needsupdate) {
+            CONTENT->process_uploads();
+            CONTENT->process_changes();
+
             TIME->OnUpdate();
             update();
             INPUT->Clean();
@@ -170,6 +203,8 @@ void Application::Loop() {
             FinishDraw();
 
             window->SwapBuffer();  // Switch buffers
+
+            StartupTrace::finish();
         }
 
         GC->free();
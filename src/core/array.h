@@ -71,11 +71,14 @@ class Array {
     // Methods
     typename V::iterator begin() { return vec.begin(); }
     typename V::iterator end() { return vec.end(); }
+    typename V::const_iterator begin() const { return vec.begin(); }
+    typename V::const_iterator end() const { return vec.end(); }
 
     // Data
     VAL& at(int ind) const { return vec[ind]; }
     VAL& get(int ind) { return vec[ind]; }
     VAL& getlast() { return vec[size() - 1]; }
+    const VAL* data() const { return vec.data(); }
     void set(int ind, const VAL& v) { vec[ind] = v; }
     void push_back(const VAL& e) { vec.push_back(e); }
     void push_back_ref(const VAL& e) { vec.push_back(e); }
@@ -0,0 +1,810 @@
+#include "binaryserializer.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "contentmanager.h"
+#include "core/memory.h"
+#include "core/time.h"
+#include "node.h"
+#include "resources/mappedfile.h"
+#include "resources/textfile.h"
+#include "resources/xmldocument.h"
+#include "serializer.h"
+
+BinarySerializer* BinarySerializer::singleton;
+
+BinarySerializer::BinarySerializer() {}
+
+BinarySerializer::~BinarySerializer() {}
+
+//=========================================================================
+// Writing
+//=========================================================================
+
+void BinarySerializer::begin() {
+    buffer.clear();
+    string_indices.clear();
+    strings.clear();
+
+    buffer.resize(sizeof(Header));
+}
+
+std::vector<char> BinarySerializer::finish(uint32_t p_root) {
+    Header header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.string_count = strings.size();
+    header.string_table = buffer.size();
+    header.root = p_root;
+
+    for (int c = 0; c < strings.size(); c++) {
+        write<uint32_t>(strings[c].size());
+        buffer.insert(buffer.end(), strings[c].c_str(), strings[c].c_str() + strings[c].size() + 1);
+    }
+
+    header.size = buffer.size();
+    patch(0, header);
+
+    std::vector<char> result;
+    result.swap(buffer);
+
+    string_indices.clear();
+    strings.clear();
+
+    return result;
+}
+
+uint32_t BinarySerializer::add_string(const String& p_string) {
+    std::string key = p_string;
+    if (string_indices.contains(key)) return string_indices[key];
+
+    uint32_t index = strings.size();
+    strings.push_back(p_string);
+    string_indices[key] = index;
+
+    return index;
+}
+
+template <typename T>
+void BinarySerializer::write(const T& p_value) {
+    const char* bytes = reinterpret_cast<const char*>(&p_value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void BinarySerializer::patch(uint32_t p_offset, const T& p_value) {
+    memcpy(&buffer[p_offset], &p_value, sizeof(T));
+}
+
+std::vector<char> BinarySerializer::serialize(const Variant& p_value) {
+    begin();
+
+    uint32_t root = write_object("root", p_value);
+
+    return finish(root);
+}
+
+bool BinarySerializer::save(const Variant& p_value, const File& p_file) {
+    std::vector<char> data = serialize(p_value);
+
+    std::ofstream stream(p_file.get_absolute_path().c_str(), std::ios::binary);
+    if (!stream.is_open()) {
+        T_ERROR("Could not write file: " + p_file.get_absolute_path());
+        return false;
+    }
+
+    stream.write(data.data(), data.size());
+    return true;
+}
+
+uint32_t BinarySerializer::write_object(const String& p_name, const Variant& p_value) {
+    VariantType type = p_value.get_type();
+    Node* node = dynamic_cast<Node*>(p_value.o);
+    Array<StringName> properties = MMASTER->list_property_names(type);
+
+    uint32_t offset = buffer.size();
+    uint32_t child_count = node ? node->get_child_count() : 0;
+
+    write<uint32_t>(add_string(type.get_type_name().get_source()));
+    write<uint32_t>(add_string(p_name));
+    write<uint8_t>(node ? HAS_CHILDREN : 0);
+    write<uint32_t>(0);
+    write<uint32_t>(child_count);
+    write<uint32_t>(properties.size());
+
+    uint32_t end_offset = offset + 2 * sizeof(uint32_t) + sizeof(uint8_t);
+    uint32_t child_table = buffer.size();
+    buffer.resize(buffer.size() + child_count * sizeof(uint32_t));
+
+    for (int c = 0; c < properties.size(); c++) {
+        write<uint32_t>(add_string(properties[c].get_source()));
+        write_value(properties[c].get_source(),
+                    MMASTER->get_property(type, properties[c])->get->operator()(p_value));
+    }
+
+    for (uint32_t c = 0; c < child_count; c++) {
+        Node* child = node->get_child_by_index(c);
+        patch<uint32_t>(child_table + c * sizeof(uint32_t), write_object(child->get_name(), child));
+    }
+
+    patch<uint32_t>(end_offset, buffer.size());
+
+    return offset;
+}
+
+void BinarySerializer::write_value(const String& p_name, const Variant& p_value) {
+    Variant::Type type = p_value.get_type();
+
+    if (type == Variant::OBJECT && !p_value.o) type = Variant::UNDEF;
+
+    switch (type) {
+        case Variant::BOOL:
+        case Variant::INT:
+        case Variant::FLOAT:
+        case Variant::STRING:
+        case Variant::VEC2:
+        case Variant::VEC3:
+        case Variant::VEC4:
+        case Variant::COLOR:
+        case Variant::TRANSFORM:
+        case Variant::OBJECT:
+            write<uint8_t>(type);
+            break;
+
+        default:
+            // Arrays and matrices are not restored by the XML format either.
+            write<uint8_t>(Variant::UNDEF);
+            return;
+    }
+
+    switch (type) {
+        case Variant::BOOL:
+            write<uint8_t>(p_value.b);
+            break;
+
+        case Variant::INT:
+            write<int32_t>(p_value.i);
+            break;
+
+        case Variant::FLOAT:
+            write<float>(p_value.f);
+            break;
+
+        case Variant::STRING:
+            write<uint32_t>(add_string(p_value.operator String&()));
+            break;
+
+        case Variant::VEC2: {
+            const vec2& v = p_value.operator vec2&();
+            write<float>(v.x);
+            write<float>(v.y);
+            break;
+        }
+
+        case Variant::VEC3: {
+            const vec3& v = p_value.operator vec3&();
+            write<float>(v.x);
+            write<float>(v.y);
+            write<float>(v.z);
+            break;
+        }
+
+        case Variant::VEC4: {
+            const vec4& v = p_value.operator vec4&();
+            write<float>(v.x);
+            write<float>(v.y);
+            write<float>(v.z);
+            write<float>(v.w);
+            break;
+        }
+
+        case Variant::COLOR: {
+            const Color& v = p_value.operator Color&();
+            write<float>(v.x);
+            write<float>(v.y);
+            write<float>(v.z);
+            write<float>(v.w);
+            break;
+        }
+
+        case Variant::TRANSFORM: {
+            const Transform& t = p_value.operator Transform&();
+            vec3 components[3] = {t.get_pos(), t.get_size(), t.get_rotation()};
+
+            for (int c = 0; c < 3; c++) {
+                write<float>(components[c].x);
+                write<float>(components[c].y);
+                write<float>(components[c].z);
+            }
+            break;
+        }
+
+        case Variant::OBJECT:
+            write_object(p_name, p_value);
+            break;
+
+        default:
+            break;
+    }
+}
+
+//=========================================================================
+// Reading
+//=========================================================================
+
+template <typename T>
+T BinarySerializer::Reader::read() {
+    T value = T();
+
+    if (position + sizeof(T) > size) {
+        valid = false;
+        return value;
+    }
+
+    memcpy(&value, data + position, sizeof(T));
+    position += sizeof(T);
+
+    return value;
+}
+
+const char* BinarySerializer::Reader::skip(size_t p_bytes) {
+    if (position + p_bytes > size) {
+        valid = false;
+        return nullptr;
+    }
+
+    const char* result = data + position;
+    position += p_bytes;
+
+    return result;
+}
+
+const String& BinarySerializer::Reader::read_string() {
+    static const String empty;
+
+    uint32_t index = read<uint32_t>();
+    if (index >= uint32_t(strings.size())) {
+        valid = false;
+        return empty;
+    }
+
+    return strings[index];
+}
+
+const StringName& BinarySerializer::Reader::read_name() {
+    static const StringName empty;
+
+    uint32_t index = read<uint32_t>();
+    if (index >= uint32_t(names.size())) {
+        valid = false;
+        return empty;
+    }
+
+    return names[index];
+}
+
+bool BinarySerializer::open(Reader& p_reader, const char* p_data, size_t p_size) const {
+    p_reader.data = p_data;
+    p_reader.size = p_size;
+    p_reader.position = 0;
+
+    Header header = p_reader.read<Header>();
+
+    if (!p_reader.valid || header.magic != MAGIC) {
+        T_ERROR("Not a binary scene file");
+        return false;
+    }
+
+    if (header.version != VERSION) {
+        T_ERROR("Unsupported binary scene version: " + String(int(header.version)));
+        return false;
+    }
+
+    p_reader.position = header.string_table;
+    p_reader.strings.reserve(header.string_count);
+    p_reader.names.reserve(header.string_count);
+
+    for (uint32_t c = 0; c < header.string_count && p_reader.valid; c++) {
+        uint32_t length = p_reader.read<uint32_t>();
+        const char* source = p_reader.skip(length + 1);
+
+        if (!source) break;
+
+        String s = std::string(source, length);
+        p_reader.strings.push_back(s);
+        p_reader.names.push_back(s);
+    }
+
+    if (!p_reader.valid) {
+        T_ERROR("Corrupt binary scene string table");
+        return false;
+    }
+
+    p_reader.position = header.root;
+    return true;
+}
+
+Variant BinarySerializer::deserialize(const char* p_data, size_t p_size) {
+    Stopwatch watch;
+    load_timings = SceneLoadTimings();
+
+    watch.start();
+
+    Reader reader;
+
+    if (!open(reader, p_data, p_size)) return NULL_VAR;
+
+    size_t root = reader.position;
+
+    Array<File> resources;
+    collect_resources(reader, resources);
+
+    load_timings.parse = watch.stop();
+
+    ContentManager::PreloadStats stats = CONTENT->preload(resources);
+    load_timings.resources = stats.count;
+    load_timings.decode = stats.decode_time;
+    load_timings.upload = stats.upload_time;
+
+    watch.start();
+
+    reader.position = root;
+    Variant result = read_object(reader);
+
+    load_timings.instantiate = watch.stop();
+
+    if (!reader.valid) T_ERROR("Corrupt binary scene");
+
+    return result;
+}
+
+Variant BinarySerializer::load(const File& p_file) {
+    MappedFile file(p_file);
+
+    if (!file.is_open()) return NULL_VAR;
+
+    return deserialize(file.get_data(), file.get_size());
+}
+
+Variant BinarySerializer::read_object(Reader& p_reader) {
+    VariantType type = p_reader.read_name();
+    p_reader.read_string();
+    p_reader.read<uint8_t>();
+    uint32_t end = p_reader.read<uint32_t>();
+    uint32_t child_count = p_reader.read<uint32_t>();
+    uint32_t property_count = p_reader.read<uint32_t>();
+    const char* child_table = p_reader.skip(child_count * sizeof(uint32_t));
+
+    if (!p_reader.valid) return NULL_VAR;
+
+    Variant result;
+
+    if (type.derives_from_type<Resource>()) {
+        String file;
+
+        for (uint32_t c = 0; c < property_count && p_reader.valid; c++) {
+            const StringName& name = p_reader.read_name();
+            Variant::Type value_type = Variant::Type(p_reader.read<uint8_t>());
+
+            if (name == StringName("file") && value_type == Variant::STRING)
+                file = p_reader.read_string();
+            else
+                skip_value(p_reader, value_type);
+        }
+
+        p_reader.position = end;
+        return CONTENT->Load(file);
+    }
+
+    if (MMASTER->constructor_exists(type, 0))
+        result = reinterpret_cast<CSTR_0*>(MMASTER->get_constructor(type, 0))->operator()();
+    else {
+        T_ERROR("type " + type.get_type_name().get_source() +
+                " has no default constructor that takes one parameter");
+        p_reader.position = end;
+        return NULL_VAR;
+    }
+
+    for (uint32_t c = 0; c < property_count && p_reader.valid; c++) {
+        const StringName& name = p_reader.read_name();
+        Variant value = read_value(p_reader, Variant::Type(p_reader.read<uint8_t>()));
+
+        ::Property* pr = MMASTER->get_property(type, name);
+
+        if (pr && pr->set) pr->set->operator()(result, value);
+    }
+
+    for (uint32_t c = 0; c < child_count && p_reader.valid; c++) {
+        uint32_t offset;
+        memcpy(&offset, child_table + c * sizeof(uint32_t), sizeof(uint32_t));
+
+        p_reader.position = offset;
+        Variant child = read_object(p_reader);
+        (result.operator Node*())->add_child(child);
+    }
+
+    p_reader.position = end;
+    return result;
+}
+
+void BinarySerializer::collect_resources(Reader& p_reader, Array<File>& r_files) {
+    VariantType type = p_reader.read_name();
+    p_reader.read_string();
+    p_reader.read<uint8_t>();
+    uint32_t end = p_reader.read<uint32_t>();
+    uint32_t child_count = p_reader.read<uint32_t>();
+    uint32_t property_count = p_reader.read<uint32_t>();
+    const char* child_table = p_reader.skip(child_count * sizeof(uint32_t));
+
+    if (!p_reader.valid) return;
+
+    bool is_resource = type.derives_from_type<Resource>();
+
+    for (uint32_t c = 0; c < property_count && p_reader.valid; c++) {
+        const StringName& name = p_reader.read_name();
+        Variant::Type value_type = Variant::Type(p_reader.read<uint8_t>());
+
+        if (is_resource && value_type == Variant::STRING && name == StringName("file"))
+            r_files.push_back(File(p_reader.read_string()));
+        else if (!is_resource && value_type == Variant::OBJECT)
+            collect_resources(p_reader, r_files);
+        else
+            skip_value(p_reader, value_type);
+    }
+
+    for (uint32_t c = 0; c < child_count && p_reader.valid; c++) {
+        uint32_t offset;
+        memcpy(&offset, child_table + c * sizeof(uint32_t), sizeof(uint32_t));
+
+        p_reader.position = offset;
+        collect_resources(p_reader, r_files);
+    }
+
+    p_reader.position = end;
+}
+
+Variant BinarySerializer::read_value(Reader& p_reader, Variant::Type p_type) {
+    switch (p_type) {
+        case Variant::BOOL:
+            return p_reader.read<uint8_t>() != 0;
+
+        case Variant::INT:
+            return int(p_reader.read<int32_t>());
+
+        case Variant::FLOAT:
+            return p_reader.read<float>();
+
+        case Variant::STRING:
+            return p_reader.read_string();
+
+        case Variant::VEC2: {
+            float x = p_reader.read<float>();
+            float y = p_reader.read<float>();
+            return vec2(x, y);
+        }
+
+        case Variant::VEC3: {
+            float x = p_reader.read<float>();
+            float y = p_reader.read<float>();
+            float z = p_reader.read<float>();
+            return vec3(x, y, z);
+        }
+
+        case Variant::VEC4:
+        case Variant::COLOR: {
+            float x = p_reader.read<float>();
+            float y = p_reader.read<float>();
+            float z = p_reader.read<float>();
+            float w = p_reader.read<float>();
+
+            if (p_type == Variant::COLOR) return Color(x, y, z, w);
+            return vec4(x, y, z, w);
+        }
+
+        case Variant::TRANSFORM: {
+            vec3 components[3];
+
+            for (int c = 0; c < 3; c++) {
+                float x = p_reader.read<float>();
+                float y = p_reader.read<float>();
+                float z = p_reader.read<float>();
+                components[c] = vec3(x, y, z);
+            }
+            return Transform(components[0], components[1], components[2]);
+        }
+
+        case Variant::OBJECT:
+            return read_object(p_reader);
+
+        default:
+            return NULL_VAR;
+    }
+}
+
+void BinarySerializer::skip_value(Reader& p_reader, Variant::Type p_type) {
+    switch (p_type) {
+        case Variant::BOOL:
+            p_reader.skip(sizeof(uint8_t));
+            break;
+
+        case Variant::INT:
+        case Variant::FLOAT:
+        case Variant::STRING:
+            p_reader.skip(sizeof(uint32_t));
+            break;
+
+        case Variant::VEC2:
+            p_reader.skip(2 * sizeof(float));
+            break;
+
+        case Variant::VEC3:
+            p_reader.skip(3 * sizeof(float));
+            break;
+
+        case Variant::VEC4:
+        case Variant::COLOR:
+            p_reader.skip(4 * sizeof(float));
+            break;
+
+        case Variant::TRANSFORM:
+            p_reader.skip(9 * sizeof(float));
+            break;
+
+        case Variant::OBJECT: {
+            size_t start = p_reader.position;
+            p_reader.skip(2 * sizeof(uint32_t) + sizeof(uint8_t));
+            uint32_t end = p_reader.read<uint32_t>();
+
+            if (end <= start) p_reader.valid = false;
+            p_reader.position = end;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+//=========================================================================
+// Conversion
+//=========================================================================
+
+std::vector<char> BinarySerializer::convert_from_xml(const String& p_source) {
+    // rapidxml parses in place.
+    String source = p_source;
+
+    XmlDocument doc;
+    doc.open(source);
+
+    begin();
+
+    Array<XmlNode> nodes = doc.get_root().get_children();
+    if (nodes.size() == 0) {
+        T_ERROR("Corrupt");
+        buffer.clear();
+        return buffer;
+    }
+
+    uint32_t root = write_xml_object(nodes[0]);
+
+    return finish(root);
+}
+
+uint32_t BinarySerializer::write_xml_object(const XmlNode& p_node) {
+    Array<XmlNode> nodes = p_node.get_children();
+    Array<XmlAttribute> attributes = p_node.get_attributes();
+
+    Array<XmlNode> children;
+    Array<XmlNode> properties;
+
+    if (nodes.size() == 1) {
+        properties = nodes[0].get_children();
+    } else if (nodes.size() > 1) {
+        children = nodes[0].get_children();
+        properties = nodes[1].get_children();
+    }
+
+    uint32_t offset = buffer.size();
+
+    write<uint32_t>(add_string(attributes.size() > 0 ? attributes[0].get_value() : String()));
+    write<uint32_t>(add_string(p_node.get_name()));
+    write<uint8_t>(nodes.size() > 1 ? HAS_CHILDREN : 0);
+    write<uint32_t>(0);
+    write<uint32_t>(children.size());
+    write<uint32_t>(properties.size());
+
+    uint32_t end_offset = offset + 2 * sizeof(uint32_t) + sizeof(uint8_t);
+    uint32_t child_table = buffer.size();
+    buffer.resize(buffer.size() + children.size() * sizeof(uint32_t));
+
+    Serializer serializer;
+
+    for (int c = 0; c < properties.size(); c++) {
+        Array<XmlAttribute> property_attributes = properties[c].get_attributes();
+        String name = properties[c].get_name();
+
+        write<uint32_t>(add_string(name));
+
+        if (property_attributes.size() >= 2) {
+            VariantType type = property_attributes[0].get_value();
+            write_value(name, serializer.deserialize_value(type, property_attributes[1].get_value()));
+        } else if (properties[c].get_children().size() > 0) {
+            write<uint8_t>(Variant::OBJECT);
+            write_xml_object(properties[c]);
+        } else {
+            write<uint8_t>(Variant::UNDEF);
+        }
+    }
+
+    for (int c = 0; c < children.size(); c++)
+        patch<uint32_t>(child_table + c * sizeof(uint32_t), write_xml_object(children[c]));
+
+    patch<uint32_t>(end_offset, buffer.size());
+
+    return offset;
+}
+
+String BinarySerializer::convert_to_xml(const char* p_data, size_t p_size) {
+    Reader reader;
+
+    if (!open(reader, p_data, p_size)) return String();
+
+    XmlDocument doc;
+    doc.open("");
+
+    XmlNode root = doc.add_node("root", "");
+    read_xml_object(reader, root);
+    root.add_to_document();
+
+    if (!reader.valid) T_ERROR("Corrupt binary scene");
+
+    return doc.get_source();
+}
+
+void BinarySerializer::read_xml_object(Reader& p_reader, XmlNode& p_parent) {
+    XmlDocument& doc = *p_parent.doc;
+
+    const String& type = p_reader.read_string();
+    const String& name = p_reader.read_string();
+    uint8_t flags = p_reader.read<uint8_t>();
+    uint32_t end = p_reader.read<uint32_t>();
+    uint32_t child_count = p_reader.read<uint32_t>();
+    uint32_t property_count = p_reader.read<uint32_t>();
+    const char* child_table = p_reader.skip(child_count * sizeof(uint32_t));
+
+    if (!p_reader.valid) return;
+
+    XmlNode node = doc.add_node(name, "");
+    doc.add_attribute("type", type).add_to_node(node);
+
+    XmlNode properties_node = doc.add_node("properties", "");
+    doc.add_attribute("count", String(int(property_count))).add_to_node(properties_node);
+
+    for (uint32_t c = 0; c < property_count && p_reader.valid; c++) {
+        const String& property_name = p_reader.read_string();
+        Variant::Type value_type = Variant::Type(p_reader.read<uint8_t>());
+
+        if (value_type == Variant::OBJECT) {
+            read_xml_object(p_reader, properties_node);
+            continue;
+        }
+
+        XmlNode property_node = doc.add_node(property_name, "");
+        doc.add_attribute("type", VariantType(value_type).get_type_name())
+            .add_to_node(property_node);
+
+        if (value_type != Variant::UNDEF) {
+            Variant value = read_value(p_reader, value_type);
+            doc.add_attribute("value", SERIALIZER->serialize_value(value))
+                .add_to_node(property_node);
+        }
+
+        property_node.add_to_node(properties_node);
+    }
+
+    if (flags & HAS_CHILDREN) {
+        XmlNode children_node = doc.add_node("children", "");
+        doc.add_attribute("count", String(int(child_count))).add_to_node(children_node);
+
+        for (uint32_t c = 0; c < child_count && p_reader.valid; c++) {
+            uint32_t offset;
+            memcpy(&offset, child_table + c * sizeof(uint32_t), sizeof(uint32_t));
+
+            p_reader.position = offset;
+            read_xml_object(p_reader, children_node);
+        }
+
+        children_node.add_to_node(node);
+    }
+
+    properties_node.add_to_node(node);
+    node.add_to_node(p_parent);
+
+    p_reader.position = end;
+}
+
+bool BinarySerializer::convert_xml_file(const File& p_source, const File& p_target) {
+    TextFile source(p_source);
+    std::vector<char> data = convert_from_xml(source.get_source());
+
+    if (data.size() == 0) return false;
+
+    std::ofstream stream(p_target.get_absolute_path().c_str(), std::ios::binary);
+    if (!stream.is_open()) {
+        T_ERROR("Could not write file: " + p_target.get_absolute_path());
+        return false;
+    }
+
+    stream.write(data.data(), data.size());
+    return true;
+}
+
+bool BinarySerializer::convert_binary_file(const File& p_source, const File& p_target) {
+    MappedFile source(p_source);
+
+    if (!source.is_open()) return false;
+
+    String xml = convert_to_xml(source.get_data(), source.get_size());
+    if (xml.size() == 0) return false;
+
+    TextFile target(p_target);
+    target.write(xml);
+    return true;
+}
+
+//=========================================================================
+// Benchmark
+//=========================================================================
+
+void BinarySerializer::benchmark(const String& p_path, int p_iterations) {
+    String source = TextFile(File(p_path)).get_source();
+    std::vector<char> binary = convert_from_xml(source);
+
+    if (binary.size() == 0 || p_iterations <= 0) return;
+
+    Serializer serializer;
+    Stopwatch watch;
+    float xml_time = 0.0f;
+    float binary_time = 0.0f;
+
+    for (int c = 0; c < p_iterations; c++) {
+        String copy = source;
+
+        watch.start();
+        Variant xml_result = serializer.deserialize(copy);
+        xml_time += watch.stop();
+
+        watch.start();
+        Variant binary_result = deserialize(binary.data(), binary.size());
+        binary_time += watch.stop();
+
+        GC->queue_clean(xml_result);
+        GC->queue_clean(binary_result);
+    }
+
+    xml_time *= 1000.0f / p_iterations;
+    binary_time *= 1000.0f / p_iterations;
+
+    T_LOG(p_path + ": xml " + String(int(source.size())) + " bytes, " + String(xml_time) +
+          " ms; binary " + String(int(binary.size())) + " bytes, " + String(binary_time) + " ms");
+}
+
+SceneLoadTimings BinarySerializer::get_load_timings() const { return load_timings; }
+
+bool BinarySerializer::is_binary(const File& p_file) {
+    return p_file.get_extension() == BINARY_SCENE_EXTENSION;
+}
+
+void BinarySerializer::init() { singleton = new BinarySerializer; }
+
+BinarySerializer* BinarySerializer::get_singleton() { return singleton; }
+
+#undef CLASSNAME
+#define CLASSNAME BinarySerializer
+
+void BinarySerializer::bind_methods() {
+    REG_SINGLETON(BINARYSERIALIZER);
+
+    REG_METHOD(benchmark);
+}
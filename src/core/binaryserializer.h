@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/dictionary.h"
+#include "core/object.h"
+#include "core/serializer.h"
+#include "core/variant/variant.h"
+#include "resources/file.h"
+
+#define BINARYSERIALIZER BinarySerializer::get_singleton()
+
+#define BINARY_SCENE_EXTENSION "tsb"
+
+struct XmlNode;
+
+// Compact binary counterpart of the XML scene format written by Serializer.
+//
+// Layout (little endian):
+//   Header
+//   Object records: type, name, flags, end offset, child count, property count,
+//                   child offsets, typed property blocks, followed by the child records.
+//   String table:   length-prefixed, zero-terminated strings referenced by index.
+class BinarySerializer : public Object {
+    OBJ_DEFINITION(BinarySerializer, Object);
+
+   public:
+    BinarySerializer();
+    ~BinarySerializer();
+
+    static const uint32_t MAGIC = 0x42435354;  // "TSCB"
+    static const uint32_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t string_count;
+        uint32_t string_table;
+        uint32_t root;
+        uint32_t size;
+    };
+
+    std::vector<char> serialize(const Variant& p_value);
+    bool save(const Variant& p_value, const File& p_file);
+
+    Variant deserialize(const char* p_data, size_t p_size);
+    Variant load(const File& p_file);
+
+    SceneLoadTimings get_load_timings() const;
+
+    // Conversion between the XML and binary formats, without instantiating any objects.
+    std::vector<char> convert_from_xml(const String& p_source);
+    String convert_to_xml(const char* p_data, size_t p_size);
+
+    bool convert_xml_file(const File& p_source, const File& p_target);
+    bool convert_binary_file(const File& p_source, const File& p_target);
+
+    // Logs average load times of an XML project and its binary conversion.
+    void benchmark(const String& p_path, int p_iterations);
+
+    static bool is_binary(const File& p_file);
+
+    static void init();
+    static BinarySerializer* get_singleton();
+
+    static void bind_methods();
+
+   private:
+    enum ObjectFlags { HAS_CHILDREN = 1 };
+
+    struct Reader {
+        const char* data;
+        size_t size;
+        size_t position;
+        Array<String> strings;
+        Array<StringName> names;
+
+        bool valid = true;
+
+        template <typename T>
+        T read();
+        const char* skip(size_t p_bytes);
+        const String& read_string();
+        const StringName& read_name();
+    };
+
+    // Writing
+    void begin();
+    std::vector<char> finish(uint32_t p_root);
+
+    uint32_t add_string(const String& p_string);
+    template <typename T>
+    void write(const T& p_value);
+    template <typename T>
+    void patch(uint32_t p_offset, const T& p_value);
+
+    uint32_t write_object(const String& p_name, const Variant& p_value);
+    uint32_t write_xml_object(const XmlNode& p_node);
+    void write_value(const String& p_name, const Variant& p_value);
+
+    // Reading
+    bool open(Reader& p_reader, const char* p_data, size_t p_size) const;
+
+    Variant read_object(Reader& p_reader);
+    Variant read_value(Reader& p_reader, Variant::Type p_type);
+    void skip_value(Reader& p_reader, Variant::Type p_type);
+
+    void collect_resources(Reader& p_reader, Array<File>& r_files);
+
+    void read_xml_object(Reader& p_reader, XmlNode& p_parent);
+
+    std::vector<char> buffer;
+    Dictionary<std::string, uint32_t> string_indices;
+    Array<String> strings;
+
+    SceneLoadTimings load_timings;
+
+    static BinarySerializer* singleton;
+};
@@ -2,7 +2,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "core/definitions.h"
 
@@ -16,9 +18,16 @@
 
 #include "core/application.h"
 #include "core/platform/platform.h"
+#include "core/threadpool.h"
+#include "core/time.h"
+#include "graphics/canvasbatch.h"
 #include "graphics/view.h"
 #include "resources/file.h"
+#include "resources/texturecache.h"
+#include "resources/virtualfilesystem.h"
 #include "titanscript/titanscript.h"
+#include "world/mesh.h"
+#include "world/meshcache.h"
 
 ContentManager* ContentManager::singleton;
 
@@ -28,6 +37,15 @@ ContentManager::ContentManager() {
     SimpleShader = NULL;
     ShadowShader = NULL;
     DefaultFont = NULL;
+
+    async_loading = false;
+    upload_budget = 0.004f;
+    pending_count = 0;
+
+    placeholder_texture = nullptr;
+    placeholder_mesh = nullptr;
+
+    registry.set_evict_callback([this](Resource* p_resource) { forget(p_resource); });
 }
 
 void ContentManager::Init() { singleton = new ContentManager; }
@@ -40,6 +58,8 @@ ContentManager* ContentManager::get_singleton() { return singleton; }
 void ContentManager::bind_methods() {
     REG_SINGLETON(CONTENT);
 
+    REG_METHOD(get_resource_usage);
+
     // REG_METHOD(Load);
 }
 
@@ -62,8 +82,12 @@ void ContentManager::setup() {
     File base_path = View::get_singleton()->get_application()->platform->get_cwd();
     base_path += "titan/assets";
 
+    // A packed copy of the assets folder, built with titan_cook --pack.
+    File archive = base_path.get_absolute_path() + "." + ARCHIVE_EXTENSION;
+    if (archive.is_loose_file()) VFS->mount(archive);
+
     int result = chdir(base_path.get_absolute_path().c_str());
-    if (result == -1) T_ERROR("Could not set working directory");
+    if (result == -1 && !VFS->has_archives()) T_ERROR("Could not set working directory");
 
     assets_directory = base_path;
 }
@@ -107,25 +131,356 @@ Object* ContentManager::Load(const File& p_file) {
     }
 }
 
+ContentManager::PreloadStats ContentManager::preload(const Array<File>& p_files) {
+    struct PendingTexture {
+        File file;
+        std::unique_ptr<TextureCache> cache;
+        SDL_Surface* surface = nullptr;
+    };
+
+    struct PendingMesh {
+        File file;
+        std::unique_ptr<MeshCache> cache;
+        Assimp::Importer importer;
+        const aiScene* scene = nullptr;
+    };
+
+    static StringName Texture2D_type = "Texture2D";
+    static StringName Mesh_type = "Mesh";
+
+    PreloadStats stats;
+
+    // Resources are requested asynchronously while the scene is instantiated.
+    if (async_loading) return stats;
+
+    Stopwatch watch;
+    watch.start();
+
+    std::vector<std::unique_ptr<PendingTexture>> pending_textures;
+    std::vector<std::unique_ptr<PendingMesh>> pending_meshes;
+    std::vector<std::future<void>> tasks;
+
+    auto is_texture_pending = [&](const File& p_file) {
+        if (registry.find(p_file)) return true;
+
+        for (std::unique_ptr<PendingTexture>& t : pending_textures)
+            if (t->file == p_file) return true;
+
+        return false;
+    };
+
+    auto add_texture = [&](const File& p_file) {
+        if (is_texture_pending(p_file)) return;
+
+        PendingTexture* texture = new PendingTexture;
+        texture->file = p_file;
+        texture->cache.reset(new TextureCache(p_file));
+        pending_textures.emplace_back(texture);
+
+        tasks.push_back(THREADPOOL->submit<void>([texture]() {
+            if (!texture->cache->prepare()) texture->surface = Texture2D::decode(texture->file);
+        }));
+    };
+
+    for (int c = 0; c < p_files.size(); c++) {
+        VariantType type = GetType(p_files[c]);
+
+        if (type == Texture2D_type) {
+            add_texture(p_files[c]);
+        } else if (type == Mesh_type) {
+            bool loaded = registry.find(p_files[c]);
+
+            for (std::unique_ptr<PendingMesh>& m : pending_meshes)
+                loaded |= m->file == p_files[c];
+
+            if (loaded) continue;
+
+            PendingMesh* mesh = new PendingMesh;
+            mesh->file = p_files[c];
+            mesh->cache.reset(new MeshCache(mesh->file));
+            pending_meshes.emplace_back(mesh);
+
+            tasks.push_back(THREADPOOL->submit<void>([mesh]() {
+                if (!mesh->cache->open()) mesh->scene = Mesh::read(mesh->importer, mesh->file);
+            }));
+        }
+    }
+
+    // Only the tasks of this preload are waited for, other work on the pool keeps running.
+    auto wait = [&]() {
+        for (std::future<void>& task : tasks) task.wait();
+        tasks.clear();
+    };
+
+    wait();
+
+    // Textures referenced by mesh materials are only known after the import.
+    for (std::unique_ptr<PendingMesh>& mesh : pending_meshes) {
+        if (mesh->cache->is_open()) {
+            for (const String& path : mesh->cache->get_texture_paths()) add_texture(path);
+            continue;
+        }
+
+        if (!mesh->scene) continue;
+
+        aiTextureType types[3] = {aiTextureType_DIFFUSE, aiTextureType_SPECULAR,
+                                  aiTextureType_AMBIENT};
+
+        for (unsigned c = 0; c < mesh->scene->mNumMaterials; c++)
+            for (int t = 0; t < 3; t++) {
+                String path = Material::get_texture_path(mesh->file, mesh->scene->mMaterials[c],
+                                                         types[t]);
+                if (path.size() > 0) add_texture(path);
+            }
+    }
+
+    wait();
+    stats.decode_time = watch.stop();
+
+    // GL uploads stay on this thread.
+    watch.start();
+
+    for (std::unique_ptr<PendingTexture>& texture : pending_textures) {
+        Texture2D* tex = new Texture2D;
+
+        if (!texture->cache->upload(tex))
+            tex->upload(texture->file, texture->surface ? texture->surface
+                                                        : Texture2D::decode(texture->file));
+
+        tex->set_file(texture->file);
+        textures.push_back(tex);
+        registry.add(tex);
+    }
+
+    for (std::unique_ptr<PendingMesh>& mesh : pending_meshes) {
+        Mesh* result;
+
+        if (mesh->cache->is_open()) {
+            result = new Mesh;
+            result->set_file(mesh->file);
+            mesh->cache->build(result);
+        } else if (mesh->scene) {
+            result = new Mesh(mesh->file, mesh->scene);
+            mesh->cache->save(result, mesh->importer);
+        } else {
+            T_ERROR(mesh->importer.GetErrorString());
+            continue;
+        }
+
+        meshes.push_back(result);
+        registry.add(result);
+    }
+
+    stats.upload_time = watch.stop();
+    stats.count = pending_textures.size() + pending_meshes.size();
+
+    return stats;
+}
+
+Texture2D* ContentManager::load_texture_async(const File& p_file, bool p_pin) {
+    Texture2D* cached = registry.find<Texture2D>(p_file);
+    if (cached) {
+        if (p_pin) registry.pin(cached);
+        return cached;
+    }
+
+    Texture2D* tex = new Texture2D;
+    tex->set_file(p_file);
+    tex->set_placeholder(get_placeholder_texture());
+    textures.push_back(tex);
+    registry.add(tex, p_pin);
+
+    pending_count++;
+
+    THREADPOOL->add_task([this, tex, p_file]() {
+        std::shared_ptr<TextureCache> cache = std::make_shared<TextureCache>(p_file);
+        SDL_Surface* surface = cache->prepare() ? nullptr : Texture2D::decode(p_file);
+
+        queue_upload([tex, p_file, cache, surface]() {
+            if (!cache->upload(tex))
+                tex->upload(p_file, surface ? surface : Texture2D::decode(p_file));
+        });
+    });
+
+    return tex;
+}
+
+Mesh* ContentManager::load_mesh_async(const File& p_file) {
+    Mesh* cached = registry.find<Mesh>(p_file);
+    if (cached) return cached;
+
+    Mesh* mesh = new Mesh;
+    mesh->set_file(p_file);
+    mesh->set_placeholder(get_placeholder_mesh());
+    meshes.push_back(mesh);
+    registry.add(mesh);
+
+    pending_count++;
+
+    THREADPOOL->add_task([this, mesh, p_file]() {
+        std::shared_ptr<MeshCache> cache = std::make_shared<MeshCache>(p_file);
+
+        if (cache->open()) {
+            queue_upload([mesh, cache]() { cache->build(mesh); });
+            return;
+        }
+
+        std::shared_ptr<Assimp::Importer> importer = std::make_shared<Assimp::Importer>();
+        const aiScene* scene = Mesh::read(*importer, p_file);
+
+        // Material textures are requested while building, which happens on the render thread.
+        queue_upload([mesh, importer, scene, cache]() {
+            if (scene) {
+                mesh->build(scene);
+                cache->save(mesh, *importer);
+            } else {
+                T_ERROR(importer->GetErrorString());
+            }
+        });
+    });
+
+    return mesh;
+}
+
+SoundEffect* ContentManager::load_sound_effect_async(const File& p_file) {
+    SoundEffect* cached = registry.find<SoundEffect>(p_file);
+    if (cached) return cached;
+
+    SoundEffect* sound = new SoundEffect;
+    sound->set_file(p_file);
+    soundeffects.push_back(sound);
+    registry.add(sound, true);
+
+    pending_count++;
+
+    THREADPOOL->add_task([this, sound, p_file]() {
+        Mix_Chunk* effect = Mix_LoadWAV_RW(VFS->open_rw(p_file), 1);
+        queue_upload([sound, effect]() { sound->set_effect(effect); });
+    });
+
+    return sound;
+}
+
+std::shared_future<Font*> ContentManager::load_font_async(const File& p_file, int p_size) {
+    std::string key = p_file.get_absolute_path();
+
+    auto pending = pending_fonts.find(key);
+    if (pending != pending_fonts.end()) return pending->second;
+
+    std::shared_ptr<std::promise<Font*>> promise = std::make_shared<std::promise<Font*>>();
+    std::shared_future<Font*> result = promise->get_future().share();
+
+    Font* cached = registry.find<Font>(p_file);
+    if (cached) {
+        promise->set_value(cached);
+        return result;
+    }
+
+    pending_fonts[key] = result;
+    pending_count++;
+
+    // SDL_ttf and FreeType are not thread safe, the font is opened on the render thread where its
+    // glyphs are rendered as well. Opening only reads the tables it needs, the rest is lazy.
+    queue_upload([this, promise, p_file, p_size, key]() {
+        Font* f = new Font(p_file, Font::open(p_file, p_size));
+        fonts.push_back(f);
+        registry.add(f, true);
+
+        pending_fonts.erase(key);
+        promise->set_value(f);
+    });
+
+    return result;
+}
+
+void ContentManager::set_async_loading(bool p_async_loading) { async_loading = p_async_loading; }
+
+bool ContentManager::get_async_loading() const { return async_loading; }
+
+void ContentManager::queue_upload(const std::function<void()>& p_upload) {
+    std::unique_lock<std::mutex> lock(upload_mutex);
+    uploads.push(p_upload);
+}
+
+void ContentManager::process_uploads() {
+    Stopwatch watch;
+    watch.start();
+
+    while (true) {
+        std::function<void()> upload;
+
+        {
+            std::unique_lock<std::mutex> lock(upload_mutex);
+            if (uploads.empty()) return;
+
+            upload = uploads.front();
+            uploads.pop();
+        }
+
+        upload();
+        pending_count--;
+
+        // At least one upload runs every frame, so large resources can not stall the queue.
+        if (watch.stop() >= upload_budget) return;
+    }
+}
+
+void ContentManager::set_upload_budget(float p_upload_budget) { upload_budget = p_upload_budget; }
+
+float ContentManager::get_upload_budget() const { return upload_budget; }
+
+int ContentManager::get_pending_count() const { return pending_count; }
+
+Texture2D* ContentManager::get_placeholder_texture() {
+    if (placeholder_texture) return placeholder_texture;
+
+    // Grey checkerboard
+    SDL_Surface* surface =
+        SDL_CreateRGBSurface(0, 2, 2, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+    Uint32* pixels = static_cast<Uint32*>(surface->pixels);
+    pixels[0] = pixels[3] = 0xff808080;
+    pixels[1] = pixels[2] = 0xffc0c0c0;
+
+    placeholder_texture = new Texture2D(surface);
+    placeholder_texture->set_filter(Texture::NO_FILTER);
+
+    return placeholder_texture;
+}
+
+Mesh* ContentManager::get_placeholder_mesh() {
+    if (!placeholder_mesh) placeholder_mesh = new Mesh(File("models/primitives/cube.dae"));
+
+    return placeholder_mesh;
+}
+
 Mesh* ContentManager::load_mesh(const File& p_file) {
-    for (int c = 0; c < meshes.size(); c++)
-        if (meshes[c]->get_file() == p_file) return meshes[c];
+    if (async_loading) return load_mesh_async(p_file);
+
+    Mesh* cached = registry.find<Mesh>(p_file);
+    if (cached) return cached;
 
     Mesh* mesh = new Mesh(p_file);
     meshes.push_back(mesh);
+    registry.add(mesh);
     return mesh;
 }
 
 void ContentManager::AddTexture(Texture2D* tex) { textures.push_back(tex); }
 
-Texture2D* ContentManager::LoadTexture(const File& p_file) {
-    for (int c = 0; c < textures.size(); c++)
-        if (textures[c]->get_file() == p_file) return textures[c];
+Texture2D* ContentManager::LoadTexture(const File& p_file, bool p_pin) {
+    if (async_loading) return load_texture_async(p_file, p_pin);
+
+    Texture2D* cached = registry.find<Texture2D>(p_file);
+    if (cached) {
+        if (p_pin) registry.pin(cached);
+        return cached;
+    }
 
     Texture2D* tex = new Texture2D(p_file);
     tex->set_file(p_file);
 
     textures.push_back(tex);
+    registry.add(tex, p_pin);
     return tex;
 }
 
@@ -151,47 +506,54 @@ RawTexture2D* ContentManager::LoadRawTexture(const File& p_file) {
 }
 
 TextFile* ContentManager::LoadTextFile(const File& p_file) {
-    for (int c = 0; c < textfiles.size(); c++)
-        if (textfiles[c]->get_file() == p_file) return textfiles[c];
+    TextFile* cached = registry.find<TextFile>(p_file);
+    if (cached) return cached;
 
     TextFile* text = new TextFile(p_file);
     textfiles.push_back(text);
+    registry.add(text, true);
     return text;
 }
 
 Shader* ContentManager::LoadShader(const File& p_file) {
-    for (Shader* s : shaders)
-        if (s->get_file() == p_file) return s;
+    Shader* cached = registry.find<Shader>(p_file);
+    if (cached) return cached;
 
     Shader* s = new Shader(p_file);
     shaders.push_back(s);
+    registry.add(s, true);
     return s;
 }
 
 Font* ContentManager::LoadFont(const File& p_file, int size) {
-    for (int c = 0; c < fonts.size(); c++)
-        if (fonts[c]->get_file() == p_file) return fonts[c];
+    Font* cached = registry.find<Font>(p_file);
+    if (cached) return cached;
 
     Font* f = new Font(p_file, size);
     fonts.push_back(f);
+    registry.add(f, true);
     return f;
 }
 
 Music* ContentManager::LoadMusic(const File& p_file) {
-    for (int c = 0; c < musics.size(); c++)
-        if (musics[c]->get_file() == p_file) return musics[c];
+    Music* cached = registry.find<Music>(p_file);
+    if (cached) return cached;
 
     Music* s = new Music(p_file);
     musics.push_back(s);
+    registry.add(s, true);
     return s;
 }
 
 SoundEffect* ContentManager::LoadSoundEffect(const File& p_file) {
-    for (int c = 0; c < soundeffects.size(); c++)
-        if (soundeffects[c]->get_file() == p_file) return soundeffects[c];
+    if (async_loading) return load_sound_effect_async(p_file);
+
+    SoundEffect* cached = registry.find<SoundEffect>(p_file);
+    if (cached) return cached;
 
     SoundEffect* s = new SoundEffect(p_file);
     soundeffects.push_back(s);
+    registry.add(s, true);
     return s;
 }
 
@@ -214,20 +576,109 @@ void ContentManager::ReloadAll() {
     RELOAD(textfiles)
 }
 
+void ContentManager::set_hot_reload(bool p_hot_reload) {
+    if (p_hot_reload == get_hot_reload()) return;
+
+    if (p_hot_reload)
+        watcher.watch(assets_directory);
+    else
+        watcher.stop();
+}
+
+bool ContentManager::get_hot_reload() const { return watcher.is_watching(); }
+
+void ContentManager::process_changes() {
+    if (!watcher.is_watching()) return;
+
+    for (const File& file : watcher.poll()) reload(file);
+}
+
+bool ContentManager::reload(const File& p_file) {
+    static const char* stages[] = {"vert", "frag", "geom", "tc", "te", "comp"};
+
+    String path = p_file.get_absolute_path();
+    String extension = p_file.get_extension();
+    Resource* resource = nullptr;
+
+    // Shaders are registered without extension, reloading one reads all of its stages again.
+    for (const char* stage : stages)
+        if (extension == stage)
+            resource = registry.find<Shader>(path.substr(0, path.size() - extension.size() - 1));
+
+    Array<Resource*> targets;
+
+    // Shaders compile included files into their own programs, reloading them reads the include
+    // again as well.
+    if (!resource)
+        for (int c = 0; c < shaders.size(); c++)
+            if (shaders[c]->depends_on(p_file)) targets.push_back(shaders[c]);
+
+    if (!resource && targets.size() == 0) resource = registry.find(p_file);
+    if (resource) targets.push_back(resource);
+
+    bool reloaded = false;
+
+    for (Resource* target : targets) {
+        // Resources that are still being loaded read the new file anyway.
+        if (!target->is_ready()) continue;
+
+        Stopwatch watch;
+        watch.start();
+
+        target->reload();
+        reloaded = true;
+
+        T_LOG("Reloaded " + target->get_file() + " in " + String(watch.stop() * 1000.0f) + " ms");
+    }
+
+    return reloaded;
+}
+
 void ContentManager::FreeAll() {
+    // Uploads still in the queue refer to resources that are about to be freed.
+    THREADPOOL->wait();
+    uploads = std::queue<std::function<void()>>();
+    pending_fonts.clear();
+    pending_count = 0;
+
     fonts.clean();
     musics.clean();
     soundeffects.clean();
     shaders.clean();
     textures.clean();
     textfiles.clean();
+    registry.clear();
 
     Font::Quit();
 }
 
 void ContentManager::free_textfile(const File& p_file) {
-    for (int c = 0; c < textfiles.size(); c++)
-        if (textfiles[c]->get_file() == p_file) textfiles.clear(c);
+    for (int c = 0; c < textfiles.size(); c++) {
+        if (textfiles[c]->get_file() == p_file) {
+            registry.remove(textfiles[c]);
+            textfiles.clear(c);
+        }
+    }
+}
+
+ResourceRegistry* ContentManager::get_registry() { return &registry; }
+
+String ContentManager::get_resource_usage() const { return registry.get_usage_report(); }
+
+void ContentManager::forget(Resource* p_resource) {
+    fonts.clear(dynamic_cast<Font*>(p_resource));
+    musics.clear(dynamic_cast<Music*>(p_resource));
+    soundeffects.clear(dynamic_cast<SoundEffect*>(p_resource));
+    shaders.clear(dynamic_cast<Shader*>(p_resource));
+    textures.clear(dynamic_cast<Texture2D*>(p_resource));
+    textfiles.clear(dynamic_cast<TextFile*>(p_resource));
+    meshes.clear(dynamic_cast<Mesh*>(p_resource));
+
+    // The atlas would hand out the old copy to a texture allocated at the same address.
+    Texture2D* texture = dynamic_cast<Texture2D*>(p_resource);
+    if (texture) CANVAS_BATCH->get_atlas()->remove(texture);
 }
 
+void ContentManager::set_assets_dir(const File& p_directory) { assets_directory = p_directory; }
+
 File ContentManager::get_assets_dir() const { return assets_directory; }
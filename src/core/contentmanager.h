@@ -1,11 +1,18 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <map>
+#include <mutex>
+#include <queue>
 
 #include "resources/audio.h"
 #include "resources/file.h"
+#include "resources/filewatcher.h"
 #include "resources/font.h"
+#include "resources/resourceregistry.h"
 #include "resources/shader.h"
 #include "resources/textfile.h"
 #include "resources/texture.h"
@@ -19,6 +26,8 @@
 class ContentManager : public Object {
     OBJ_DEFINITION(ContentManager, Object);
 
+    friend class ThumbnailCache;
+
    public:
     ContentManager();
 
@@ -31,10 +40,42 @@ class ContentManager : public Object {
 
     void AddTexture(Texture2D* tex);
 
+    struct PreloadStats {
+        int count = 0;
+        float decode_time = 0.0f;
+        float upload_time = 0.0f;
+    };
+
+    // Decodes textures and imports meshes on the worker pool, then uploads them on the calling
+    // thread so that later Load calls for these files hit the cache.
+    PreloadStats preload(const Array<File>& p_files);
+
+    // Asynchronous loading: decoding runs on the worker pool and the returned resource shows a
+    // placeholder until its upload has been processed on the render thread.
+    Texture2D* load_texture_async(const File& p_file, bool p_pin = true);
+    Mesh* load_mesh_async(const File& p_file);
+    SoundEffect* load_sound_effect_async(const File& p_file);
+    std::shared_future<Font*> load_font_async(const File& p_file, int p_size);
+
+    // When enabled, Load, LoadTexture, load_mesh and LoadSoundEffect use the asynchronous path.
+    void set_async_loading(bool p_async_loading);
+    bool get_async_loading() const;
+
+    // Runs queued uploads until the per-frame budget (in seconds) is used, once per frame.
+    void process_uploads();
+
+    void set_upload_budget(float p_upload_budget);
+    float get_upload_budget() const;
+
+    int get_pending_count() const;
+
     // load
     Object* Load(const File& p_file);
     Mesh* load_mesh(const File& p_file);
-    Texture2D* LoadTexture(const File& p_file);
+    // Textures are pinned in the registry since most callers keep the raw pointer, callers that
+    // only hold them in a Ref pass false so they can be evicted once unused. Other types except
+    // meshes are always pinned, models hold their mesh in a Ref.
+    Texture2D* LoadTexture(const File& p_file, bool p_pin = true);
     Texture2D* LoadFontAwesomeIcon(const String& p_name, const vec2i& p_size = vec2i(16),
                                    const Color& p_color = Color::White);
     RawTexture2D* LoadRawTexture(const File& p_file);
@@ -47,9 +88,27 @@ class ContentManager : public Object {
     void ReloadAll();
     void FreeAll();
 
+    // Hot reloading: the assets directory is watched and the resources of files that change on
+    // disk are reloaded in place, so the objects that use them pick up the new data.
+    void set_hot_reload(bool p_hot_reload);
+    bool get_hot_reload() const;
+
+    // Reloads the resources of the files that changed, once per frame.
+    void process_changes();
+
+    // Reloads the resources loaded from a file and the shaders that include it, returns false if
+    // none were.
+    bool reload(const File& p_file);
+
     // free
     void free_textfile(const File& p_file);
 
+    ResourceRegistry* get_registry();
+
+    // Number of resources and their memory use per type.
+    String get_resource_usage() const;
+
+    void set_assets_dir(const File& p_directory);
     File get_assets_dir() const;
 
     // Default
@@ -72,5 +131,29 @@ class ContentManager : public Object {
     static ContentManager* singleton;
 
    private:
+    // Removes an evicted resource from the containers.
+    void forget(Resource* p_resource);
+
+    void queue_upload(const std::function<void()>& p_upload);
+
+    Texture2D* get_placeholder_texture();
+    Mesh* get_placeholder_mesh();
+
     File assets_directory;
+
+    ResourceRegistry registry;
+    FileWatcher watcher;
+
+    bool async_loading;
+    float upload_budget;
+
+    std::mutex upload_mutex;
+    std::queue<std::function<void()>> uploads;
+    std::atomic<int> pending_count;
+
+    // Fonts requested asynchronously that are not opened yet, by absolute path.
+    std::map<std::string, std::shared_future<Font*>> pending_fonts;
+
+    Texture2D* placeholder_texture;
+    Mesh* placeholder_mesh;
 };
@@ -130,19 +130,34 @@ class State {
     }
 
     void Free() {
+        FreeVars();
+        FreeFuncs();
+    }
+
+    // Leaves the functions, which instances share with their program.
+    void FreeVars() {
         for (std::pair<String, TsVariable*> v : vars) delete v.second;
 
+        vars.clear();
+        poppara.clear();
+    }
+
+    void FreeFuncs() {
         for (std::pair<String, Function*> f : funcs) delete f.second;
 
-        vars.clear();
         funcs.clear();
-        poppara.clear();
     }
 
     bool VarExists(StringName name) { return vars.count(name) > 0; }
+    Array<String> ListVars() {
+        Array<String> result;
+        for (std::pair<String, TsVariable*> v : vars) result.push_back(v.first);
+        return result;
+    }
     void AddVar(StringName name) { vars.set(name, new TsVariable(name)); }
     bool FuncExists(StringName name) { return funcs.count(name) > 0; }
     void AddFunc(Function* func) { funcs.set(func->name, func); }
+    void ShareFuncs(State* p_state) { funcs = p_state->funcs; }
 
     void SetVar(const StringName& name, const Variant& val) {
         if (!VarExists(name))
@@ -23,3 +23,6 @@
 #endif
 
 #define TESTING 1
+
+// Compares the cached GL state with glGet on every call, slow but finds desyncs.
+#define VALIDATE_GL_STATE 0
@@ -7,6 +7,7 @@ Platforms: Android, Linux, Mac OS X and Windows
 */
 
 #include "core/definitions.h"
+#include "core/time.h"
 #include "core/titanscript/scriptapp.h"
 #include "editor/editorapp.h"
 #include "game/gameapp.h"
@@ -22,6 +23,8 @@ Platforms: Android, Linux, Mac OS X and Windows
 #undef main
 
 int main(int argc, char* argv[]) {
+    StartupTrace::begin("construction");
+
     Array<String> args = Array<String>();
 
     for (int c = 1; c < argc; c++) args.push_back(argv[c]);
@@ -10,6 +10,16 @@ void GarbageCollector::queue_free(const Variant& p_var) {
     if (!free_queue.contains(p_var)) free_queue.push_back(p_var);
 }
 
+void GarbageCollector::dequeue(const Object* p_object) {
+    for (int c = clean_queue.size() - 1; c >= 0; c--)
+        if (clean_queue[c].type == Variant::OBJECT && clean_queue[c].o == p_object)
+            clean_queue.clear(c);
+
+    for (int c = free_queue.size() - 1; c >= 0; c--)
+        if (free_queue[c].type == Variant::OBJECT && free_queue[c].o == p_object)
+            free_queue.clear(c);
+}
+
 void GarbageCollector::free() {
     for (int c = 0; c < free_queue.size(); c++) free_queue[c].free();
 
@@ -19,6 +19,9 @@ class GarbageCollector {
     void queue_clean(const Variant& p_var);
     void queue_free(const Variant& p_var);
 
+    // Takes p_object out of both queues, before it is deleted elsewhere.
+    void dequeue(const Object* p_object);
+
     void free();
     void clean();
 
@@ -1,9 +1,12 @@
 #include "node.h"
 
 #include "core/memory.h"
-#include "serializer.h"
+#include "core/prefab.h"
+
+uint64_t Node::last_instance_id = 0;
 
 Node::Node() {
+    instance_id = ++last_instance_id;
     parent = nullptr;
     children = Vector<Node>();
     name = "";
@@ -35,6 +38,19 @@ void Node::remove_child(Node* p_child) {
     // children_changed();
 }
 
+void Node::release_child(Node* p_child) {
+    children.clear(p_child);
+    p_child->parent = nullptr;
+}
+
+void Node::move_child(Node* p_child, int p_index) {
+    int index = children.getindex(p_child);
+    if (index == -1 || index == p_index) return;
+
+    children.clear(index);
+    children.insert(std::min(p_index, children.size()), p_child);
+}
+
 void Node::clean() {
     int size = children.size();
     for (int c = 0; c < size; c++) {
@@ -44,10 +60,10 @@ void Node::clean() {
     }
 }
 
+Node* Node::clone() const { return Prefab::clone(const_cast<Node*>(this)).operator Node*(); }
+
 Node* Node::duplicate() {
-    Serializer serializer;
-    String source = serializer.serialize(this);
-    Node* result = serializer.deserialize(source);
+    Node* result = clone();
     get_parent()->add_child(result);
     return result;
 }
@@ -82,6 +98,8 @@ String Node::get_name() const { return name; }
 
 int Node::get_index(Node* p_child) const { return children.getindex(p_child); }
 
+uint64_t Node::get_instance_id() const { return instance_id; }
+
 void Node::children_changed() {
     emit_signal("children_changed");
 
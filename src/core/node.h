@@ -12,10 +12,22 @@ class Node : public Scriptable {
     virtual void add_child(Node* p_child);
     virtual void remove_child(Node* p_child);
 
+    // Detaches p_child without queuing it or its children for cleaning, the caller keeps or
+    // deletes it.
+    virtual void release_child(Node* p_child);
+
+    // Moves p_child to p_index in the child order.
+    virtual void move_child(Node* p_child, int p_index);
+
     void clean();
 
+    // Copies this node and its children through the reflection tables, see Prefab::clone.
+    Node* clone() const;
     Node* duplicate();
 
+    // Called by clone once the properties of the copy are set, for state that is no property.
+    virtual void clone_to(Node*) const {}
+
     Node* get_child_by_index(int p_index);
     Node* get_child(const String& p_name);
 
@@ -53,6 +65,9 @@ class Node : public Scriptable {
 
     void children_changed();
 
+    // Unique for the lifetime of the program, unlike the address of the node.
+    uint64_t get_instance_id() const;
+
     static void bind_methods();
 
    protected:
@@ -62,4 +77,7 @@ class Node : public Scriptable {
     String name;
 
    private:
+    uint64_t instance_id;
+
+    static uint64_t last_instance_id;
 };
@@ -0,0 +1,123 @@
+#include "prefab.h"
+
+#include "core/binaryserializer.h"
+#include "core/contentmanager.h"
+#include "core/serializer.h"
+#include "core/titanscript/titanscript.h"
+#include "types/methodmaster.h"
+
+Dictionary<int, Prefab::TypeInfo> Prefab::type_infos;
+
+Prefab::Prefab() { node = nullptr; }
+
+Prefab::Prefab(const String& p_path) : Prefab() {
+    set_file(p_path);
+    load();
+}
+
+Prefab::Prefab(Node* p_node) : Prefab() { set_node(p_node); }
+
+Prefab::~Prefab() {}
+
+void Prefab::set_node(Node* p_node) { node = p_node; }
+
+Node* Prefab::get_node() const { return node; }
+
+Node* Prefab::instantiate() {
+    if (!node) {
+        T_ERROR("Prefab has no node: " + file.get_relative_path());
+        return nullptr;
+    }
+
+    return clone(node).operator Node*();
+}
+
+Node* Prefab::spawn(Node* p_parent) {
+    Node* result = instantiate();
+
+    if (result && p_parent) p_parent->add_child(result);
+
+    return result;
+}
+
+void Prefab::load() {
+    Variant result;
+
+    if (BinarySerializer::is_binary(file)) {
+        result = BINARYSERIALIZER->load(file);
+    } else {
+        TextFile* text_file = CONTENT->LoadTextFile(file);
+        if (!text_file) return;
+
+        Serializer s;
+        result = s.deserialize(text_file->get_source());
+    }
+
+    set_node(result.operator Node*());
+}
+
+Variant Prefab::clone(const Variant& p_value) {
+    if (p_value.type != Variant::OBJECT || !p_value.o) return p_value;
+
+    Object* object = p_value.o;
+    TypeInfo& info = get_type_info(object->get_type());
+
+    if (info.is_script) return object->cast_to_type<TitanScript*>()->CreateNewInstance();
+
+    if (info.is_resource) return p_value;
+
+    if (!info.constructor) {
+        T_ERROR("type " + object->get_type_name().get_source() +
+                " has no default constructor, it can not be cloned");
+        return NULL_VAR;
+    }
+
+    Variant result = info.constructor->operator()();
+
+    for (Property* property : info.properties)
+        property->set->operator()(result, clone(property->get->operator()(p_value)));
+
+    Node* original = dynamic_cast<Node*>(object);
+    if (original) {
+        Node* copy = result.operator Node*();
+        original->clone_to(copy);
+
+        for (int c = 0; c < original->get_child_count(); c++)
+            copy->add_child(clone(original->get_child_by_index(c)).operator Node*());
+    }
+
+    return result;
+}
+
+Prefab::TypeInfo& Prefab::get_type_info(const VariantType& p_type) {
+    if (type_infos.contains(p_type)) return type_infos[p_type];
+
+    TypeInfo& info = type_infos[p_type];
+    info.is_script = p_type.derives_from_type<TitanScript>();
+    info.is_resource = p_type.derives_from_type<Resource>();
+
+    if (MMASTER->constructor_exists(p_type, 0))
+        info.constructor = reinterpret_cast<CSTR_0*>(MMASTER->get_constructor(p_type, 0));
+
+    // Only properties that can be both read and written take part in the copy.
+    Array<StringName> names = MMASTER->list_property_names(p_type);
+
+    for (const StringName& name : names) {
+        Property* property = MMASTER->get_property(p_type, name);
+
+        if (property && property->get && property->set) info.properties.push_back(property);
+    }
+
+    return info;
+}
+
+#undef CLASSNAME
+#define CLASSNAME Prefab
+
+void Prefab::bind_methods() {
+    REG_CSTR(0);
+    REG_CSTR_OVRLD_1(String);
+
+    REG_METHOD(instantiate);
+    REG_METHOD(spawn);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/dictionary.h"
+#include "core/node.h"
+#include "resources/resource.h"
+#include "types/tconstructor.h"
+
+class Property;
+
+// Template node tree that can be instantiated many times without going through the serializer.
+//
+// Instances are built from the reflection tables: plain values are copied, objects are
+// constructed and copied property by property, and resources (meshes, materials, textures,
+// shaders) are shared with the template. Shared resources are treated as immutable, an instance
+// that needs different data assigns its own resource, or for materials edits them through
+// Model::edit_material, which copies a shared material on the first edit.
+// Scripts share their parsed program and only get their own variables.
+class Prefab : public Resource {
+    OBJ_DEFINITION(Prefab, Resource);
+
+   public:
+    Prefab();
+    Prefab(const String& p_path);
+    Prefab(Node* p_node);
+
+    virtual ~Prefab();
+
+    void set_node(Node* p_node);
+    Node* get_node() const;
+
+    Node* instantiate();
+    Node* spawn(Node* p_parent);
+
+    void load() override;
+
+    // Copies a value through the reflection tables, see the class description for the rules.
+    static Variant clone(const Variant& p_value);
+
+    // Reflection data needed to copy objects of a type, also used by Snapshot.
+    struct TypeInfo {
+        bool is_resource = false;
+        bool is_script = false;
+        CSTR_0* constructor = nullptr;
+        Array<Property*> properties;
+    };
+
+    static TypeInfo& get_type_info(const VariantType& p_type);
+
+    static void bind_methods();
+
+   private:
+    static Dictionary<int, TypeInfo> type_infos;
+
+    Node* node;
+};
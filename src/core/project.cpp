@@ -1,5 +1,6 @@
 #include "project.h"
 
+#include "core/binaryserializer.h"
 #include "core/serializer.h"
 #include "graphics/renderer.h"
 #include "world/terrain.h"
@@ -10,7 +11,8 @@ Project::Project() {
 }
 
 Project::Project(const String& p_file) {
-    text_file = new TextFile(p_file);
+    file = p_file;
+    text_file = BinarySerializer::is_binary(file) ? nullptr : new TextFile(file);
     load();
 }
 
@@ -23,9 +25,17 @@ void Project::create() {
 }
 
 void Project::load() {
-    Serializer s;
-
-    Variant project = s.deserialize(text_file->get_source());
+    Variant project;
+
+    if (text_file) {
+        Serializer s;
+        project = s.deserialize(text_file->get_source());
+        T_LOG("Loaded " + file.get_relative_path() + ": " + s.get_load_timings().to_string());
+    } else {
+        project = BINARYSERIALIZER->load(file);
+        T_LOG("Loaded " + file.get_relative_path() + ": " +
+              BINARYSERIALIZER->get_load_timings().to_string());
+    }
 
     default_scene = project.operator Project*()->get_child_by_type<Scene*>();
     add_child(default_scene);
@@ -38,6 +48,11 @@ void Project::save() {
         // DEFERRED_RENDERER->save_fbo(f, "engine/heightmap.bmp", 0);
     }
 
+    if (!text_file) {
+        BINARYSERIALIZER->save(this, file);
+        return;
+    }
+
     Serializer s;
     String source = s.serialize(this);
 
@@ -45,7 +60,8 @@ void Project::save() {
 }
 
 void Project::save_as(const String& p_file) {
-    text_file = new TextFile(p_file);
+    file = p_file;
+    text_file = BinarySerializer::is_binary(file) ? nullptr : new TextFile(file);
 
     save();
 }
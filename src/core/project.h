@@ -32,5 +32,6 @@ class Project : public Node {
     Vector<Scene> scenes;
     Scene* default_scene;
 
+    File file;
     TextFile* text_file;
 };
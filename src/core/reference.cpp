@@ -4,10 +4,18 @@
 
 Referenced::Referenced() { ref_count = 0; }
 
-void Referenced::increase_ref_count() { ref_count++; }
+void Referenced::increase_ref_count() {
+    ref_count++;
+
+    if (ref_count == 1) referenced();
+}
 
 void Referenced::decrease_ref_count() {
     ref_count--;
 
-    if (ref_count == 0) GC->queue_clean(this);
+    if (ref_count == 0) unreferenced();
 }
+
+int Referenced::get_ref_count() const { return ref_count; }
+
+void Referenced::unreferenced() { GC->queue_clean(this); }
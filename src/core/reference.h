@@ -11,36 +11,42 @@ class Referenced : public Object {
     void increase_ref_count();
     void decrease_ref_count();
 
+    int get_ref_count() const;
+
+   protected:
+    // Called when the first reference is taken and when the last one is released.
+    virtual void referenced() {}
+    virtual void unreferenced();
+
    private:
     int ref_count;
 };
 
-// T derives from Referenced
+// T derives from Referenced, other objects are held without counting.
 template <typename T>
 class Ref {
    public:
-    inline Ref(T* p_ref) { referenced = p_ref; }
+    inline Ref(T* p_ref) {
+        referenced = p_ref;
+        increase();
+    }
 
     inline Ref() : Ref(NULL) {}
 
-    inline ~Ref() {
-        if (referenced) {
-            Referenced* ref = reinterpret_cast<Referenced*>(referenced);
+    inline Ref(const Ref<T>& p_r) : Ref(p_r.referenced) {}
 
-            ref->decrease_ref_count();
-        }
-    }
+    inline ~Ref() { decrease(); }
 
     inline void ref(const Ref& p_new) {}
 
     inline void operator=(const Ref<T>& p_r) {
-        referenced = p_r.referenced;
-
-        if (!referenced) return;
+        if (referenced == p_r.referenced) return;
 
-        Referenced* ref = reinterpret_cast<Referenced*>(referenced);
+        T* previous = referenced;
+        referenced = p_r.referenced;
+        increase();
 
-        ref->increase_ref_count();
+        if (previous) release(previous);
     }
 
     inline bool operator<(const Ref<T>& p_r) const { return referenced < p_r.referenced; }
@@ -64,5 +70,21 @@ class Ref {
     inline operator T*() const { return referenced; }
 
    private:
+    inline void increase() {
+        Referenced* ref = dynamic_cast<Referenced*>(referenced);
+
+        if (ref) ref->increase_ref_count();
+    }
+
+    inline void decrease() {
+        if (referenced) release(referenced);
+    }
+
+    static inline void release(T* p_referenced) {
+        Referenced* ref = dynamic_cast<Referenced*>(p_referenced);
+
+        if (ref) ref->decrease_ref_count();
+    }
+
     T* referenced;
 };
@@ -1,13 +1,20 @@
 #include "serializer.h"
 
+#include <cstring>
+#include <string_view>
+
 #include "contentmanager.h"
+#include "core/time.h"
 #include "node.h"
 #include "resources/texture.h"
 #include "resources/xmldocument.h"
+#include "utility/stringutils.h"
 
 Serializer* Serializer::singleton;
 TypeSerializer* TypeSerializer::singleton;
 
+using namespace rapidxml;
+
 Serializer::Serializer() {}
 
 Serializer::~Serializer() {}
@@ -36,7 +43,7 @@ void Serializer::serialize_recursively(const String& p_name, const Variant& p_va
 
     if (var_type == Variant::UNDEF) {
     } else if (var_type != Variant::OBJECT) {
-        doc.add_attribute("value", p_value.ToString()).add_to_node(node);
+        doc.add_attribute("value", serialize_value(p_value)).add_to_node(node);
     } else {
         Node* n = dynamic_cast<Node*>(p_value.o);
         if (n) {
@@ -72,196 +79,391 @@ void Serializer::serialize_recursively(const String& p_name, const Variant& p_va
 }
 
 Variant Serializer::deserialize(const String& p_source) {
+    Stopwatch watch;
+    load_timings = SceneLoadTimings();
+
+    // Phase 1: parse the structure and collect the referenced resources.
+    watch.start();
+
     XmlDocument doc;
     doc.open(p_source);
 
-    return deserialize_recursively(doc.get_root().get_children()[0]);
+    xml_node<>* root = doc.get_root().node;
+    if (!root || !root->first_node()) {
+        T_ERROR("Corrupt");
+        return NULL_VAR;
+    }
+
+    Array<File> resources;
+    collect_resources(root->first_node(), resources);
+
+    load_timings.parse = watch.stop();
+
+    // Phase 2: decode resources in parallel, upload them on this thread.
+    ContentManager::PreloadStats stats = CONTENT->preload(resources);
+    load_timings.resources = stats.count;
+    load_timings.decode = stats.decode_time;
+    load_timings.upload = stats.upload_time;
+
+    // Phase 3: instantiate the nodes, resources now resolve from the cache.
+    watch.start();
+    Variant result = deserialize_node(root->first_node());
+    load_timings.instantiate = watch.stop();
+
+    return result;
 }
 
 Variant Serializer::deserialize_recursively(const XmlNode& p_node) {
-    Array<XmlNode> nodes = p_node.get_children();
+    return deserialize_node(p_node.node);
+}
+
+Variant Serializer::deserialize_node(const xml_node<>* p_node) {
+    const xml_attribute<>* type_attribute = p_node->first_attribute();
+    const xml_node<>* first = p_node->first_node();
 
-    if (nodes.size() == 0 && p_node.get_attributes().size() == 1) {
-        if (p_node.get_attributes()[0].get_value() != "NULL") T_ERROR("Corrupt");
+    if (!first && type_attribute && !type_attribute->next_attribute()) {
+        if (strcmp(type_attribute->value(), "NULL") != 0) T_ERROR("Corrupt");
 
         return NULL_VAR;
-    } else if (nodes.size() == 0 || p_node.get_attributes().size() == 0) {
+    } else if (!first || !type_attribute) {
         T_ERROR("Corrupt");
         return NULL_VAR;
     }
 
-    Array<XmlNode> children;
-    Array<XmlNode> properties;
+    const xml_node<>* children = nullptr;
+    const xml_node<>* properties = first;
 
-    if (nodes.size() == 1) {
-        properties = nodes[0].get_children();
-    } else {
-        children = nodes[0].get_children();
-        properties = nodes[1].get_children();
+    if (first->next_sibling()) {
+        children = first;
+        properties = first->next_sibling();
     }
 
-    Variant result;
-    VariantType type = p_node.get_attributes()[0].get_value();
-    if (type.derives_from_type<Resource>()) {
-        XmlNode file_property;
-        for (XmlNode p : properties) {
-            if (p.get_name() == "file") file_property = p;
+    TypeInfo& info = get_type_info(type_attribute->value(), type_attribute->value_size());
+
+    if (info.is_resource) {
+        const xml_node<>* file_property = nullptr;
+
+        for (const xml_node<>* p = properties->first_node(); p; p = p->next_sibling())
+            if (strcmp(p->name(), "file") == 0) file_property = p;
+
+        if (!file_property) {
+            T_ERROR("Corrupt");
+            return NULL_VAR;
         }
-        Serializer::Property p = deserialize_property(file_property);
-        result = CONTENT->Load(p.value.ToString());
-        return result;
+
+        return CONTENT->Load(deserialize_property(file_property).ToString());
     }
-    if (MMASTER->constructor_exists(type, 0))
-        result = reinterpret_cast<CSTR_0*>(MMASTER->get_constructor(type, 0))->operator()();
-    else {
-        T_ERROR("type " + type.get_type_name().get_source() +
+
+    if (!info.constructor) {
+        T_ERROR("type " + info.type.get_type_name().get_source() +
                 " has no default constructor that takes one parameter");
         return NULL_VAR;
     }
 
-    for (int c = 0; c < properties.size(); c++) {
-        Serializer::Property p = deserialize_property(properties[c]);
+    Variant result = info.constructor->operator()();
 
-        ::Property* pr = MMASTER->get_property(type, p.name);
+    for (const xml_node<>* p = properties->first_node(); p; p = p->next_sibling()) {
+        ::Property* pr = get_setter(info, p->name(), p->name_size());
 
-        if (pr && pr->set) pr->set->operator()(result, p.value);
+        if (pr && pr->set)
+            pr->set->operator()(result, deserialize_property(p));
+        else if (is_object_property(p))
+            deserialize_property(p);
     }
 
-    for (int c = 0; c < children.size(); c++) {
-        Variant child = deserialize_recursively(children[c]);
-        (result.operator Node*())->add_child(child);
+    if (children) {
+        for (const xml_node<>* c = children->first_node(); c; c = c->next_sibling()) {
+            Variant child = deserialize_node(c);
+            (result.operator Node*())->add_child(child);
+        }
     }
 
     return result;
 }
 
-Serializer::Property Serializer::deserialize_property(const XmlNode& p_node) {
-    Serializer::Property result = Serializer::Property();
+void Serializer::collect_resources(const xml_node<>* p_node, Array<File>& r_files) {
+    const xml_attribute<>* type_attribute = p_node->first_attribute();
+    const xml_node<>* first = p_node->first_node();
+
+    if (!first || !type_attribute) return;
 
-    Array<XmlAttribute> attributes = p_node.get_attributes();
-    XmlAttribute a_type = attributes[0];
-    result.name = p_node.get_name();
-    result.type = a_type.get_value();
+    const xml_node<>* children = nullptr;
+    const xml_node<>* properties = first;
 
-    if (attributes.size() < 2) {
-        // is object
-        result.value = deserialize_recursively(p_node);
-        return result;
+    if (first->next_sibling()) {
+        children = first;
+        properties = first->next_sibling();
     }
 
-    XmlAttribute s_value = attributes[1];
-    String value = s_value.get_value();
+    TypeInfo& info = get_type_info(type_attribute->value(), type_attribute->value_size());
 
-    Variant::Type type = result.type.operator Variant::Type();
+    if (info.is_resource) {
+        const xml_node<>* file_property = nullptr;
 
-    switch (type) {
-        case Variant::UNDEF:
-            result.value = NULL_VAR;
-            break;
+        for (const xml_node<>* p = properties->first_node(); p; p = p->next_sibling())
+            if (strcmp(p->name(), "file") == 0) file_property = p;
 
-        case Variant::BOOL:
-            result.value = value == "true" ? true : false;
-            break;
+        if (file_property && !is_object_property(file_property))
+            r_files.push_back(File(file_property->first_attribute()->next_attribute()->value()));
 
-        case Variant::INT:
-            result.value = value.operator int();
-            break;
+        return;
+    }
 
-        case Variant::FLOAT:
-            result.value = value.operator float();
-            break;
+    for (const xml_node<>* p = properties->first_node(); p; p = p->next_sibling())
+        if (is_object_property(p)) collect_resources(p, r_files);
 
-        case Variant::STRING:
-            result.value = value;
-            break;
+    if (children)
+        for (const xml_node<>* c = children->first_node(); c; c = c->next_sibling())
+            collect_resources(c, r_files);
+}
+
+bool Serializer::is_object_property(const xml_node<>* p_node) const {
+    const xml_attribute<>* type_attribute = p_node->first_attribute();
+
+    return !type_attribute || !type_attribute->next_attribute();
+}
+
+Variant Serializer::deserialize_property(const xml_node<>* p_node) {
+    if (is_object_property(p_node)) return deserialize_node(p_node);
+
+    const xml_attribute<>* type_attribute = p_node->first_attribute();
+    const xml_attribute<>* value_attribute = type_attribute->next_attribute();
+
+    Variant::Type type = get_type_info(type_attribute->value(), type_attribute->value_size())
+                             .variant_type;
+
+    return deserialize_value(type, value_attribute->value(),
+                             value_attribute->value() + value_attribute->value_size());
+}
+
+Serializer::TypeInfo& Serializer::get_type_info(const char* p_name, size_t p_size) {
+    std::string_view name(p_name, p_size);
+
+    auto it = type_infos.find(name);
+    if (it != type_infos.end()) return it->second;
+
+    TypeInfo& info = type_infos[std::string(name)];
+    info.type = String(std::string(name));
+    info.variant_type = info.type;
+
+    if (info.variant_type == Variant::OBJECT) {
+        info.is_resource = info.type.derives_from_type<Resource>();
+
+        if (MMASTER->constructor_exists(info.type, 0))
+            info.constructor = reinterpret_cast<CSTR_0*>(MMASTER->get_constructor(info.type, 0));
+    }
+
+    return info;
+}
+
+::Property* Serializer::get_setter(TypeInfo& p_info, const char* p_name, size_t p_size) {
+    std::string_view name(p_name, p_size);
+
+    auto it = p_info.setters.find(name);
+    if (it != p_info.setters.end()) return it->second;
+
+    ::Property* property = MMASTER->get_property(p_info.type, String(std::string(name)));
+    p_info.setters[std::string(name)] = property;
+
+    return property;
+}
+
+namespace {
+// Builds a value in place, a transform is the longest with nine numbers and its labels.
+struct ValueWriter {
+    char buffer[16 * StringUtils::NUMBER_SIZE];
+    char* end = buffer;
+
+    void write(const char* p_text) {
+        size_t length = strlen(p_text);
+        memcpy(end, p_text, length);
+        end += length;
+    }
+
+    void write(float p_value) { end = StringUtils::format_float(end, p_value); }
+
+    void write(const vec3& p_value) {
+        write("{ ");
+        write(p_value.x);
+        write(", ");
+        write(p_value.y);
+        write(", ");
+        write(p_value.z);
+        write(" }");
+    }
+
+    String get() const { return std::string(buffer, end - buffer); }
+};
+}  // namespace
+
+String Serializer::serialize_value(const Variant& p_value) const {
+    ValueWriter writer;
+    Variant::Type type = p_value.get_type();
+
+    switch (type) {
+        case Variant::FLOAT:
+            writer.write(p_value.f);
+            return writer.get();
 
         case Variant::VEC2:
-            result.value = deserialize_vec2(value);
-            break;
+            writer.write("{ ");
+            writer.write(p_value.v2->x);
+            writer.write(", ");
+            writer.write(p_value.v2->y);
+            writer.write(" }");
+            return writer.get();
 
         case Variant::VEC3:
-            result.value = deserialize_vec3(value);
-            break;
+            writer.write(*p_value.v3);
+            return writer.get();
 
         case Variant::VEC4:
-            result.value = deserialize_vec4(value);
-            break;
+            writer.write("{ ");
+            writer.write(p_value.v4->x);
+            writer.write(", ");
+            writer.write(p_value.v4->y);
+            writer.write(", ");
+            writer.write(p_value.v4->z);
+            writer.write(", ");
+            writer.write(p_value.v4->w);
+            writer.write(" }");
+            return writer.get();
 
         case Variant::COLOR:
-            result.value = deserialize_color(value);
-            break;
+            writer.write("{ r = ");
+            writer.write(p_value.c->r);
+            writer.write(", g = ");
+            writer.write(p_value.c->g);
+            writer.write(", b = ");
+            writer.write(p_value.c->b);
+            writer.write(", a = ");
+            writer.write(p_value.c->a);
+            writer.write(" }");
+            return writer.get();
 
         case Variant::TRANSFORM:
-            result.value = deserialize_transform(value);
-            break;
+            writer.write("{ pos: ");
+            writer.write(p_value.t->get_pos());
+            writer.write(", size: ");
+            writer.write(p_value.t->get_size());
+            writer.write(", rotation: ");
+            writer.write(p_value.t->get_rotation());
+            writer.write(" }");
+            return writer.get();
+
+        default:
+            return p_value.ToString();
+    }
+}
 
-        case Variant::ARRAY:
-        case Variant::MAT4:
-            result.value = NULL_VAR;
-            break;
+// Reads up to p_count numbers from a value such as "{ 1, 2, 3 }" or
+// "{ r = 1, g = 0, b = 0, a = 1 }", skipping braces, separators and labels.
+static int parse_floats(const char* p_begin, const char* p_end, float* p_values, int p_count) {
+    int count = 0;
+
+    while (p_begin < p_end && count < p_count) {
+        char c = *p_begin;
+
+        if ((c >= '0' && c <= '9') || c == '-' || c == '.' || c == 'i' || c == 'n') {
+            const char* next = StringUtils::parse_float(p_begin, p_end, p_values[count]);
+
+            if (next != p_begin) {
+                p_begin = next;
+                count++;
+                continue;
+            }
+        }
+
+        p_begin++;
     }
 
-    return result;
-}
+    for (int c = count; c < p_count; c++) p_values[c] = 0.0f;
+
+    if (count < p_count) T_ERROR("Corrupt");
 
-vec2 Serializer::deserialize_vec2(const String& p_source) const {
-    Array<String> a = p_source.split(' ');
+    return count;
+}
 
-    String x = a[1];
-    String y = a[2];
+static int parse_int(const char* p_begin, const char* p_end) {
+    int value = 0;
+    if (StringUtils::parse_int(p_begin, p_end, value) == p_begin) T_ERROR("Corrupt");
 
-    return vec2(x.substr(0, x.size() - 1), y);
+    return value;
 }
 
-vec3 Serializer::deserialize_vec3(const String& p_source) const {
-    Array<String> a = p_source.split(' ');
+static float parse_float(const char* p_begin, const char* p_end) {
+    float value = 0.0f;
+    if (StringUtils::parse_float(p_begin, p_end, value) == p_begin) T_ERROR("Corrupt");
 
-    String x = a[1];
-    String y = a[2];
-    String z = a[3];
+    return value;
+}
 
-    return vec3(x.substr(0, x.size() - 1), y.substr(0, y.size() - 1), z);
+Variant Serializer::deserialize_value(Variant::Type p_type, const String& p_value) const {
+    return deserialize_value(p_type, p_value.c_str(), p_value.c_str() + p_value.size());
 }
 
-vec4 Serializer::deserialize_vec4(const String& p_source) const {
-    Array<String> a = p_source.split(' ');
+Variant Serializer::deserialize_value(Variant::Type p_type, const char* p_begin,
+                                      const char* p_end) const {
+    float v[9];
 
-    String x = a[1];
-    String y = a[2];
-    String z = a[3];
-    String w = a[4];
+    switch (p_type) {
+        case Variant::UNDEF:
+            return NULL_VAR;
 
-    return vec4(x.substr(0, x.size() - 1), y.substr(0, y.size() - 1), z.substr(0, z.size() - 1), w);
-}
+        case Variant::BOOL:
+            return p_end - p_begin == 4 && strncmp(p_begin, "true", 4) == 0;
 
-Color Serializer::deserialize_color(const String& p_source) const {
-    Array<String> a = p_source.split(' ');
+        case Variant::INT:
+            return parse_int(p_begin, p_end);
 
-    String x = a[3];
-    String y = a[6];
-    String z = a[9];
-    String w = a[12];
+        case Variant::FLOAT:
+            return parse_float(p_begin, p_end);
 
-    return vec4(x.substr(0, x.size() - 1), y.substr(0, y.size() - 1), z.substr(0, z.size() - 1), w);
-}
+        case Variant::STRING:
+            return String(std::string(p_begin, p_end));
 
-Transform Serializer::deserialize_transform(const String& p_source) const {
-    Array<int> starts = p_source.find(Char('{'));
-    Array<int> ends = p_source.find(Char('}'));
+        case Variant::VEC2:
+            parse_floats(p_begin, p_end, v, 2);
+            return vec2(v[0], v[1]);
 
-    String pos = p_source.substr(starts[1], ends[0] - starts[1]);
-    String size = p_source.substr(starts[2], ends[1] - starts[2]);
-    String rot = p_source.substr(starts[3], ends[2] - starts[3]);
+        case Variant::VEC3:
+            parse_floats(p_begin, p_end, v, 3);
+            return vec3(v[0], v[1], v[2]);
 
-    return Transform(deserialize_vec3(pos), deserialize_vec3(size), deserialize_vec3(rot));
+        case Variant::VEC4:
+            parse_floats(p_begin, p_end, v, 4);
+            return vec4(v[0], v[1], v[2], v[3]);
+
+        case Variant::COLOR:
+            parse_floats(p_begin, p_end, v, 4);
+            return Color(v[0], v[1], v[2], v[3]);
+
+        case Variant::TRANSFORM:
+            parse_floats(p_begin, p_end, v, 9);
+            return Transform(vec3(v[0], v[1], v[2]), vec3(v[3], v[4], v[5]),
+                             vec3(v[6], v[7], v[8]));
+
+        case Variant::ARRAY:
+        case Variant::MAT4:
+        default:
+            return NULL_VAR;
+    }
 }
 
 Object* Serializer::deserialize_object(const String& p_source) const { return nullptr; }
 
 Array<String> Serializer::deserialize_set(const String& p_value) { return p_value.split(','); }
 
+SceneLoadTimings Serializer::get_load_timings() const { return load_timings; }
+
 void Serializer::init() { singleton = new Serializer; }
 
+String SceneLoadTimings::to_string() const {
+    return String(resources) + " resources, parse " + String(parse * 1000.0f) + " ms, decode " +
+           String(decode * 1000.0f) + " ms, upload " + String(upload * 1000.0f) +
+           " ms, instantiate " + String(instantiate * 1000.0f) + " ms";
+}
+
 Serializer* Serializer::get_singleton() { return singleton; }
 
 #undef CLASSNAME
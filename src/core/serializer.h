@@ -1,5 +1,9 @@
 #pragma once
 
+#include <map>
+#include <string>
+
+#include "core/dictionary.h"
 #include "core/object.h"
 #include "core/variant/variant.h"
 
@@ -7,6 +11,24 @@
 #define TYPESERIALIZER TypeSerializer::get_singleton()
 
 struct XmlNode;
+class File;
+
+// Wall time of each scene loading phase, in seconds.
+struct SceneLoadTimings {
+    int resources = 0;
+
+    float parse = 0.0f;
+    float decode = 0.0f;
+    float upload = 0.0f;
+    float instantiate = 0.0f;
+
+    String to_string() const;
+};
+
+namespace rapidxml {
+template <class Ch>
+class xml_node;
+}
 
 class Serializer : public Object {
     OBJ_DEFINITION(Serializer, Object);
@@ -22,26 +44,45 @@ class Serializer : public Object {
     Variant deserialize_recursively(const XmlNode& p_node);
     Array<String> deserialize_set(const String& p_value);
 
+    SceneLoadTimings get_load_timings() const;
+
     static void init();
     static Serializer* get_singleton();
 
     static void bind_methods();
 
+    // Writes a single value attribute, numbers are written so that they parse back exactly.
+    String serialize_value(const Variant& p_value) const;
+
+    // Parses a single value attribute as written by serialize_recursively.
+    Variant deserialize_value(Variant::Type p_type, const String& p_value) const;
+    Variant deserialize_value(Variant::Type p_type, const char* p_begin, const char* p_end) const;
+
    private:
-    struct Property {
-        String name = "";
-        VariantType type = VariantType();
-        Variant value = NULL_VAR;
+    // Reflection data of a serialized type, resolved once instead of once per node.
+    struct TypeInfo {
+        VariantType type;
+        Variant::Type variant_type = Variant::UNDEF;
+        bool is_resource = false;
+        CSTR_0* constructor = nullptr;
+        std::map<std::string, ::Property*, std::less<>> setters;
     };
 
-    Serializer::Property deserialize_property(const XmlNode& p_node);
-    vec2 deserialize_vec2(const String& p_source) const;
-    vec3 deserialize_vec3(const String& p_source) const;
-    vec4 deserialize_vec4(const String& p_source) const;
-    Color deserialize_color(const String& p_source) const;
-    Transform deserialize_transform(const String& p_source) const;
+    TypeInfo& get_type_info(const char* p_name, size_t p_size);
+    ::Property* get_setter(TypeInfo& p_info, const char* p_name, size_t p_size);
+
+    Variant deserialize_node(const rapidxml::xml_node<char>* p_node);
+    Variant deserialize_property(const rapidxml::xml_node<char>* p_node);
+    bool is_object_property(const rapidxml::xml_node<char>* p_node) const;
+
+    void collect_resources(const rapidxml::xml_node<char>* p_node, Array<File>& r_files);
+
     Object* deserialize_object(const String& p_source) const;
 
+    // Keyed by name with transparent lookup, so a hit compares the name without copying it.
+    std::map<std::string, TypeInfo, std::less<>> type_infos;
+    SceneLoadTimings load_timings;
+
     static Serializer* singleton;
 };
 
@@ -0,0 +1,446 @@
+#include "snapshot.h"
+
+#include <cstring>
+#include <unordered_set>
+
+#include "core/memory.h"
+#include "core/node.h"
+#include "core/prefab.h"
+#include "core/titanscript/titanscript.h"
+#include "types/methodmaster.h"
+
+namespace {
+enum ObjectFlags { HAS_SCRIPT = 1, IS_NODE = 2 };
+
+// Value tag for objects that are owned by the property and captured inline, such as components.
+const uint8_t NESTED_OBJECT = 255;
+
+// Nodes by their instance id, so a node created at the address of a deleted one is not taken for
+// it. Nested objects are only compared with the current value of their property.
+uint64_t get_identity(Object* p_object) {
+    Node* node = dynamic_cast<Node*>(p_object);
+
+    return node ? node->get_instance_id() : reinterpret_cast<uintptr_t>(p_object);
+}
+}  // namespace
+
+Snapshot::Snapshot() { object_count = 0; }
+
+void Snapshot::capture(Node* p_root) {
+    clear();
+
+    if (p_root) write_object(p_root);
+}
+
+bool Snapshot::restore(Node* p_root) {
+    if (!p_root || is_empty()) return false;
+
+    Reader reader = {buffer.data(), buffer.size(), 0};
+
+    if (reader.peek<uint64_t>() != get_identity(p_root)) {
+        T_ERROR("Snapshot was not captured from " + p_root->get_name());
+        return false;
+    }
+
+    read_object(reader, p_root);
+
+    if (!reader.valid) T_ERROR("Corrupt snapshot");
+
+    return reader.valid;
+}
+
+void Snapshot::clear() {
+    buffer.clear();
+    object_count = 0;
+}
+
+bool Snapshot::is_empty() const { return buffer.empty(); }
+
+size_t Snapshot::get_size() const { return buffer.size(); }
+
+int Snapshot::get_object_count() const { return object_count; }
+
+//=========================================================================
+// Writing
+//=========================================================================
+
+template <typename T>
+void Snapshot::write(const T& p_value) {
+    const char* bytes = reinterpret_cast<const char*>(&p_value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void Snapshot::write_object(Object* p_object) {
+    VariantType type = p_object->get_type();
+    Prefab::TypeInfo& info = Prefab::get_type_info(type);
+    Variant self = p_object;
+
+    object_count++;
+
+    write<uint64_t>(get_identity(p_object));
+    write<uint32_t>(get_type_index(type));
+    write<uint32_t>(info.properties.size());
+
+    for (Property* property : info.properties)
+        write_value(property->get->operator()(self), false);
+
+    Scriptable* scriptable = dynamic_cast<Scriptable*>(p_object);
+    TitanScript* script = scriptable ? scriptable->get_script() : nullptr;
+    Node* node = dynamic_cast<Node*>(p_object);
+
+    write<uint8_t>((script ? HAS_SCRIPT : 0) | (node ? IS_NODE : 0));
+
+    if (script) {
+        Array<String> names = script->ListVariables();
+        write<uint32_t>(names.size());
+
+        for (const String& name : names) {
+            write_string(name);
+            write_value(script->GetVariable(name), true);
+        }
+    }
+
+    if (node) {
+        write<uint32_t>(node->get_child_count());
+
+        for (int c = 0; c < node->get_child_count(); c++) write_object(node->get_child_by_index(c));
+    }
+}
+
+void Snapshot::write_value(const Variant& p_value, bool p_by_reference) {
+    switch (p_value.type) {
+        case Variant::BOOL:
+            write<uint8_t>(Variant::BOOL);
+            write<uint8_t>(p_value.b);
+            break;
+
+        case Variant::INT:
+            write<uint8_t>(Variant::INT);
+            write<int32_t>(p_value.i);
+            break;
+
+        case Variant::FLOAT:
+            write<uint8_t>(Variant::FLOAT);
+            write<float>(p_value.f);
+            break;
+
+        case Variant::STRING:
+            write<uint8_t>(Variant::STRING);
+            write_string(p_value.operator String&());
+            break;
+
+        case Variant::VEC2:
+            write<uint8_t>(Variant::VEC2);
+            write<vec2>(p_value.operator vec2&());
+            break;
+
+        case Variant::VEC3:
+            write<uint8_t>(Variant::VEC3);
+            write<vec3>(p_value.operator vec3&());
+            break;
+
+        case Variant::VEC4:
+            write<uint8_t>(Variant::VEC4);
+            write<vec4>(p_value.operator vec4&());
+            break;
+
+        case Variant::COLOR: {
+            const Color& c = p_value.operator Color&();
+            write<uint8_t>(Variant::COLOR);
+            write<vec4>(vec4(c.x, c.y, c.z, c.w));
+            break;
+        }
+
+        case Variant::TRANSFORM: {
+            const Transform& t = p_value.operator Transform&();
+            write<uint8_t>(Variant::TRANSFORM);
+            write<vec3>(t.get_pos());
+            write<vec3>(t.get_size());
+            write<vec3>(t.get_rotation());
+            break;
+        }
+
+        case Variant::OBJECT: {
+            Object* object = p_value.o;
+
+            // Resources and nodes are referenced, nodes are captured through their parent.
+            if (!object || p_by_reference || dynamic_cast<Node*>(object) ||
+                Prefab::get_type_info(object->get_type()).is_resource) {
+                write<uint8_t>(Variant::OBJECT);
+                write<uint64_t>(reinterpret_cast<uintptr_t>(object));
+            } else {
+                write<uint8_t>(NESTED_OBJECT);
+                write_object(object);
+            }
+            break;
+        }
+
+        default:
+            // Arrays and matrices are not restored by the scene formats either.
+            write<uint8_t>(Variant::UNDEF);
+            break;
+    }
+}
+
+void Snapshot::write_string(const String& p_string) {
+    write<uint32_t>(p_string.size());
+    buffer.insert(buffer.end(), p_string.c_str(), p_string.c_str() + p_string.size());
+}
+
+uint32_t Snapshot::get_type_index(const VariantType& p_type) {
+    int key = p_type;
+    if (type_indices.contains(key)) return type_indices[key];
+
+    uint32_t index = types.size();
+    types.push_back(p_type);
+    type_indices[key] = index;
+
+    return index;
+}
+
+//=========================================================================
+// Reading
+//=========================================================================
+
+template <typename T>
+T Snapshot::Reader::read() {
+    if (position + sizeof(T) > size) {
+        valid = false;
+        return T();
+    }
+
+    T value = peek<T>();
+    position += sizeof(T);
+
+    return value;
+}
+
+template <typename T>
+T Snapshot::Reader::peek() const {
+    T value = T();
+
+    if (position + sizeof(T) <= size) memcpy(&value, data + position, sizeof(T));
+
+    return value;
+}
+
+Object* Snapshot::read_object(Reader& p_reader, Object* p_existing) {
+    uint64_t identity = p_reader.read<uint64_t>();
+    uint32_t type_index = p_reader.read<uint32_t>();
+    uint32_t property_count = p_reader.read<uint32_t>();
+
+    if (!p_reader.valid || type_index >= uint32_t(types.size())) {
+        p_reader.valid = false;
+        return nullptr;
+    }
+
+    const VariantType& type = types[type_index];
+    Prefab::TypeInfo& info = Prefab::get_type_info(type);
+
+    if (property_count != uint32_t(info.properties.size())) {
+        p_reader.valid = false;
+        return nullptr;
+    }
+
+    Object* object = p_existing;
+
+    if (!object || get_identity(object) != identity ||
+        !(object->get_type() == type)) {
+        if (!info.constructor) {
+            T_ERROR("type " + type.get_type_name().get_source() +
+                    " has no default constructor, it can not be restored");
+            p_reader.valid = false;
+            return nullptr;
+        }
+
+        object = info.constructor->operator()().operator Object*();
+    }
+
+    Variant self = object;
+
+    for (Property* property : info.properties) {
+        bool nested = p_reader.peek<uint8_t>() == NESTED_OBJECT;
+        Variant current = nested ? property->get->operator()(self) : NULL_VAR;
+        Variant value;
+
+        if (!read_value(p_reader, current, value)) {
+            if (!p_reader.valid) return object;
+            continue;
+        }
+
+        // Nested objects restored in place are already up to date.
+        if (nested && current.type == Variant::OBJECT && value.o == current.o) continue;
+
+        property->set->operator()(self, value);
+    }
+
+    uint8_t flags = p_reader.read<uint8_t>();
+
+    if (flags & HAS_SCRIPT) {
+        Scriptable* scriptable = dynamic_cast<Scriptable*>(object);
+        TitanScript* script = scriptable ? scriptable->get_script() : nullptr;
+        uint32_t count = p_reader.read<uint32_t>();
+
+        for (uint32_t c = 0; c < count && p_reader.valid; c++) {
+            String name = read_string(p_reader);
+            Variant value;
+
+            if (read_value(p_reader, NULL_VAR, value) && script) script->SetVariable(name, value);
+        }
+    }
+
+    if (flags & IS_NODE) {
+        Node* node = dynamic_cast<Node*>(object);
+
+        if (!node) {
+            p_reader.valid = false;
+            return object;
+        }
+
+        restore_children(p_reader, node);
+    }
+
+    return object;
+}
+
+bool Snapshot::read_value(Reader& p_reader, const Variant& p_current, Variant& r_value) {
+    uint8_t type = p_reader.read<uint8_t>();
+
+    switch (type) {
+        case Variant::BOOL:
+            r_value = p_reader.read<uint8_t>() != 0;
+            break;
+
+        case Variant::INT:
+            r_value = int(p_reader.read<int32_t>());
+            break;
+
+        case Variant::FLOAT:
+            r_value = p_reader.read<float>();
+            break;
+
+        case Variant::STRING:
+            r_value = read_string(p_reader);
+            break;
+
+        case Variant::VEC2:
+            r_value = p_reader.read<vec2>();
+            break;
+
+        case Variant::VEC3:
+            r_value = p_reader.read<vec3>();
+            break;
+
+        case Variant::VEC4:
+            r_value = p_reader.read<vec4>();
+            break;
+
+        case Variant::COLOR: {
+            vec4 c = p_reader.read<vec4>();
+            r_value = Color(c.x, c.y, c.z, c.w);
+            break;
+        }
+
+        case Variant::TRANSFORM: {
+            vec3 pos = p_reader.read<vec3>();
+            vec3 size = p_reader.read<vec3>();
+            vec3 rotation = p_reader.read<vec3>();
+            r_value = Transform(pos, size, rotation);
+            break;
+        }
+
+        case Variant::OBJECT:
+            r_value = reinterpret_cast<Object*>(uintptr_t(p_reader.read<uint64_t>()));
+            break;
+
+        case NESTED_OBJECT: {
+            Object* current = p_current.type == Variant::OBJECT ? p_current.o : nullptr;
+            r_value = read_object(p_reader, current);
+            break;
+        }
+
+        case Variant::UNDEF:
+            return false;
+
+        default:
+            p_reader.valid = false;
+            return false;
+    }
+
+    return p_reader.valid;
+}
+
+String Snapshot::read_string(Reader& p_reader) {
+    uint32_t length = p_reader.read<uint32_t>();
+
+    if (!p_reader.valid || p_reader.position + length > p_reader.size) {
+        p_reader.valid = false;
+        return "";
+    }
+
+    String result = std::string(p_reader.data + p_reader.position, length);
+    p_reader.position += length;
+
+    return result;
+}
+
+void Snapshot::restore_children(Reader& p_reader, Node* p_node) {
+    uint32_t count = p_reader.read<uint32_t>();
+    int child_count = p_node->get_child_count();
+
+    Array<Node*> restored;
+    bool unchanged = int(count) == child_count;
+
+    for (uint32_t c = 0; c < count && p_reader.valid; c++) {
+        uint64_t identity = p_reader.peek<uint64_t>();
+        Node* existing = nullptr;
+
+        // Children usually keep their position, only search when they moved.
+        if (int(c) < child_count && get_identity(p_node->get_child_by_index(c)) == identity) {
+            existing = p_node->get_child_by_index(c);
+        } else {
+            for (int i = 0; i < child_count; i++) {
+                if (get_identity(p_node->get_child_by_index(i)) == identity)
+                    existing = p_node->get_child_by_index(i);
+            }
+        }
+
+        Node* child = dynamic_cast<Node*>(read_object(p_reader, existing));
+        if (!child) {
+            p_reader.valid = false;
+            return;
+        }
+
+        restored.push_back(child);
+
+        if (!existing || int(c) >= child_count || existing != p_node->get_child_by_index(c))
+            unchanged = false;
+    }
+
+    if (unchanged || !p_reader.valid) return;
+
+    // Nodes were added, removed or reordered while playing: rebuild the child list. Kept children
+    // stay attached with their own children, so they are not set up again.
+    std::unordered_set<Node*> kept(restored.begin(), restored.end());
+    Array<Node*> dropped;
+
+    for (int c = 0; c < child_count; c++) {
+        Node* child = p_node->get_child_by_index(c);
+        if (!kept.count(child)) dropped.push_back(child);
+    }
+
+    for (Node* child : dropped) {
+        p_node->release_child(child);
+        GC->dequeue(child);
+        delete child;
+    }
+
+    for (int c = 0; c < restored.size(); c++) {
+        Node* child = restored[c];
+
+        // Nodes constructed by the restore are attached for the first time.
+        if (child->get_parent() != p_node) p_node->add_child(child);
+
+        p_node->move_child(child, c);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/array.h"
+#include "core/dictionary.h"
+#include "core/variant/variant.h"
+
+class Node;
+class Object;
+
+// In-memory binary capture of a node tree, used to enter and leave play mode.
+//
+// Every reflected property and the variables of script instances are written to one contiguous
+// buffer. Nodes are identified by their instance id, restoring applies the values in place to the
+// objects that still exist and only constructs or removes the nodes that were added or deleted
+// in between. Resources are stored by reference, snapshots are not meant to be saved to disk.
+class Snapshot {
+   public:
+    Snapshot();
+
+    void capture(Node* p_root);
+    bool restore(Node* p_root);
+
+    void clear();
+
+    bool is_empty() const;
+    size_t get_size() const;
+    int get_object_count() const;
+
+   private:
+    struct Reader {
+        const char* data;
+        size_t size;
+        size_t position;
+
+        bool valid = true;
+
+        template <typename T>
+        T read();
+        template <typename T>
+        T peek() const;
+    };
+
+    template <typename T>
+    void write(const T& p_value);
+
+    void write_object(Object* p_object);
+    void write_value(const Variant& p_value, bool p_by_reference);
+    void write_string(const String& p_string);
+
+    Object* read_object(Reader& p_reader, Object* p_existing);
+    bool read_value(Reader& p_reader, const Variant& p_current, Variant& r_value);
+    String read_string(Reader& p_reader);
+
+    void restore_children(Reader& p_reader, Node* p_node);
+
+    uint32_t get_type_index(const VariantType& p_type);
+
+    std::vector<char> buffer;
+    Array<VariantType> types;
+    Dictionary<int, uint32_t> type_indices;
+
+    int object_count;
+};
@@ -5,6 +5,7 @@
 #include "array.h"
 #include "math/real.h"
 #include "tmessage.h"
+#include "utility/stringutils.h"
 #include "vector.h"
 
 String::String() { src = ""; }
@@ -27,14 +28,20 @@ String::String(Char v) {
 
 String::String(const Real& r) { src = (std::string)r.to_string(); }
 
-String::String(unsigned i) { src = std::to_string(i); }
+String::String(unsigned i) {
+    char buffer[StringUtils::NUMBER_SIZE];
+    src.assign(buffer, StringUtils::format_int(buffer, i));
+}
 
-String::String(int i) { src = std::to_string(i); }
+String::String(int i) {
+    char buffer[StringUtils::NUMBER_SIZE];
+    src.assign(buffer, StringUtils::format_int(buffer, i));
+}
 
 String::String(float d) {
-    std::stringstream ss;
-    ss << d;
-    src = ss.str();
+    // Six significant digits, as streams write floats.
+    char buffer[StringUtils::NUMBER_SIZE];
+    src.assign(buffer, StringUtils::format_float(buffer, d, 6));
 }
 
 String::String(const Variant& v) { std::cout << "TODO: String(var)" << std::endl; }
@@ -106,8 +113,16 @@ String::operator bool() const {
         T_ERROR("Invalid Conversion");
     return false;
 }
-String::operator int() const { return std::stoi(c_str()); }
-String::operator float() const { return std::stof(c_str()); }
+String::operator int() const {
+    int value = 0;
+    StringUtils::parse_int(src.data(), src.data() + src.size(), value);
+    return value;
+}
+String::operator float() const {
+    float value = 0.0f;
+    StringUtils::parse_float(src.data(), src.data() + src.size(), value);
+    return value;
+}
 
 // Methods
 const char* String::c_str() const { return src.c_str(); }
@@ -314,9 +329,12 @@ String String::CharToString(const char c) {
     String s(k);
     return s;
 }
-String String::FloatToString(const float d) { return std::to_string(d); }
-String String::IntToString(int i) { return std::to_string(i); }
-float String::StringTofloat() { return stof(src); }
+String String::FloatToString(const float d) {
+    char buffer[StringUtils::NUMBER_SIZE];
+    return std::string(buffer, StringUtils::format_fixed(buffer, d, 6));
+}
+String String::IntToString(int i) { return i; }
+float String::StringTofloat() { return operator float(); }
 
 int String::CountTabs() {
     int count = 0;
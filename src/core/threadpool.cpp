@@ -0,0 +1,69 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+ThreadPool* ThreadPool::singleton;
+
+ThreadPool::ThreadPool(int p_thread_count) {
+    busy = 0;
+    stopping = false;
+
+    if (p_thread_count <= 0)
+        p_thread_count = std::max(1, int(std::thread::hardware_concurrency()) - 1);
+
+    for (int c = 0; c < p_thread_count; c++) threads.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+
+    for (std::thread& thread : threads) thread.join();
+}
+
+void ThreadPool::add_task(const std::function<void()>& p_task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        tasks.push(p_task);
+    }
+    task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    tasks_done.wait(lock, [this]() { return tasks.empty() && busy == 0; });
+}
+
+int ThreadPool::get_thread_count() const { return threads.size(); }
+
+void ThreadPool::run() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (stopping && tasks.empty()) return;
+
+            task = tasks.front();
+            tasks.pop();
+            busy++;
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            busy--;
+        }
+        tasks_done.notify_all();
+    }
+}
+
+void ThreadPool::init() { singleton = new ThreadPool; }
+
+ThreadPool* ThreadPool::get_singleton() { return singleton; }
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#define THREADPOOL ThreadPool::get_singleton()
+
+// Fixed-size pool of worker threads for CPU-side work such as decoding resources.
+// Tasks must not touch GL or SDL video state; results are handed back to the main thread.
+class ThreadPool {
+   public:
+    ThreadPool(int p_thread_count = 0);
+    ~ThreadPool();
+
+    void add_task(const std::function<void()>& p_task);
+
+    template <typename T>
+    std::future<T> submit(const std::function<T()>& p_task) {
+        std::shared_ptr<std::packaged_task<T()>> task =
+            std::make_shared<std::packaged_task<T()>>(p_task);
+
+        add_task([task]() { (*task)(); });
+        return task->get_future();
+    }
+
+    // Blocks until all queued tasks have finished.
+    void wait();
+
+    int get_thread_count() const;
+
+    static void init();
+    static ThreadPool* get_singleton();
+
+   private:
+    void run();
+
+    std::vector<std::thread> threads;
+    std::queue<std::function<void()>> tasks;
+
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable tasks_done;
+
+    int busy;
+    bool stopping;
+
+    static ThreadPool* singleton;
+};
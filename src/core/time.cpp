@@ -92,6 +92,57 @@ float Stopwatch::stop() {
     return result;
 }
 
+//=========================================================================
+// StartupTrace
+//=========================================================================
+
+namespace {
+// Initialized before main runs, as close to process start as portable code gets.
+const std::chrono::steady_clock::time_point process_start = std::chrono::steady_clock::now();
+}  // namespace
+
+Array<StartupTrace::Phase> StartupTrace::phases;
+bool StartupTrace::finished = false;
+
+void StartupTrace::begin(const String& p_name) {
+    if (finished) return;
+
+    end();
+    phases.push_back({p_name, get_time(), -1.0f});
+}
+
+void StartupTrace::end() {
+    if (phases.size() > 0 && phases.getlast().duration < 0.0f)
+        phases.getlast().duration = get_time() - phases.getlast().start;
+}
+
+void StartupTrace::finish() {
+    if (finished) return;
+
+    end();
+    finished = true;
+
+    float total = get_time();
+    String report = "Startup took " + String(total * 1000.0f) + " ms";
+
+    // Loading the executable and static initializers, main starts the first phase.
+    if (phases.size() > 0)
+        report += "\n  before tracing: " + String(phases[0].start * 1000.0f) + " ms";
+
+    for (int c = 0; c < phases.size(); c++)
+        report += "\n  " + phases[c].name + ": " + String(phases[c].duration * 1000.0f) + " ms";
+
+    T_LOG(report);
+}
+
+bool StartupTrace::is_finished() { return finished; }
+
+const Array<StartupTrace::Phase>& StartupTrace::get_phases() { return phases; }
+
+float StartupTrace::get_time() {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - process_start).count();
+}
+
 //=========================================================================
 // FPSLimiter
 //=========================================================================
@@ -75,6 +75,34 @@ class Stopwatch {
     std::chrono::high_resolution_clock::time_point start_time;
 };
 
+// Wall time of the startup phases, from process start up to the first frame.
+class StartupTrace {
+   public:
+    struct Phase {
+        String name;
+        float start;
+        float duration;
+    };
+
+    // Ends the running phase and starts the next one.
+    static void begin(const String& p_name);
+
+    // Ends the running phase and logs all phases, only the first call has an effect.
+    static void finish();
+
+    static bool is_finished();
+    static const Array<Phase>& get_phases();
+
+    // Seconds since process start.
+    static float get_time();
+
+   private:
+    static void end();
+
+    static Array<Phase> phases;
+    static bool finished;
+};
+
 class Timer {
    public:
     Timer(int p_waittime) {
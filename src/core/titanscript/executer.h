@@ -11,7 +11,8 @@ public:
 	Executer();
 	Executer(Line line, State *state);
 
-	~Executer() { delete state; }
+	// The state belongs to the script, which runs its top level again with a new executer.
+	~Executer() {}
 
 	Variant run_method(Method * m, Array<Variant>& args);
 
@@ -1,6 +1,7 @@
 #include "scriptapp.h"
 
 #include "core/contentmanager.h"
+#include "core/time.h"
 #include "titanscript.h"
 
 ScriptApp::ScriptApp(Platform *p_platform) : Application(p_platform)
@@ -16,6 +17,9 @@ Variant ScriptApp::execute(const Array<String>& p_args)
 
 	InitEngine();
 
+	// There is no first frame without graphics, the script runs once the engine is up.
+	StartupTrace::finish();
+
 	Variant result;
 
 	script = new TitanScript(File(p_args[0]).get_absolute_path());
@@ -9,6 +9,8 @@ TitanScript::TitanScript()
 	lexer = nullptr;
 	parser = nullptr;
 	exe = nullptr;
+	program = nullptr;
+	revision = 0;
 }
 
 TitanScript::TitanScript(const String& p_file_name) : TitanScript()
@@ -22,24 +24,98 @@ void TitanScript::open_file(const String& filepath)
 
 	textfile = CONTENT->LoadTextFile(filepath);
 
+	compile();
+	execute();
+}
+
+void TitanScript::compile()
+{
+	revision = textfile->get_revision();
+
 	lexer = new Lexer(textfile->get_source());
 	parser = new Parser(state, lexer->root);
+}
+
+void TitanScript::reload()
+{
+	if (program)
+	{
+		program->reload();
+		return;
+	}
+
+	if (!textfile)
+		return;
+
+	textfile->reload();
+	refresh();
+}
+
+void TitanScript::refresh()
+{
+	if (program)
+	{
+		program->refresh();
+
+		if (revision == program->revision)
+			return;
+
+		lexer = program->lexer;
+		parser = program->parser;
+		revision = program->revision;
+
+		state->ShareFuncs(program->state);
+		execute();
+		return;
+	}
+
+	if (!textfile || revision == textfile->get_revision())
+		return;
+
+	// Instances refresh before they run, so they no longer use the old program after this
+	lexer->Free();
+	state->FreeFuncs();
+
+	delete lexer;
+	delete parser;
+
+	compile();
+	execute();
+
+	T_LOG("Reloaded script " + file.get_relative_path());
+}
+
+void TitanScript::execute()
+{
+	// Running the top level of the script initializes its variables again
+	Array<String> names = state->ListVars();
+	Array<Variant> values;
+
+	for (const String &name : names)
+		values.push_back(GetVariable(name));
+
+	delete exe;
 	exe = new Executer(lexer->root, state);
+
+	for (int c = 0; c < names.size(); c++)
+		SetVariable(names[c], values[c]);
 }
 
 TitanScript* TitanScript::CreateNewInstance()
 {
 	TitanScript *newscript = new TitanScript;
-	Variant ext = state->extension;
 
+	newscript->file = file;
 	newscript->lexer = lexer;
 	newscript->parser = parser;
 	newscript->textfile = textfile;
-	newscript->exe = exe;
+	newscript->program = program ? program : this;
+	newscript->revision = revision;
 
-	newscript->state = new State;
+	// Parsed functions are shared, every instance gets its own variables
+	newscript->state->ShareFuncs(state);
+	newscript->exe = new Executer(lexer->root, newscript->state);
 
-	Extend(ext);
 	return newscript;
 }
 
@@ -51,6 +127,8 @@ void TitanScript::Extend(Variant ext)
 
 bool TitanScript::FunctionExists(const StringName& name)
 {
+	refresh();
+
 	if (!exe || !exe->state) {
 		T_ERROR("exe is null for function: " + name);
 		return false;
@@ -61,16 +139,49 @@ bool TitanScript::FunctionExists(const StringName& name)
 
 Variant TitanScript::RunFunction(const StringName& name)
 {
+	refresh();
+
 	return exe->run_titan_func(name, Array<Variant>());
 }
 
 Variant TitanScript::RunFunction(const StringName& name, const Array<Variant>& paras)
 {
+	refresh();
+
 	return exe->run_titan_func(name, paras);
 }
 
+Array<String> TitanScript::ListVariables()
+{
+	return state->ListVars();
+}
+
+Variant TitanScript::GetVariable(const String& name)
+{
+	Variant* value = state->GetVar(name);
+	return value ? *value : NULL_VAR;
+}
+
+void TitanScript::SetVariable(const String& name, const Variant& value)
+{
+	if (state->VarExists(name))
+		*state->GetVar(name) = value;
+	else
+		state->SetVar(name, value);
+}
+
 void TitanScript::Clean()
 {
+	if (program)
+	{
+		// The lexer, parser and functions belong to the script this instance was created from
+		state->FreeVars();
+
+		delete exe;
+		delete state;
+		return;
+	}
+
 	lexer->Free();
 	state->Free();
 
@@ -20,6 +20,9 @@ public:
 
 	void open_file(const String &filepath);
 
+	// Reads the source again, instances pick up the new program the next time they run
+	void reload() override;
+
 	TitanScript* CreateNewInstance();
 
 	void Extend(Variant ext);
@@ -29,15 +32,32 @@ public:
 	Variant RunFunction(const StringName &name);
 	Variant RunFunction(const StringName &name, const Array<Variant> &paras);
 
+	//Instance variables
+	Array<String> ListVariables();
+	Variant GetVariable(const String &name);
+	void SetVariable(const String &name, const Variant &value);
+
 	//Free Memory
 	void Clean();
 
 	static void bind_methods();
 
 private:
+	void compile();
+
+	// Rebuilds the program when its source changed, keeping the values of the variables
+	void refresh();
+	void execute();
+
 	TextFile* textfile;
 	Lexer *lexer;
 	Parser *parser;
 	State *state;
 	Executer *exe;
+
+	// Script whose parsed program is shared by this instance
+	TitanScript *program;
+
+	// Revision of the source this script was built from
+	unsigned revision;
 };
@@ -46,7 +46,14 @@ void EditorApp::init() {
     v->resize(WINDOWSIZE_F / 2.0f);
     v->set_mode(Viewport::DIRECT);
 
+    // Assets edited outside the editor are reloaded as soon as they are saved.
+    CONTENT->set_hot_reload(true);
+
+    // The project's resources are decoded in the background and appear once uploaded, editor
+    // controls need their textures right away.
+    CONTENT->set_async_loading(true);
     active_project = new Project("projects/terrain.xml");
+    CONTENT->set_async_loading(false);
     active_scene = active_project->get_main_scene();
 
     World* world = active_scene->get_child_by_index(0)->cast_to_type<World*>();
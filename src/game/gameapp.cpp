@@ -4,8 +4,14 @@
 #include "graphics/renderer.h"
 #include "graphics/view.h"
 #include "input/input.h"
+#include "resources/virtualfilesystem.h"
 
-GameApp::GameApp(Platform* p_platform) : Application(p_platform) { activescene = nullptr; }
+GameApp::GameApp(Platform* p_platform) : Application(p_platform) {
+    activescene = nullptr;
+
+    // Games read the packed assets only, loose files are for editing.
+    VFS->set_loose_override(false);
+}
 
 void GameApp::init() {
     Renderer* r = new DeferredRenderer;
@@ -0,0 +1,216 @@
+#include "canvasbatch.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "core/contentmanager.h"
+#include "core/tmessage.h"
+#include "graphics/glstate.h"
+#include "graphics/renderer.h"
+#include "math/math.h"
+#include "resources/shader.h"
+#include "resources/texture.h"
+
+CanvasBatch* CanvasBatch::singleton;
+
+CanvasBatch::CanvasBatch() {
+    shader = nullptr;
+
+    vao = 0;
+    vbo = 0;
+    ebo = 0;
+    offset = 0;
+
+    texture = nullptr;
+
+    source = nullptr;
+    source_generation = 0;
+    source_packed = false;
+
+    vertices.reserve(MAX_QUADS * 4);
+}
+
+CanvasBatch::~CanvasBatch() {
+    if (!vao) return;
+
+    GLSTATE->delete_vertex_array(vao);
+    GLSTATE->delete_buffer(vbo);
+    GLSTATE->delete_buffer(ebo);
+}
+
+CanvasBatch* CanvasBatch::get_singleton() {
+    if (!singleton) singleton = new CanvasBatch;
+
+    return singleton;
+}
+
+void CanvasBatch::add_quad(Texture2D* p_texture, const rect2& p_area, const vec4& p_bounds,
+                           const Color& p_color) {
+    if (p_texture != source ||
+        (p_texture && p_texture->get_generation() != source_generation)) {
+        source = p_texture;
+        source_generation = p_texture ? p_texture->get_generation() : 0;
+        source_packed = !p_texture || atlas.find(p_texture, source_bounds);
+
+        if (!p_texture) source_bounds = atlas.get_white_bounds();
+    }
+
+    // Coordinates outside the texture repeat it, which only works on its own.
+    bool repeats = MIN(p_bounds.x, p_bounds.y) < 0.0f || MAX(p_bounds.x, p_bounds.y) > 1.0f ||
+                   MIN(p_bounds.z, p_bounds.w) < 0.0f || MAX(p_bounds.z, p_bounds.w) > 1.0f;
+
+    vec4 bounds = p_bounds;
+
+    if (source_packed && !repeats) {
+        vec2 scale = vec2(source_bounds.y - source_bounds.x, source_bounds.w - source_bounds.z);
+
+        bounds.x = source_bounds.x + p_bounds.x * scale.x;
+        bounds.y = source_bounds.x + p_bounds.y * scale.x;
+        bounds.z = source_bounds.z + p_bounds.z * scale.y;
+        bounds.w = source_bounds.z + p_bounds.w * scale.y;
+
+        prepare(nullptr);
+    } else {
+        prepare(p_texture);
+    }
+
+    vec2 corners[4] = {p_area.get_bottom_left(), p_area.get_bottom_right(),
+                       p_area.get_upper_right(), p_area.get_upper_left()};
+
+    push_quad(corners, bounds, p_color);
+}
+
+void CanvasBatch::add_atlas_quad(const rect2& p_area, const vec4& p_bounds,
+                                 const Color& p_color) {
+    vec2 corners[4] = {p_area.get_bottom_left(), p_area.get_bottom_right(),
+                       p_area.get_upper_right(), p_area.get_upper_left()};
+
+    prepare(nullptr);
+    push_quad(corners, p_bounds, p_color);
+}
+
+void CanvasBatch::add_line(const vec2& p_start, const vec2& p_end, const Color& p_color) {
+    vec2 direction = p_end - p_start;
+    float length = direction.length();
+
+    if (length <= 0.0f) return;
+
+    // One unit wide, like the lines GL draws.
+    vec2 normal = vec2(-direction.y, direction.x) * (0.5f / length);
+    vec2 corners[4] = {p_start - normal, p_start + normal, p_end + normal, p_end - normal};
+
+    prepare(nullptr);
+    push_quad(corners, atlas.get_white_bounds(), p_color);
+}
+
+void CanvasBatch::flush() {
+    if (vertices.empty()) return;
+
+    if (!vao) create();
+
+    int count = int(vertices.size());
+
+    shader->bind();
+    shader->set_uniform("projection"_uniform, projection);
+
+    if (texture)
+        texture->bind(0);
+    else
+        GLSTATE->bind_texture(0, GL_TEXTURE_2D, atlas.get_id());
+
+    GLSTATE->bind_vertex_array(vao);
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, vbo);
+
+    // Appends to the buffer and orphans it once full, so the driver never waits for earlier
+    // draws that still read from it.
+    if (offset + count > MAX_QUADS * 4) {
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 4 * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+        offset = 0;
+    }
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    void* data = glMapBufferRange(GL_ARRAY_BUFFER, offset * sizeof(Vertex),
+                                  count * sizeof(Vertex), access);
+
+    if (data) {
+        memcpy(data, vertices.data(), count * sizeof(Vertex));
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+
+        // The indices are shared by all quads, each one starts at a multiple of four vertices.
+        size_t first_index = size_t(offset / 4) * 6;
+        glDrawElements(GL_TRIANGLES, count / 4 * 6, GL_UNSIGNED_INT,
+                       (void*)(first_index * sizeof(GLuint)));
+
+        stats.draws++;
+        stats.quads += count / 4;
+    } else {
+        T_ERROR("Could not map the canvas vertex buffer");
+    }
+
+    offset += count;
+    vertices.clear();
+
+    GLSTATE->bind_vertex_array(0);
+}
+
+TextureAtlas* CanvasBatch::get_atlas() { return &atlas; }
+
+const CanvasBatch::Stats& CanvasBatch::get_stats() const { return stats; }
+
+void CanvasBatch::reset_stats() { stats = Stats(); }
+
+void CanvasBatch::create() {
+    shader = CONTENT->LoadShader("engine/shaders/Canvas");
+
+    std::vector<GLuint> indices(MAX_QUADS * 6);
+
+    for (GLuint c = 0; c < GLuint(MAX_QUADS); c++) {
+        const GLuint quad[6] = {0, 1, 2, 2, 3, 0};
+
+        for (int i = 0; i < 6; i++) indices[c * 6 + i] = c * 4 + quad[i];
+    }
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    GLSTATE->bind_vertex_array(vao);
+
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 4 * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+
+    GLSTATE->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(),
+                 GL_STATIC_DRAW);
+
+    const GLsizei stride = sizeof(Vertex);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, tex_coord));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, color));
+}
+
+void CanvasBatch::prepare(Texture2D* p_texture) {
+    const mat4& final_matrix = RENDERER->get_final_matrix();
+
+    bool changed = p_texture != texture ||
+                   memcmp(final_matrix.m, projection.m, sizeof(projection.m)) != 0;
+
+    if (!vertices.empty() && (changed || int(vertices.size()) == MAX_QUADS * 4)) flush();
+
+    texture = p_texture;
+    projection = final_matrix;
+}
+
+void CanvasBatch::push_quad(const vec2* p_corners, const vec4& p_tex_bounds,
+                            const Color& p_color) {
+    const vec2 tex_coords[4] = {vec2(p_tex_bounds.x, p_tex_bounds.z),
+                                vec2(p_tex_bounds.y, p_tex_bounds.z),
+                                vec2(p_tex_bounds.y, p_tex_bounds.w),
+                                vec2(p_tex_bounds.x, p_tex_bounds.w)};
+
+    for (int c = 0; c < 4; c++) vertices.push_back({p_corners[c], tex_coords[c], p_color});
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+#include "math/color.h"
+#include "math/mat4.h"
+#include "math/rect.h"
+#include "textureatlas.h"
+
+#define CANVAS_BATCH CanvasBatch::get_singleton()
+
+class Shader;
+class Texture2D;
+
+// Collects the quads of the canvas and draws them with as few calls as possible.
+//
+// Quads are kept in system memory until the texture they need, the projection or the scissor
+// changes, then they are copied to a streaming vertex buffer and drawn by one call. Small textures
+// are packed in a TextureAtlas and untextured quads use its white block, so most of the user
+// interface ends up in the same call.
+//
+// Everything that draws without the batch, or switches the target or the scissor, has to flush it
+// first. Renderer::use_scissor, Viewport::activate and the end of the canvas pass do so.
+class CanvasBatch {
+   public:
+    CanvasBatch();
+    ~CanvasBatch();
+
+    static CanvasBatch* get_singleton();
+
+    // Draws p_area with the part of p_texture given by p_bounds as left, right, bottom and top
+    // texture coordinates, an untextured quad if p_texture is null. Uses the current final matrix
+    // of the renderer.
+    void add_quad(Texture2D* p_texture, const rect2& p_area, const vec4& p_bounds,
+                  const Color& p_color);
+
+    // Like add_quad, with p_bounds already in the atlas.
+    void add_atlas_quad(const rect2& p_area, const vec4& p_bounds, const Color& p_color);
+
+    void add_line(const vec2& p_start, const vec2& p_end, const Color& p_color);
+
+    // Draws the collected quads.
+    void flush();
+
+    TextureAtlas* get_atlas();
+
+    struct Stats {
+        int quads = 0;
+        int draws = 0;
+    };
+
+    // Quads and draw calls since the last reset.
+    const Stats& get_stats() const;
+    void reset_stats();
+
+    static const int MAX_QUADS = 16384;
+
+   private:
+    struct Vertex {
+        vec2 position;
+        vec2 tex_coord;
+        Color color;
+    };
+
+    void create();
+
+    // Flushes if drawing with p_texture or the current projection needs other state.
+    void prepare(Texture2D* p_texture);
+
+    // Corners counter-clockwise from the bottom left.
+    void push_quad(const vec2* p_corners, const vec4& p_tex_bounds, const Color& p_color);
+
+    Shader* shader;
+
+    GLuint vao;
+    GLuint vbo;
+    GLuint ebo;
+
+    // Where the next flush writes in the vertex buffer, in vertices.
+    int offset;
+
+    TextureAtlas atlas;
+
+    std::vector<Vertex> vertices;
+
+    // State of the collected quads, a null texture is the atlas.
+    Texture2D* texture;
+    mat4 projection;
+
+    // Last texture looked up in the atlas.
+    Texture2D* source;
+    unsigned source_generation;
+    bool source_packed;
+    vec4 source_bounds;
+
+    Stats stats;
+
+    static CanvasBatch* singleton;
+};
@@ -0,0 +1,110 @@
+#include "canvastarget.h"
+
+#include "core/tmessage.h"
+#include "core/windowmanager.h"
+#include "graphics/canvasbatch.h"
+#include "graphics/fbo.h"
+#include "graphics/glstate.h"
+#include "graphics/renderer.h"
+#include "math/math.h"
+
+CanvasTarget* CanvasTarget::active;
+
+CanvasTarget::CanvasTarget() {
+    fbo = nullptr;
+    texture = nullptr;
+    valid = false;
+
+    previous_framebuffer = 0;
+}
+
+CanvasTarget::~CanvasTarget() { release(); }
+
+void CanvasTarget::begin(const rect2& p_area) {
+    if (active) {
+        T_ERROR("Canvas targets can not be nested");
+        return;
+    }
+
+    // Whole window pixels, so text and lines land on the same pixels as when drawn directly.
+    vec2 center = WINDOWSIZE_F / 2.0f;
+
+    float left = Math::floor(center.x + p_area.get_left());
+    float right = Math::ceil(center.x + p_area.get_right());
+    float bottom = Math::floor(center.y + p_area.get_bottom());
+    float top = Math::ceil(center.y + p_area.get_top());
+
+    vec2i new_size = vec2i(MAX(to_int(right - left), 1), MAX(to_int(top - bottom), 1));
+
+    if (!fbo || new_size != size) create(new_size);
+
+    area = rect2(left - center.x, right - center.x, top - center.y, bottom - center.y);
+
+    RENDERER->begin_canvas_target(area, vec2i(to_int(left), to_int(bottom)));
+
+    previous_framebuffer = GLSTATE->get_draw_framebuffer();
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+    fbo->clear();
+
+    // Colours are stored multiplied by their alpha, the alpha of everything below is kept.
+    GLSTATE->set_enabled(GL_BLEND, true);
+    GLSTATE->set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    active = this;
+}
+
+void CanvasTarget::end() {
+    if (active != this) return;
+
+    RENDERER->end_canvas_target();
+
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2],
+               previous_viewport[3]);
+
+    RENDERER->use_blending();
+
+    valid = true;
+    active = nullptr;
+}
+
+void CanvasTarget::draw() {
+    if (!valid) return;
+
+    CANVAS_BATCH->flush();
+
+    GLSTATE->set_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    CANVAS_BATCH->add_quad(texture, area, vec4(0, 1, 0, 1), Color::White);
+    CANVAS_BATCH->flush();
+
+    RENDERER->use_blending();
+}
+
+bool CanvasTarget::is_valid() const { return valid; }
+
+void CanvasTarget::release() {
+    // The texture is not owned by the FBO.
+    delete fbo;
+    delete texture;
+
+    fbo = nullptr;
+    texture = nullptr;
+    valid = false;
+}
+
+bool CanvasTarget::is_active() { return active != nullptr; }
+
+void CanvasTarget::create(const vec2i& p_size) {
+    release();
+
+    size = p_size;
+
+    texture = new Texture2D(p_size);
+
+    fbo = new FBO2D(p_size);
+    fbo->cleared_every_frame = false;
+    fbo->clear_color = Color(0.0f, 0.0f, 0.0f, 0.0f);
+    fbo->add_texture(texture);
+    fbo->init();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "math/rect.h"
+#include "math/vec2.h"
+
+class FBO2D;
+class Texture2D;
+
+// Offscreen copy of a part of the canvas, so controls that did not change since the last frame
+// are drawn with one quad.
+//
+// Everything drawn between begin and end goes to the target with its alpha kept, draw then blends
+// it over the current target. Targets do not nest, while one is drawn into is_active returns true.
+class CanvasTarget {
+   public:
+    CanvasTarget();
+    ~CanvasTarget();
+
+    // Starts drawing p_area into the target, rounded out to whole window pixels. Recreates the
+    // target if its size changed.
+    void begin(const rect2& p_area);
+    void end();
+
+    // Draws the contents from the last begin and end.
+    void draw();
+
+    // True if the target holds contents, false before the first draw and after release.
+    bool is_valid() const;
+
+    // Frees the GL objects, the next begin creates them again.
+    void release();
+
+    static bool is_active();
+
+   private:
+    void create(const vec2i& p_size);
+
+    FBO2D* fbo;
+    Texture2D* texture;
+
+    // Covered part of the canvas, in whole pixels.
+    rect2 area;
+    vec2i size;
+
+    bool valid;
+
+    // Bindings to restore at the end.
+    GLuint previous_framebuffer;
+    GLint previous_viewport[4];
+
+    static CanvasTarget* active;
+};
@@ -3,6 +3,7 @@
 #include "core/time.h"
 #include "core/windowmanager.h"
 #include "fbomanager.h"
+#include "graphics/glstate.h"
 #include "graphics/renderer.h"
 #include "math/color.h"
 
@@ -24,7 +25,10 @@ FBO::FBO() {
     definitions = Array<color_tex_def>();
 }
 
-FBO::~FBO() { glDeleteFramebuffers(1, &id); }
+FBO::~FBO() {
+    FBOMANAGER->unregister_fbo(this);
+    GLSTATE->delete_framebuffer(id);
+}
 
 void FBO::check_status() {
     int err = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -33,7 +37,7 @@ void FBO::check_status() {
 
 void FBO::clear() {
     glClearColor(clear_color.r, clear_color.g, clear_color.b, clear_color.a);
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, id);
     glViewport(0, 0, (GLsizei)size.x, (GLsizei)size.y);
 
     if (depth && color_textures.size() > 0)
@@ -47,12 +51,12 @@ void FBO::clear() {
 void FBO::bind() {
     FBOMANAGER->set_active_fbo(this);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, id);
     glViewport(0, 0, size.x, size.y);
 }
 
 void FBO::unbind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     vec2i size = WINDOWSIZE;
 
@@ -81,7 +85,7 @@ FBO2D::FBO2D(const Ref<Texture2D>& p_texture) {
     depth = false;
 
     glGenFramebuffers(1, &id);
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, id);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
 
@@ -96,7 +100,7 @@ FBO2D::FBO2D(const Ref<Texture2D>& p_texture) {
 
 void FBO2D::init() {
     glGenFramebuffers(1, &id);
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, id);
 
     if (definitions.size() > 0) {
         GLenum* DrawBuffers = new GLenum[definitions.size()];
@@ -136,7 +140,7 @@ void FBO2D::init() {
 Color FBO2D::read_pixel(const vec2& p_pos, int p_attachment_index) {
     void* data = new float[4];
 
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, id);
+    GLSTATE->bind_framebuffer(GL_READ_FRAMEBUFFER, id);
     glReadBuffer(GL_COLOR_ATTACHMENT0 + p_attachment_index);
     glReadPixels(to_int(p_pos.x), to_int(p_pos.y), 1, 1, GL_RGBA, GL_FLOAT, data);
 
@@ -173,7 +177,7 @@ FBO1D::FBO1D(int size) {
     Texture1D* color = new Texture1D(size);
 
     glGenFramebuffers(1, &id);
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, id);
     glFramebufferTexture1D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_1D, color->get_id(), 0);
     glDrawBuffers(1, DrawBuffers);
 
@@ -8,7 +8,7 @@
 class FBO {
    public:
     FBO();
-    ~FBO();
+    virtual ~FBO();
 
     void clear();
     void bind();
@@ -1,6 +1,7 @@
 #include "fbomanager.h"
 
 #include "core/windowmanager.h"
+#include "graphics/glstate.h"
 
 FBOManager FBOManager::singleton;
 
@@ -8,8 +9,14 @@ void FBOManager::set_active_fbo(FBO* p_active) { active_fbo = p_active; }
 
 void FBOManager::register_fbo(FBO* fbo) { fbos.push_back(fbo); }
 
+void FBOManager::unregister_fbo(FBO* fbo) {
+    fbos.clear(fbo);
+
+    if (active_fbo == fbo) active_fbo = nullptr;
+}
+
 void FBOManager::bind_default_fbo() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLSTATE->bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     vec2i size = WINDOWSIZE;
 
@@ -23,6 +30,11 @@ void FBOManager::clear_all() {
         if (fbos[c]->cleared_every_frame) fbos[c]->clear();
 }
 
-void FBOManager::free() { fbos.clean(); }
+void FBOManager::free() {
+    // Deleting an FBO unregisters it, so the list is emptied first.
+    Vector<FBO> registered = fbos;
+    fbos.clear();
+    registered.clean();
+}
 
 FBOManager* FBOManager::get_singleton() { return &singleton; }
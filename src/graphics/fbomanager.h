@@ -9,6 +9,7 @@ class FBOManager {
    public:
     void set_active_fbo(FBO* p_active);
     void register_fbo(FBO* fbo);
+    void unregister_fbo(FBO* fbo);
     void bind_default_fbo();
     void clear_all();
     void free();
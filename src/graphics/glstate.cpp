@@ -0,0 +1,333 @@
+#include "glstate.h"
+
+#include "core/definitions.h"
+#include "core/tmessage.h"
+
+namespace {
+const GLenum CAPABILITIES[] = {GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST};
+const GLenum TARGETS[] = {GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP};
+const GLenum TARGET_BINDINGS[] = {GL_TEXTURE_BINDING_1D, GL_TEXTURE_BINDING_2D,
+                                  GL_TEXTURE_BINDING_3D, GL_TEXTURE_BINDING_CUBE_MAP};
+
+GLuint get_integer(GLenum p_name) {
+    GLint value = 0;
+    glGetIntegerv(p_name, &value);
+
+    return GLuint(value);
+}
+
+// Reports a tracked value that differs from GL, unset values match anything.
+bool check(const char* p_name, GLuint p_expected, GLuint p_actual, GLuint p_unset) {
+    if (p_expected == p_unset || p_expected == p_actual) return true;
+
+    T_WARNING(String("GL state out of sync: ") + p_name + " is " + String(int(p_actual)) +
+              ", expected " + String(int(p_expected)));
+    return false;
+}
+}  // namespace
+
+GLState* GLState::singleton;
+
+GLState::GLState() {
+    validation = VALIDATE_GL_STATE;
+    invalidate();
+}
+
+GLState* GLState::get_singleton() {
+    if (!singleton) singleton = new GLState;
+
+    return singleton;
+}
+
+void GLState::set_enabled(GLenum p_capability, bool p_enabled) {
+    int capability = get_capability(p_capability);
+
+    if (capability == -1) {
+        p_enabled ? glEnable(p_capability) : glDisable(p_capability);
+        return;
+    }
+
+    sync();
+
+    if (!filter(enabled[capability] != int(p_enabled))) return;
+
+    enabled[capability] = p_enabled;
+    p_enabled ? glEnable(p_capability) : glDisable(p_capability);
+}
+
+bool GLState::is_enabled(GLenum p_capability) {
+    int capability = get_capability(p_capability);
+
+    if (capability == -1) return glIsEnabled(p_capability);
+
+    if (enabled[capability] == UNSET_ENABLED) enabled[capability] = glIsEnabled(p_capability);
+
+    return enabled[capability];
+}
+
+void GLState::set_blend_func(GLenum p_source, GLenum p_destination) {
+    set_blend_func(p_source, p_destination, p_source, p_destination);
+}
+
+void GLState::set_blend_func(GLenum p_source, GLenum p_destination, GLenum p_source_alpha,
+                             GLenum p_destination_alpha) {
+    sync();
+
+    if (!filter(blend_source != p_source || blend_destination != p_destination ||
+                blend_source_alpha != p_source_alpha ||
+                blend_destination_alpha != p_destination_alpha))
+        return;
+
+    blend_source = p_source;
+    blend_destination = p_destination;
+    blend_source_alpha = p_source_alpha;
+    blend_destination_alpha = p_destination_alpha;
+    glBlendFuncSeparate(p_source, p_destination, p_source_alpha, p_destination_alpha);
+}
+
+void GLState::set_cull_face(GLenum p_face) {
+    sync();
+
+    if (!filter(cull_face != p_face)) return;
+
+    cull_face = p_face;
+    glCullFace(p_face);
+}
+
+void GLState::set_polygon_mode(GLenum p_mode) {
+    sync();
+
+    if (!filter(polygon_mode != p_mode)) return;
+
+    polygon_mode = p_mode;
+    glPolygonMode(GL_FRONT_AND_BACK, p_mode);
+}
+
+void GLState::use_program(GLuint p_program) {
+    sync();
+
+    if (!filter(program != p_program)) return;
+
+    program = p_program;
+    glUseProgram(p_program);
+}
+
+void GLState::bind_texture(int p_unit, GLenum p_target, GLuint p_texture) {
+    int target = get_target(p_target);
+
+    if (target == -1 || p_unit >= TEXTURE_UNITS) {
+        activate_unit(p_unit);
+        glBindTexture(p_target, p_texture);
+        return;
+    }
+
+    sync();
+
+    if (!filter(textures[p_unit][target] != p_texture)) return;
+
+    activate_unit(p_unit);
+    textures[p_unit][target] = p_texture;
+    glBindTexture(p_target, p_texture);
+}
+
+void GLState::bind_texture(GLenum p_target, GLuint p_texture) {
+    if (active_unit == UNSET) activate_unit(0);
+
+    bind_texture(int(active_unit), p_target, p_texture);
+}
+
+void GLState::bind_vertex_array(GLuint p_vao) {
+    sync();
+
+    if (!filter(vao != p_vao)) return;
+
+    vao = p_vao;
+    glBindVertexArray(p_vao);
+}
+
+void GLState::bind_buffer(GLenum p_target, GLuint p_buffer) {
+    if (p_target != GL_ARRAY_BUFFER) {
+        glBindBuffer(p_target, p_buffer);
+        return;
+    }
+
+    sync();
+
+    if (!filter(array_buffer != p_buffer)) return;
+
+    array_buffer = p_buffer;
+    glBindBuffer(p_target, p_buffer);
+}
+
+void GLState::bind_framebuffer(GLenum p_target, GLuint p_framebuffer) {
+    bool draw = p_target == GL_FRAMEBUFFER || p_target == GL_DRAW_FRAMEBUFFER;
+    bool read = p_target == GL_FRAMEBUFFER || p_target == GL_READ_FRAMEBUFFER;
+
+    sync();
+
+    bool changed = (draw && draw_framebuffer != p_framebuffer) ||
+                   (read && read_framebuffer != p_framebuffer);
+
+    if (!filter(changed)) return;
+
+    if (draw) draw_framebuffer = p_framebuffer;
+    if (read) read_framebuffer = p_framebuffer;
+
+    glBindFramebuffer(p_target, p_framebuffer);
+}
+
+GLuint GLState::get_draw_framebuffer() {
+    if (draw_framebuffer == UNSET) draw_framebuffer = get_integer(GL_DRAW_FRAMEBUFFER_BINDING);
+
+    return draw_framebuffer;
+}
+
+void GLState::delete_texture(GLuint p_texture) {
+    for (int unit = 0; unit < TEXTURE_UNITS; unit++)
+        for (int target = 0; target < TARGET_MAX; target++)
+            if (textures[unit][target] == p_texture) textures[unit][target] = 0;
+
+    glDeleteTextures(1, &p_texture);
+}
+
+void GLState::delete_vertex_array(GLuint p_vao) {
+    if (vao == p_vao) vao = 0;
+
+    glDeleteVertexArrays(1, &p_vao);
+}
+
+void GLState::delete_buffer(GLuint p_buffer) {
+    if (array_buffer == p_buffer) array_buffer = 0;
+
+    glDeleteBuffers(1, &p_buffer);
+}
+
+void GLState::delete_framebuffer(GLuint p_framebuffer) {
+    if (draw_framebuffer == p_framebuffer) draw_framebuffer = 0;
+    if (read_framebuffer == p_framebuffer) read_framebuffer = 0;
+
+    glDeleteFramebuffers(1, &p_framebuffer);
+}
+
+void GLState::delete_program(GLuint p_program) {
+    // A program in use stays current until another one is used, its name may be reused before.
+    if (program == p_program) program = UNSET;
+
+    glDeleteProgram(p_program);
+}
+
+void GLState::invalidate() {
+    for (int c = 0; c < CAP_MAX; c++) enabled[c] = UNSET_ENABLED;
+
+    blend_source = UNSET;
+    blend_destination = UNSET;
+    blend_source_alpha = UNSET;
+    blend_destination_alpha = UNSET;
+    cull_face = UNSET;
+    polygon_mode = UNSET;
+
+    program = UNSET;
+    vao = UNSET;
+    array_buffer = UNSET;
+    draw_framebuffer = UNSET;
+    read_framebuffer = UNSET;
+
+    active_unit = UNSET;
+
+    for (int unit = 0; unit < TEXTURE_UNITS; unit++)
+        for (int target = 0; target < TARGET_MAX; target++) textures[unit][target] = UNSET;
+}
+
+bool GLState::validate() {
+    bool valid = true;
+
+    for (int c = 0; c < CAP_MAX; c++) {
+        if (enabled[c] != UNSET_ENABLED && enabled[c] != int(glIsEnabled(CAPABILITIES[c]))) {
+            T_WARNING("GL state out of sync: capability " + String(int(CAPABILITIES[c])) +
+                      " is " + String(int(glIsEnabled(CAPABILITIES[c]))));
+            valid = false;
+        }
+    }
+
+    GLint polygon_modes[2] = {0, 0};
+    glGetIntegerv(GL_POLYGON_MODE, polygon_modes);
+
+    valid &= check("GL_BLEND_SRC_RGB", blend_source, get_integer(GL_BLEND_SRC_RGB), UNSET);
+    valid &= check("GL_BLEND_DST_RGB", blend_destination, get_integer(GL_BLEND_DST_RGB), UNSET);
+    valid &= check("GL_BLEND_SRC_ALPHA", blend_source_alpha, get_integer(GL_BLEND_SRC_ALPHA),
+                   UNSET);
+    valid &= check("GL_BLEND_DST_ALPHA", blend_destination_alpha, get_integer(GL_BLEND_DST_ALPHA),
+                   UNSET);
+    valid &= check("GL_CULL_FACE_MODE", cull_face, get_integer(GL_CULL_FACE_MODE), UNSET);
+    valid &= check("GL_POLYGON_MODE", polygon_mode, GLuint(polygon_modes[0]), UNSET);
+    valid &= check("GL_CURRENT_PROGRAM", program, get_integer(GL_CURRENT_PROGRAM), UNSET);
+    valid &= check("GL_VERTEX_ARRAY_BINDING", vao, get_integer(GL_VERTEX_ARRAY_BINDING), UNSET);
+    valid &= check("GL_ARRAY_BUFFER_BINDING", array_buffer, get_integer(GL_ARRAY_BUFFER_BINDING),
+                   UNSET);
+    valid &= check("GL_DRAW_FRAMEBUFFER_BINDING", draw_framebuffer,
+                   get_integer(GL_DRAW_FRAMEBUFFER_BINDING), UNSET);
+    valid &= check("GL_READ_FRAMEBUFFER_BINDING", read_framebuffer,
+                   get_integer(GL_READ_FRAMEBUFFER_BINDING), UNSET);
+
+    GLuint unit = get_integer(GL_ACTIVE_TEXTURE) - GL_TEXTURE0;
+    valid &= check("GL_ACTIVE_TEXTURE", active_unit, unit, UNSET);
+
+    // Reading the bindings of a unit needs it to be active, the active unit is restored after.
+    for (int u = 0; u < TEXTURE_UNITS; u++) {
+        glActiveTexture(GL_TEXTURE0 + u);
+
+        for (int target = 0; target < TARGET_MAX; target++)
+            valid &= check("GL_TEXTURE_BINDING", textures[u][target],
+                           get_integer(TARGET_BINDINGS[target]), UNSET);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+
+    // Recovers from a desync, the state is read again where needed.
+    if (!valid) invalidate();
+
+    return valid;
+}
+
+void GLState::set_validation_enabled(bool p_enabled) { validation = p_enabled; }
+
+bool GLState::is_validation_enabled() const { return validation; }
+
+const GLState::Stats& GLState::get_stats() const { return stats; }
+
+void GLState::reset_stats() { stats = Stats(); }
+
+int GLState::get_capability(GLenum p_capability) {
+    for (int c = 0; c < CAP_MAX; c++)
+        if (CAPABILITIES[c] == p_capability) return c;
+
+    return -1;
+}
+
+int GLState::get_target(GLenum p_target) {
+    for (int c = 0; c < TARGET_MAX; c++)
+        if (TARGETS[c] == p_target) return c;
+
+    return -1;
+}
+
+void GLState::activate_unit(int p_unit) {
+    if (active_unit == GLuint(p_unit)) return;
+
+    active_unit = p_unit;
+    glActiveTexture(GL_TEXTURE0 + p_unit);
+}
+
+void GLState::sync() {
+    // A desync invalidates the shadow copy, so the call that follows is issued.
+    if (validation) validate();
+}
+
+bool GLState::filter(bool p_changed) {
+    if (p_changed)
+        stats.issued++;
+    else
+        stats.skipped++;
+
+    return p_changed;
+}
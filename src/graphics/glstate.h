@@ -0,0 +1,114 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#define GLSTATE GLState::get_singleton()
+
+// Shadow copy of the GL state that changes most while drawing, calls that would not change it are
+// dropped.
+//
+// All tracked state has to be changed through here, code that calls GL directly must call
+// invalidate() afterwards. With validation enabled every call first compares the shadow copy with
+// glGet and reports the differences, which finds such code.
+class GLState {
+   public:
+    GLState();
+
+    static GLState* get_singleton();
+
+    // GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST and GL_SCISSOR_TEST are tracked, others pass through.
+    void set_enabled(GLenum p_capability, bool p_enabled);
+    bool is_enabled(GLenum p_capability);
+
+    void set_blend_func(GLenum p_source, GLenum p_destination);
+
+    // Blends the alpha channel with its own factors.
+    void set_blend_func(GLenum p_source, GLenum p_destination, GLenum p_source_alpha,
+                        GLenum p_destination_alpha);
+    void set_cull_face(GLenum p_face);
+    void set_polygon_mode(GLenum p_mode);
+
+    void use_program(GLuint p_program);
+
+    void bind_texture(int p_unit, GLenum p_target, GLuint p_texture);
+
+    // Binds to the active unit, for creating and uploading textures.
+    void bind_texture(GLenum p_target, GLuint p_texture);
+
+    void bind_vertex_array(GLuint p_vao);
+
+    // Only GL_ARRAY_BUFFER is tracked, the element buffer belongs to the vertex array.
+    void bind_buffer(GLenum p_target, GLuint p_buffer);
+
+    void bind_framebuffer(GLenum p_target, GLuint p_framebuffer);
+    GLuint get_draw_framebuffer();
+
+    // GL unbinds deleted objects, the shadow copy has to follow.
+    void delete_texture(GLuint p_texture);
+    void delete_vertex_array(GLuint p_vao);
+    void delete_buffer(GLuint p_buffer);
+    void delete_framebuffer(GLuint p_framebuffer);
+    void delete_program(GLuint p_program);
+
+    // Forgets the shadow copy, the next call for every state is issued.
+    void invalidate();
+
+    // Compares the shadow copy with the GL state and logs every difference, returns false if any.
+    bool validate();
+
+    void set_validation_enabled(bool p_enabled);
+    bool is_validation_enabled() const;
+
+    struct Stats {
+        int issued = 0;
+        int skipped = 0;
+    };
+
+    // Calls issued and dropped since the last reset.
+    const Stats& get_stats() const;
+    void reset_stats();
+
+    static const int TEXTURE_UNITS = 16;
+
+   private:
+    enum Capability { CAP_BLEND, CAP_CULL_FACE, CAP_DEPTH_TEST, CAP_SCISSOR_TEST, CAP_MAX };
+
+    enum Target { TARGET_1D, TARGET_2D, TARGET_3D, TARGET_CUBE_MAP, TARGET_MAX };
+
+    static int get_capability(GLenum p_capability);
+    static int get_target(GLenum p_target);
+
+    void activate_unit(int p_unit);
+
+    // Checks the shadow copy when validating, before a call compares with it.
+    void sync();
+
+    // Counts the call, returns true if it is needed.
+    bool filter(bool p_changed);
+
+    // Values no GL call returns, the next call is always issued.
+    static constexpr GLuint UNSET = ~GLuint(0);
+    static constexpr int UNSET_ENABLED = -1;
+
+    int enabled[CAP_MAX];
+    GLenum blend_source;
+    GLenum blend_destination;
+    GLenum blend_source_alpha;
+    GLenum blend_destination_alpha;
+    GLenum cull_face;
+    GLenum polygon_mode;
+
+    GLuint program;
+    GLuint vao;
+    GLuint array_buffer;
+    GLuint draw_framebuffer;
+    GLuint read_framebuffer;
+
+    GLuint active_unit;
+    GLuint textures[TEXTURE_UNITS][TARGET_MAX];
+
+    bool validation;
+    Stats stats;
+
+    static GLState* singleton;
+};
@@ -2,13 +2,25 @@
 
 #include <stdio.h>
 
+#include "core/time.h"
 #include "core/windowmanager.h"
+#include "graphics/canvasbatch.h"
+#include "graphics/glstate.h"
+#include "graphics/uniformblocks.h"
 #include "view.h"
 #include "world/environment.h"
 #include "world/light.h"
 #include "world/sky.h"
 #include "world/terrain.h"
 
+namespace {
+// GL has one scissor box, shared by the renderers of all viewports.
+vec4i scissor_box;
+
+// Lower left window pixel of the canvas target being drawn, scissor boxes are relative to it.
+vec2i scissor_origin;
+}  // namespace
+
 MasterRenderer* MasterRenderer::singleton;
 
 //=========================================================================
@@ -105,36 +117,78 @@ const mat4& Renderer::get_view_matrix() const { return view_matrix; }
 const mat4& Renderer::get_final_matrix() const { return final_matrix; }
 
 void Renderer::use_scissor(const rect2& area) {
-    glEnable(GL_SCISSOR_TEST);
+    vec4i box = vec4i(WINDOWSIZE.x / 2 + (int)area.get_bottom_left().x - scissor_origin.x,
+                      WINDOWSIZE.y / 2 + (int)area.get_bottom_left().y - scissor_origin.y,
+                      (int)area.size.x * 2, (int)area.size.y * 2);
+
+    if (GLSTATE->is_enabled(GL_SCISSOR_TEST) && box == scissor_box) return;
+
+    // The collected quads were meant for the previous scissor.
+    CANVAS_BATCH->flush();
+
+    GLSTATE->set_enabled(GL_SCISSOR_TEST, true);
 
-    glScissor(WINDOWSIZE.x / 2 + (int)area.get_bottom_left().x,
-              WINDOWSIZE.y / 2 + (int)area.get_bottom_left().y, (int)area.size.x * 2,
-              (int)area.size.y * 2);
+    glScissor(box.x, box.y, box.z, box.w);
+    scissor_box = box;
 }
-void Renderer::stop_scissor() { glDisable(GL_SCISSOR_TEST); }
 
-void Renderer::use_depth_test(float p_near, float p_far) { glEnable(GL_DEPTH_TEST); }
+void Renderer::stop_scissor() {
+    if (!GLSTATE->is_enabled(GL_SCISSOR_TEST)) return;
 
-void Renderer::stop_depth_test() { glDisable(GL_DEPTH_TEST); }
+    CANVAS_BATCH->flush();
+    GLSTATE->set_enabled(GL_SCISSOR_TEST, false);
+}
+
+void Renderer::begin_canvas_target(const rect2& p_area, const vec2i& p_origin) {
+    // The collected quads and the scissor belong to the previous target.
+    stop_scissor();
+    CANVAS_BATCH->flush();
+
+    saved_projection_matrix = projection_matrix;
+    saved_view_matrix = view_matrix;
+
+    projection_matrix = mat4::Scale(vec3(1.0f / p_area.size.x, 1.0f / p_area.size.y, 0.0f));
+    view_matrix = mat4::Translate(vec3(-p_area.pos.x, -p_area.pos.y, 0.0f));
+    update();
+
+    scissor_origin = p_origin;
+}
+
+void Renderer::end_canvas_target() {
+    stop_scissor();
+    CANVAS_BATCH->flush();
+
+    projection_matrix = saved_projection_matrix;
+    view_matrix = saved_view_matrix;
+    update();
+
+    scissor_origin = vec2i();
+}
+
+void Renderer::use_depth_test(float p_near, float p_far) {
+    GLSTATE->set_enabled(GL_DEPTH_TEST, true);
+}
+
+void Renderer::stop_depth_test() { GLSTATE->set_enabled(GL_DEPTH_TEST, false); }
 
 void Renderer::use_culling() {
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    GLSTATE->set_enabled(GL_CULL_FACE, true);
+    GLSTATE->set_cull_face(GL_BACK);
 }
 
-void Renderer::stop_culling() { glDisable(GL_CULL_FACE); }
+void Renderer::stop_culling() { GLSTATE->set_enabled(GL_CULL_FACE, false); }
 
 void Renderer::use_blending() {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLSTATE->set_enabled(GL_BLEND, true);
+    GLSTATE->set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void Renderer::use_additive_blending() {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    GLSTATE->set_enabled(GL_BLEND, true);
+    GLSTATE->set_blend_func(GL_SRC_ALPHA, GL_ONE);
 }
 
-void Renderer::stop_blending() { glDisable(GL_BLEND); }
+void Renderer::stop_blending() { GLSTATE->set_enabled(GL_BLEND, false); }
 
 void Renderer::set_draw_on_screen(bool p_draw_on_screen) { draw_on_screen = p_draw_on_screen; }
 
@@ -150,9 +204,9 @@ bool Renderer::get_draw_canvas() const { return draw_canvas; }
 
 void Renderer::use_wireframe(bool p_wireframe) {
     if (p_wireframe)
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        GLSTATE->set_polygon_mode(GL_LINE);
     else
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        GLSTATE->set_polygon_mode(GL_FILL);
 }
 
 Texture2D* Renderer::get_texture(int p_type) const { return textures[p_type]; }
@@ -164,6 +218,12 @@ FBO2D* Renderer::get_fbo(int p_type) const { return buffers[p_type]; }
 void Renderer::activate() {
     MASTER_RENDERER->set_active_renderer(this);
     // set_viewport();
+
+    FrameData frame;
+    frame.window_size = WINDOWSIZE_F;
+    frame.time = TIME->get_absolutetime() / 1000.0f;
+
+    UNIFORM_BLOCKS->set_frame(frame);
 }
 
 void Renderer::deactivate() {
@@ -233,6 +293,38 @@ void Renderer::update() { final_matrix = projection_matrix * view_matrix; }
 #undef CLASSNAME
 #define CLASSNAME Renderer
 
+const CullStats& Renderer::get_cull_stats(int p_pass) const { return cull_stats[p_pass]; }
+
+const RenderQueue::Stats& Renderer::get_queue_stats(int p_pass) const {
+    return queue_stats[p_pass];
+}
+
+void Renderer::update_view_data() {
+    // The light matrices are kept, they change only with the shadow passes.
+    ViewData view = UNIFORM_BLOCKS->get_view();
+    view.view = final_matrix;
+    view.view_matrix = view_matrix;
+    view.projection_matrix = projection_matrix;
+
+    if (camera) view.camera_position = vec4(camera->get_pos(), 1.0f);
+
+    DirectionalLight* light = viewport && viewport->world ? viewport->world->get_active_light()
+                                                          : nullptr;
+    view.light_direction = vec4(light ? light->get_direction() : vec3(0, 0, -1), 0.0f);
+
+    UNIFORM_BLOCKS->set_view(view);
+}
+
+void Renderer::draw_culled(World* p_world, int p_pass) {
+    update_view_data();
+
+    render_queue.begin(final_matrix);
+    p_world->draw(Frustum(final_matrix), cull_stats[p_pass], render_queue);
+
+    render_queue.submit();
+    queue_stats[p_pass] = render_queue.get_stats();
+}
+
 void Renderer::bind_methods() {}
 
 //=========================================================================
@@ -295,7 +387,7 @@ void ForwardRenderer::render() {
         RENDERER->use_depth_test(c->get_near(), c->get_far());
 
         activate_world_transform();
-        viewport->world->draw();
+        draw_culled(viewport->world, PASS_MAIN);
         deactivate_world_transform();
     }
 
@@ -306,6 +398,7 @@ void ForwardRenderer::render() {
         activate_canvas_transform();
         viewport->canvas->draw();
         viewport->post_draw_canvas();
+        CANVAS_BATCH->flush();
         deactivate_canvas_transform();
     }
 
@@ -505,7 +598,7 @@ void DeferredRenderer::generate_ssao_kernel() {
     }
 
     glGenTextures(1, &kernel_id);
-    glBindTexture(GL_TEXTURE_2D, kernel_id);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, kernel_id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, 8, 8, 0, GL_RGB, GL_FLOAT, &kernel_buffer);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -520,7 +613,7 @@ void DeferredRenderer::generate_ssao_kernel() {
     }
 
     glGenTextures(1, &noise_id);
-    glBindTexture(GL_TEXTURE_2D, noise_id);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, noise_id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, 4, 4, 0, GL_RGB, GL_FLOAT, &noise_buffer[0]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -588,11 +681,9 @@ void DeferredRenderer::render_ssao() {
     textures[DEFERRED_POSITION]->bind(0);
     textures[DEFERRED_NORMAL]->bind(1);
 
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_2D, noise_id);
+    GLSTATE->bind_texture(2, GL_TEXTURE_2D, noise_id);
 
-    glActiveTexture(GL_TEXTURE0 + 3);
-    glBindTexture(GL_TEXTURE_2D, kernel_id);
+    GLSTATE->bind_texture(3, GL_TEXTURE_2D, kernel_id);
 
     ssao->set_uniform("g_position", 0);
     ssao->set_uniform("g_normal", 1);
@@ -637,16 +728,18 @@ void DeferredRenderer::render_shadowmaps() {
 
         RENDERER->use_depth_test(camera->get_near(), camera->get_far());
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
+        GLSTATE->set_enabled(GL_CULL_FACE, true);
+        GLSTATE->set_cull_face(GL_BACK);
 
-        for (int c = 0; c < viewport->world->get_child_count(); c++) {
-            Node* n = viewport->world->get_child_by_index(c);
-            WorldObject* wo = n->cast_to_type<WorldObject*>();
-            wo->notificate(WorldObject::NOTIFICATION_DRAW);
-        }
+        draw_culled(viewport->world, PASS_SHADOW_FAR + i);
     }
 
+    ViewData view = UNIFORM_BLOCKS->get_view();
+    view.light_matrix_far = light_matrices[0];
+    view.light_matrix_middle = light_matrices[1];
+    view.light_matrix_near = light_matrices[2];
+    UNIFORM_BLOCKS->set_view(view);
+
     RENDERER->stop_depth_test();
 
     set_camera(camera);
@@ -670,11 +763,7 @@ void DeferredRenderer::render_reflection() {
 
     RENDERER->use_depth_test(c->get_near(), c->get_far());
 
-    for (int c = 0; c < ACTIVE_WORLD->get_child_count(); c++) {
-        Node* n = ACTIVE_WORLD->get_child_by_index(c);
-        WorldObject* wo = n->cast_to_type<WorldObject*>();
-        wo->notificate(WorldObject::NOTIFICATION_DRAW);
-    }
+    draw_culled(ACTIVE_WORLD, PASS_REFLECTION);
 
     RENDERER->stop_depth_test();
 
@@ -787,58 +876,54 @@ void DeferredRenderer::render_first_pass() {
     Color sky_color;
     Color light_color;
     Sky* sky = ACTIVE_WORLD->get_child_by_type<Sky*>();
-    vec3 view_pos = ACTIVE_WORLD->get_active_camera()->get_pos();
     DirectionalLight* light = ACTIVE_WORLD->get_active_light();
     bool lighting_enabled = false;
-    vec3 light_dir = vec3(0, 0, -1);
 
     if (sky) {
         sky_color = sky->get_sky_color();
     }
 
     if (light) {
-        light_dir = light->get_direction();
         lighting_enabled = true;
         light_color = light->get_color();
     }
 
+    // Lit as seen from the main camera, the view data is still of the reflection pass.
+    set_camera(ACTIVE_WORLD->get_active_camera());
+    update_view_data();
+
     first_pass->bind();
     // first_pass->set_uniform("clouds_enabled", false);
-    first_pass->set_uniform("godray_enabled", true);
-    first_pass->set_uniform("g_albedo", 0);
-    first_pass->set_uniform("g_position", 1);
-    first_pass->set_uniform("g_normal", 2);
-    first_pass->set_uniform("g_material", 3);
-    first_pass->set_uniform("shadow_map_far", 4);
-    first_pass->set_uniform("shadow_map_middle", 5);
-    first_pass->set_uniform("shadow_map_near", 6);
-    first_pass->set_uniform("godray_tex", 7);
-    first_pass->set_uniform("ssao_tex", 8);
-
-    first_pass->set_uniform("light_matrix_far", light_matrices[0]);
-    first_pass->set_uniform("light_matrix_middle", light_matrices[1]);
-    first_pass->set_uniform("light_matrix_near", light_matrices[2]);
-    first_pass->set_uniform("lighting_enabled", lighting_enabled);
-    first_pass->set_uniform("light_dir", light_dir);
-    first_pass->set_uniform("light_color", vec3(1.0));
+    first_pass->set_uniform("godray_enabled"_uniform, true);
+    first_pass->set_uniform("g_albedo"_uniform, 0);
+    first_pass->set_uniform("g_position"_uniform, 1);
+    first_pass->set_uniform("g_normal"_uniform, 2);
+    first_pass->set_uniform("g_material"_uniform, 3);
+    first_pass->set_uniform("shadow_map_far"_uniform, 4);
+    first_pass->set_uniform("shadow_map_middle"_uniform, 5);
+    first_pass->set_uniform("shadow_map_near"_uniform, 6);
+    first_pass->set_uniform("godray_tex"_uniform, 7);
+    first_pass->set_uniform("ssao_tex"_uniform, 8);
+
+    first_pass->set_uniform("lighting_enabled"_uniform, lighting_enabled);
+    first_pass->set_uniform("light_color"_uniform, vec3(1.0));
 
     if (environment) {
-        first_pass->set_uniform("ambient", environment->get_ambient_color().get_rgb());
-        first_pass->set_uniform("fog_enabled", environment->get_fog_enabled());
-        first_pass->set_uniform("fog_density", environment->get_fog_density());
-        first_pass->set_uniform("fog_gradient", environment->get_fog_gradient());
-        first_pass->set_uniform("ssao_enabled", environment->get_ssao_enabled());
+        first_pass->set_uniform("ambient"_uniform, environment->get_ambient_color().get_rgb());
+        first_pass->set_uniform("fog_enabled"_uniform, environment->get_fog_enabled());
+        first_pass->set_uniform("fog_density"_uniform, environment->get_fog_density());
+        first_pass->set_uniform("fog_gradient"_uniform, environment->get_fog_gradient());
+        first_pass->set_uniform("ssao_enabled"_uniform, environment->get_ssao_enabled());
     } else {
-        first_pass->set_uniform("ambient", vec3(0.4f));
-        first_pass->set_uniform("fog_enabled", false);
-        first_pass->set_uniform("ssao_enabled", false);
+        first_pass->set_uniform("ambient"_uniform, vec3(0.4f));
+        first_pass->set_uniform("fog_enabled"_uniform, false);
+        first_pass->set_uniform("ssao_enabled"_uniform, false);
     }
 
-    first_pass->set_uniform("view_pos", view_pos);
-    first_pass->set_uniform("light_color", vec3(1.0f));
-    first_pass->set_uniform("specular_strength", .1f);
-    first_pass->set_uniform("specular_power", 32.0f);
-    first_pass->set_uniform("sky_color", sky_color.get_rgb());
+    first_pass->set_uniform("light_color"_uniform, vec3(1.0f));
+    first_pass->set_uniform("specular_strength"_uniform, .1f);
+    first_pass->set_uniform("specular_power"_uniform, 32.0f);
+    first_pass->set_uniform("sky_color"_uniform, sky_color.get_rgb());
 
     render_buffer->bind();
 
@@ -847,10 +932,10 @@ void DeferredRenderer::render_first_pass() {
 
 void DeferredRenderer::render_second_pass() {
     second_pass->bind();
-    second_pass->set_uniform("render_buffer", 0);
-    second_pass->set_uniform("blur_buffer", 1);
-    second_pass->set_uniform("depth_buffer", 2);
-    second_pass->set_uniform("bloom_buffer", 3);
+    second_pass->set_uniform("render_buffer"_uniform, 0);
+    second_pass->set_uniform("blur_buffer"_uniform, 1);
+    second_pass->set_uniform("depth_buffer"_uniform, 2);
+    second_pass->set_uniform("bloom_buffer"_uniform, 3);
 
     bool dof_enabled = false;
     float dof_rate = 4.0f;
@@ -868,12 +953,12 @@ void DeferredRenderer::render_second_pass() {
         gamma = environment->get_gamma();
     }
 
-    second_pass->set_uniform("dof_enabled", dof_enabled);
-    second_pass->set_uniform("bloom_enabled", bloom_enabled);
-    second_pass->set_uniform("dof_rate", dof_rate);
-    second_pass->set_uniform("dof_focus", dof_focus);
-    second_pass->set_uniform("exposure", exposure);
-    second_pass->set_uniform("gamma", gamma);
+    second_pass->set_uniform("dof_enabled"_uniform, dof_enabled);
+    second_pass->set_uniform("bloom_enabled"_uniform, bloom_enabled);
+    second_pass->set_uniform("dof_rate"_uniform, dof_rate);
+    second_pass->set_uniform("dof_focus"_uniform, dof_focus);
+    second_pass->set_uniform("exposure"_uniform, exposure);
+    second_pass->set_uniform("gamma"_uniform, gamma);
 
     textures[RENDER_COLOR]->bind(0);
     textures[BLUR]->bind(1);
@@ -944,7 +1029,7 @@ void DeferredRenderer::render() {
         use_wireframe(viewport->get_wireframe_enabled());
 
         activate_world_transform();
-        viewport->world->draw();
+        draw_culled(viewport->world, PASS_MAIN);
         viewport->post_draw_world();
         deactivate_world_transform();
 
@@ -959,6 +1044,7 @@ void DeferredRenderer::render() {
     if (viewport->canvas && draw_canvas) viewport->canvas->draw();
 
     viewport->post_draw_canvas();
+    CANVAS_BATCH->flush();
     deactivate_canvas_transform();
 
     render_virtual_tex();
@@ -17,7 +17,9 @@
 #include "fbo.h"
 #include "fbomanager.h"
 #include "game/scene.h"
+#include "math/frustum.h"
 #include "postprocess.h"
+#include "renderqueue.h"
 #include "resources/shader.h"
 #include "resources/texture.h"
 #include "world/camera.h"
@@ -32,6 +34,7 @@
 
 class Environment;
 class Renderer;
+class World;
 
 class MasterRenderer : public Object {
     OBJ_DEFINITION(MasterRenderer, Object);
@@ -79,6 +82,11 @@ class Renderer : public Object {
     void use_scissor(const rect2& area);
     void stop_scissor();
 
+    // Maps p_area of the canvas to the whole of an offscreen target whose lower left corner is
+    // at window pixel p_origin, until end_canvas_target. Binding the target is up to the caller.
+    void begin_canvas_target(const rect2& p_area, const vec2i& p_origin);
+    void end_canvas_target();
+
     void use_depth_test(float p_near, float p_far);
     void stop_depth_test();
 
@@ -110,6 +118,22 @@ class Renderer : public Object {
     void draw_plane();
     void draw_line(const vec3& p_start, const vec3& p_end, const Color& p_color);
 
+    // Passes that draw the world, each one culls against the view volume of its own camera.
+    enum CullPass {
+        PASS_MAIN,
+        PASS_SHADOW_FAR,
+        PASS_SHADOW_MIDDLE,
+        PASS_SHADOW_NEAR,
+        PASS_REFLECTION,
+        PASS_MAX
+    };
+
+    // Objects drawn and culled by the last run of a pass.
+    const CullStats& get_cull_stats(int p_pass) const;
+
+    // Packets and state changes of the queue in the last run of a pass.
+    const RenderQueue::Stats& get_queue_stats(int p_pass) const;
+
     static void bind_methods();
 
    protected:
@@ -125,9 +149,20 @@ class Renderer : public Object {
 
     void update();
 
+    // Uploads the matrices and position of the current camera to the shared view block.
+    void update_view_data();
+
+    // Draws the world with the current camera.
+    void draw_culled(World* p_world, int p_pass);
+
     Camera* camera;
     Viewport* viewport;
 
+    CullStats cull_stats[PASS_MAX];
+
+    RenderQueue render_queue;
+    RenderQueue::Stats queue_stats[PASS_MAX];
+
     Vector<FBO2D> buffers;
     Map<int, Texture2D> textures;
 
@@ -136,6 +171,10 @@ class Renderer : public Object {
     mat4 final_matrix;
     mat4 canvas_matrix;
 
+    // Matrices of the canvas while drawing into a target.
+    mat4 saved_projection_matrix;
+    mat4 saved_view_matrix;
+
     bool draw_on_screen;
     bool draw_world;
     bool draw_canvas;
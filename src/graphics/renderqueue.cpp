@@ -0,0 +1,320 @@
+#include "renderqueue.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "graphics/glstate.h"
+#include "graphics/renderer.h"
+#include "resources/shader.h"
+#include "resources/texture.h"
+
+namespace {
+const int ID_BITS = 10;
+const int DEPTH_BITS = 20;
+const unsigned MAX_ID = (1 << ID_BITS) - 1;
+const uint32_t MAX_DEPTH = (1 << DEPTH_BITS) - 1;
+
+// Non-negative floats keep their order when compared as integers, the high bits are enough.
+uint32_t quantize_depth(float p_depth) {
+    if (!(p_depth > 0.0f)) return 0;
+
+    uint32_t bits;
+    memcpy(&bits, &p_depth, sizeof(bits));
+
+    return bits >> (32 - DEPTH_BITS);
+}
+}  // namespace
+
+RenderQueue::RenderQueue() {
+    instance_buffer = 0;
+    instance_capacity = 0;
+}
+
+RenderQueue::~RenderQueue() {
+    if (instance_buffer) GLSTATE->delete_buffer(instance_buffer);
+}
+
+void RenderQueue::begin(const mat4& p_view_projection) {
+    view_projection = p_view_projection;
+
+    packets.clear();
+    items.clear();
+
+    shader_ids.clear();
+    material_ids.clear();
+    texture_ids.clear();
+    vao_ids.clear();
+}
+
+void RenderQueue::add(const DrawPacket& p_packet) {
+    items.push_back({make_key(p_packet), uint32_t(packets.size())});
+    packets.push_back(p_packet);
+}
+
+template <typename F>
+RenderQueue::Switches RenderQueue::count_switches(int p_count, F p_packet) const {
+    Switches switches;
+    const DrawPacket* previous = nullptr;
+    const Texture2D* texture = nullptr;
+
+    for (int c = 0; c < p_count; c++) {
+        const DrawPacket* packet = p_packet(c);
+
+        if (!previous || packet->shader != previous->shader) switches.shader++;
+        if (!previous || packet->vao != previous->vao) switches.vao++;
+
+        if (packet->texture && packet->texture != texture) {
+            texture = packet->texture;
+            switches.texture++;
+        }
+
+        previous = packet;
+    }
+
+    return switches;
+}
+
+void RenderQueue::submit() {
+    stats = Stats();
+    stats.packets = int(packets.size());
+
+    if (packets.empty()) return;
+
+    stats.unsorted =
+        count_switches(int(packets.size()), [this](int p_index) { return &packets[p_index]; });
+
+    sort();
+
+    stats.sorted = count_switches(int(items.size()),
+                                  [this](int p_index) { return &packets[items[p_index].index]; });
+
+    make_batches();
+    upload_instances();
+
+    RENDERER->use_blending();
+
+    Shader* shader = nullptr;
+    Texture2D* texture = nullptr;
+    GLuint vao = 0;
+
+    UniformHandle<bool> texture_enabled;
+    UniformHandle<bool> instanced;
+    UniformHandle<mat4> model;
+    UniformHandle<vec3> color_id;
+    UniformHandle<Color> color;
+
+    for (const Batch& batch : batches) {
+        const DrawPacket& packet = packets[items[batch.first].index];
+
+        if (packet.shader != shader) {
+            shader = packet.shader;
+            shader->bind();
+
+            // Shaders that include Uniforms.glsl read the view from the shared block.
+            shader->set_uniform(shader->get_uniform<mat4>("view"_uniform), view_projection);
+
+            texture_enabled = shader->get_uniform<bool>("texture_enabled"_uniform);
+            instanced = shader->get_uniform<bool>("instanced"_uniform);
+            model = shader->get_uniform<mat4>("model"_uniform);
+            color_id = shader->get_uniform<vec3>("color_id"_uniform);
+            color = shader->get_uniform<Color>("color"_uniform);
+        }
+
+        if (packet.texture && packet.texture != texture) {
+            texture = packet.texture;
+            texture->bind(0);
+        }
+
+        if (packet.vao != vao) {
+            vao = packet.vao;
+            GLSTATE->bind_vertex_array(vao);
+        }
+
+        // Unchanged values are skipped by the shader.
+        shader->set_uniform(texture_enabled, packet.texture != nullptr);
+
+        stats.draws++;
+
+        if (batch.count == 1) {
+            shader->set_uniform(model, packet.model);
+            shader->set_uniform(color_id, packet.color_id);
+            shader->set_uniform(color, packet.color);
+
+            glDrawElements(GL_TRIANGLES, packet.index_count, GL_UNSIGNED_INT, 0);
+            continue;
+        }
+
+        // Only true during the call, draws outside the queue use the same program.
+        bind_instances(batch.base_instance);
+        shader->set_uniform(instanced, true);
+
+        glDrawElementsInstanced(GL_TRIANGLES, packet.index_count, GL_UNSIGNED_INT, 0,
+                                batch.count);
+
+        shader->set_uniform(instanced, false);
+        unbind_instances();
+
+        stats.instanced += batch.count;
+    }
+
+    GLSTATE->bind_vertex_array(0);
+
+    packets.clear();
+    items.clear();
+}
+
+int RenderQueue::get_size() const { return int(packets.size()); }
+
+const RenderQueue::Stats& RenderQueue::get_stats() const { return stats; }
+
+uint64_t RenderQueue::make_key(const DrawPacket& p_packet) {
+    uint64_t shader = get_id(shader_ids, uintptr_t(p_packet.shader));
+    uint64_t material = get_id(material_ids, uintptr_t(p_packet.material));
+    uint64_t texture = get_id(texture_ids, uintptr_t(p_packet.texture));
+    uint64_t vao = get_id(vao_ids, p_packet.vao);
+
+    const float* m = p_packet.model.m;
+    vec4 clip = view_projection * vec4(m[12], m[13], m[14], 1.0f);
+    uint64_t depth = quantize_depth(clip.z);
+
+    // The layer takes the top 4 bits. Opaque keys continue with the ids of 10 bits and end with the
+    // depth, transparent keys put the inverted depth first.
+    if (p_packet.color.a < 1.0f) {
+        uint64_t layer = LAYER_TRANSPARENT;
+        uint64_t far_first = MAX_DEPTH - depth;
+
+        return layer << 60 | far_first << 40 | shader << 30 | material << 20 | texture << 10 | vao;
+    }
+
+    uint64_t layer = LAYER_OPAQUE;
+    return layer << 60 | shader << 50 | material << 40 | texture << 30 | vao << 20 | depth;
+}
+
+unsigned RenderQueue::get_id(std::unordered_map<uintptr_t, unsigned>& r_ids, uintptr_t p_state) {
+    if (!p_state) return 0;
+
+    auto it = r_ids.find(p_state);
+    if (it != r_ids.end()) return it->second;
+
+    // Past the last id states share one, they are still bound correctly but grouped less.
+    unsigned id = unsigned(r_ids.size()) + 1;
+    if (id > MAX_ID) id = MAX_ID;
+
+    r_ids[p_state] = id;
+    return id;
+}
+
+void RenderQueue::sort() {
+    scratch.resize(items.size());
+
+    // Least significant byte first, bytes equal for all keys are skipped.
+    for (int shift = 0; shift < 64; shift += 8) {
+        uint32_t offsets[256] = {};
+
+        for (const Item& item : items) offsets[(item.key >> shift) & 0xFF]++;
+
+        if (offsets[(items[0].key >> shift) & 0xFF] == items.size()) continue;
+
+        uint32_t total = 0;
+
+        for (uint32_t& offset : offsets) {
+            uint32_t count = offset;
+            offset = total;
+            total += count;
+        }
+
+        for (const Item& item : items) scratch[offsets[(item.key >> shift) & 0xFF]++] = item;
+
+        items.swap(scratch);
+    }
+}
+
+void RenderQueue::make_batches() {
+    batches.clear();
+    instances.clear();
+
+    const Shader* shader = nullptr;
+    bool instancing = false;
+
+    for (uint32_t c = 0; c < items.size();) {
+        const DrawPacket& first = packets[items[c].index];
+
+        if (first.shader != shader) {
+            shader = first.shader;
+            instancing = shader->get_uniform<bool>("instanced"_uniform).is_valid();
+        }
+
+        uint32_t count = 1;
+
+        if (instancing && first.instancing) {
+            while (c + count < items.size() &&
+                   can_instance(first, packets[items[c + count].index]))
+                count++;
+        }
+
+        batches.push_back({c, count, uint32_t(instances.size())});
+
+        for (uint32_t i = c; count > 1 && i < c + count; i++) {
+            const DrawPacket& packet = packets[items[i].index];
+            Instance instance;
+
+            memcpy(instance.model, packet.model.m, sizeof(instance.model));
+            memcpy(instance.color, packet.color.v, sizeof(instance.color));
+            memcpy(instance.color_id, &packet.color_id.x, sizeof(instance.color_id));
+
+            instances.push_back(instance);
+        }
+
+        c += count;
+    }
+}
+
+bool RenderQueue::can_instance(const DrawPacket& p_first, const DrawPacket& p_packet) {
+    return p_packet.instancing && p_packet.shader == p_first.shader &&
+           p_packet.material == p_first.material && p_packet.texture == p_first.texture &&
+           p_packet.vao == p_first.vao && p_packet.index_count == p_first.index_count;
+}
+
+void RenderQueue::upload_instances() {
+    if (instances.empty()) return;
+
+    if (!instance_buffer) glGenBuffers(1, &instance_buffer);
+
+    size_t size = instances.size() * sizeof(Instance);
+    instance_capacity = std::max(instance_capacity, size);
+
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+
+    // Orphans the storage of the last submit, so the driver does not wait for the draws using it.
+    glBufferData(GL_ARRAY_BUFFER, instance_capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+}
+
+void RenderQueue::bind_instances(uint32_t p_base_instance) {
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+
+    const GLsizei stride = sizeof(Instance);
+    size_t base = p_base_instance * sizeof(Instance);
+
+    for (int c = 0; c < 4; c++) {
+        size_t offset = base + offsetof(Instance, model) + c * 4 * sizeof(float);
+        glVertexAttribPointer(ATTRIBUTE_MODEL + c, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    }
+
+    glVertexAttribPointer(ATTRIBUTE_COLOR, 4, GL_FLOAT, GL_FALSE, stride,
+                          (void*)(base + offsetof(Instance, color)));
+    glVertexAttribPointer(ATTRIBUTE_COLOR_ID, 3, GL_FLOAT, GL_FALSE, stride,
+                          (void*)(base + offsetof(Instance, color_id)));
+
+    for (int location = ATTRIBUTE_MODEL; location < ATTRIBUTE_MAX; location++) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+void RenderQueue::unbind_instances() {
+    // The vertex array is shared with draws that do not provide instance data.
+    for (int location = ATTRIBUTE_MODEL; location < ATTRIBUTE_MAX; location++)
+        glDisableVertexAttribArray(location);
+}
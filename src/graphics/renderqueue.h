@@ -0,0 +1,146 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "math/color.h"
+#include "math/mat4.h"
+
+class Material;
+class Shader;
+class Texture2D;
+
+// One indexed draw of a mesh node with the state it needs.
+struct DrawPacket {
+    Shader* shader = nullptr;
+    Material* material = nullptr;
+    Texture2D* texture = nullptr;
+
+    GLuint vao = 0;
+    GLsizei index_count = 0;
+
+    mat4 model;
+    Color color;
+    vec3 color_id;
+
+    // Allows drawing this packet as an instance together with neighbours in the same state.
+    bool instancing = true;
+};
+
+// Collects the draws of a pass, sorts them and submits them with as few state changes as possible.
+//
+// Every packet gets a 64 bit key. Opaque packets are ordered by shader, material, texture, vertex
+// array and then front to back, transparent ones back to front first so they still blend
+// correctly. The keys are radix sorted and binds that match the previous packet are skipped.
+//
+// Runs of packets that only differ in their model matrix and colours are drawn with one instanced
+// call if their shader declares the instanced uniform, see engine/shaders/Shader3D.vert. Their
+// per-instance data is streamed to one buffer per submit.
+class RenderQueue {
+   public:
+    RenderQueue();
+    ~RenderQueue();
+
+    struct Switches {
+        int shader = 0;
+        int texture = 0;
+        int vao = 0;
+    };
+
+    struct Stats {
+        int packets = 0;
+
+        // Draw calls issued, and the packets drawn as instances by some of them.
+        int draws = 0;
+        int instanced = 0;
+
+        // State changes in the order the packets were collected and in the order of submission.
+        Switches unsorted;
+        Switches sorted;
+    };
+
+    // Starts collecting a pass drawn with p_view_projection.
+    void begin(const mat4& p_view_projection);
+
+    void add(const DrawPacket& p_packet);
+
+    // Sorts and draws the packets, then empties the queue.
+    void submit();
+
+    int get_size() const;
+
+    // Of the last submit.
+    const Stats& get_stats() const;
+
+    enum Layer { LAYER_OPAQUE, LAYER_TRANSPARENT };
+
+    // Vertex attribute locations of the per-instance data, the model matrix takes four.
+    enum InstanceAttribute {
+        ATTRIBUTE_MODEL = 3,
+        ATTRIBUTE_COLOR = 7,
+        ATTRIBUTE_COLOR_ID = 8,
+        ATTRIBUTE_MAX = 9
+    };
+
+   private:
+    struct Item {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // Consecutive sorted items drawn by one call.
+    struct Batch {
+        uint32_t first;
+        uint32_t count;
+        uint32_t base_instance;
+    };
+
+    // Layout of the instance buffer.
+    struct Instance {
+        float model[16];
+        float color[4];
+        float color_id[3];
+    };
+
+    uint64_t make_key(const DrawPacket& p_packet);
+
+    // Small ids for the key, in the order the state was first seen this pass.
+    unsigned get_id(std::unordered_map<uintptr_t, unsigned>& r_ids, uintptr_t p_state);
+
+    void sort();
+
+    // Groups the sorted items into batches and collects the data of instanced ones.
+    void make_batches();
+    static bool can_instance(const DrawPacket& p_first, const DrawPacket& p_packet);
+
+    void upload_instances();
+
+    // Points the instance attributes of the bound vertex array at the data of a batch.
+    void bind_instances(uint32_t p_base_instance);
+    void unbind_instances();
+
+    template <typename F>
+    Switches count_switches(int p_count, F p_packet) const;
+
+    mat4 view_projection;
+
+    std::vector<DrawPacket> packets;
+    std::vector<Item> items;
+    std::vector<Item> scratch;
+
+    std::vector<Batch> batches;
+    std::vector<Instance> instances;
+
+    GLuint instance_buffer;
+    size_t instance_capacity;
+
+    std::unordered_map<uintptr_t, unsigned> shader_ids;
+    std::unordered_map<uintptr_t, unsigned> material_ids;
+    std::unordered_map<uintptr_t, unsigned> texture_ids;
+    std::unordered_map<uintptr_t, unsigned> vao_ids;
+
+    Stats stats;
+};
@@ -0,0 +1,203 @@
+#include "textureatlas.h"
+
+#include <cstring>
+
+#include "core/tmessage.h"
+#include "graphics/glstate.h"
+#include "math/math.h"
+#include "resources/texture.h"
+
+TextureAtlas::TextureAtlas(int p_size) {
+    size = p_size;
+    id = 0;
+    shelves_height = 0;
+}
+
+TextureAtlas::~TextureAtlas() {
+    if (id) GLSTATE->delete_texture(id);
+}
+
+void TextureAtlas::add(Texture2D* p_texture) {
+    added.insert(p_texture);
+
+    // A texture that was refused before gets another try.
+    auto it = entries.find(p_texture);
+    if (it != entries.end() && !it->second.packed) entries.erase(it);
+}
+
+bool TextureAtlas::find(Texture2D* p_texture, vec4& r_bounds) {
+    if (!id) create();
+
+    auto it = entries.find(p_texture);
+
+    if (it != entries.end() && it->second.generation == p_texture->get_generation()) {
+        r_bounds = it->second.bounds;
+        return it->second.packed;
+    }
+
+    // Not loaded yet, asked again once it is.
+    if (!p_texture->is_ready()) return false;
+
+    Entry& entry = entries[p_texture];
+    entry.generation = p_texture->get_generation();
+    entry.packed = false;
+
+    if (!is_allowed(p_texture)) return false;
+
+    int width = int(p_texture->get_size().x);
+    int height = int(p_texture->get_size().y);
+    std::vector<unsigned char> pixels(size_t(width) * height * 4);
+
+    GLSTATE->bind_texture(GL_TEXTURE_2D, p_texture->get_id());
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    entry.packed = pack(pixels.data(), width, height, entry.bounds);
+    r_bounds = entry.bounds;
+
+    return entry.packed;
+}
+
+void TextureAtlas::remove(Texture2D* p_texture) {
+    entries.erase(p_texture);
+    added.erase(p_texture);
+}
+
+const vec4& TextureAtlas::get_white_bounds() {
+    if (!id) create();
+
+    return white_bounds;
+}
+
+bool TextureAtlas::reserve(int p_width, int p_height, int& r_x, int& r_y) {
+    if (!id) create();
+
+    return reuse(p_width, p_height, r_x, r_y) || allocate(p_width, p_height, r_x, r_y);
+}
+
+void TextureAtlas::release(int p_x, int p_y, int p_width, int p_height) {
+    released.push_back({p_x, p_y, p_width, p_height});
+}
+
+void TextureAtlas::upload(int p_x, int p_y, int p_width, int p_height,
+                          const unsigned char* p_pixels) {
+    GLSTATE->bind_texture(GL_TEXTURE_2D, id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, p_x, p_y, p_width, p_height, GL_RGBA, GL_UNSIGNED_BYTE,
+                    p_pixels);
+}
+
+int TextureAtlas::get_size() const { return size; }
+
+GLuint TextureAtlas::get_id() const { return id; }
+
+void TextureAtlas::create() {
+    glGenTextures(1, &id);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, id);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Left undefined, only packed areas and their borders are ever sampled.
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    const unsigned char white[2 * 2 * 4] = {255, 255, 255, 255, 255, 255, 255, 255,
+                                            255, 255, 255, 255, 255, 255, 255, 255};
+    vec4 bounds;
+
+    pack(white, 2, 2, bounds);
+
+    // The centre, filtering gives pure white there.
+    vec2 center = vec2(bounds.x + bounds.y, bounds.z + bounds.w) / 2.0f;
+    white_bounds = vec4(center.x, center.x, center.y, center.y);
+}
+
+bool TextureAtlas::allocate(int p_width, int p_height, int& r_x, int& r_y) {
+    if (p_width > size || p_height > size) return false;
+
+    for (Shelf& shelf : shelves) {
+        // Skips shelves that would waste most of their height.
+        if (shelf.height < p_height || shelf.height > p_height * 2) continue;
+        if (shelf.x + p_width > size) continue;
+
+        r_x = shelf.x;
+        r_y = shelf.y;
+        shelf.x += p_width;
+        return true;
+    }
+
+    if (shelves_height + p_height > size) return false;
+
+    shelves.push_back({shelves_height, p_height, p_width});
+    r_x = 0;
+    r_y = shelves_height;
+    shelves_height += p_height;
+
+    return true;
+}
+
+bool TextureAtlas::reuse(int p_width, int p_height, int& r_x, int& r_y) {
+    for (size_t c = 0; c < released.size(); c++) {
+        Area area = released[c];
+        if (area.width < p_width || area.height < p_height) continue;
+
+        released.erase(released.begin() + c);
+
+        // The part right of the taken area and the part below it.
+        if (area.width > p_width)
+            released.push_back({area.x + p_width, area.y, area.width - p_width, p_height});
+
+        if (area.height > p_height)
+            released.push_back({area.x, area.y + p_height, area.width, area.height - p_height});
+
+        r_x = area.x;
+        r_y = area.y;
+        return true;
+    }
+
+    return false;
+}
+
+bool TextureAtlas::pack(const unsigned char* p_pixels, int p_width, int p_height,
+                        vec4& r_bounds) {
+    int padded_width = p_width + 2;
+    int padded_height = p_height + 2;
+    int x, y;
+
+    if (!allocate(padded_width, padded_height, x, y)) {
+        T_LOG("Texture atlas is full, drawing a texture of " + String(p_width) + "x" +
+              String(p_height) + " separately");
+        return false;
+    }
+
+    std::vector<unsigned char> padded(size_t(padded_width) * padded_height * 4);
+
+    for (int row = 0; row < padded_height; row++) {
+        int source_row = MIN(MAX(row - 1, 0), p_height - 1);
+        const unsigned char* source = p_pixels + size_t(source_row) * p_width * 4;
+        unsigned char* destination = &padded[size_t(row) * padded_width * 4];
+
+        memcpy(destination + 4, source, size_t(p_width) * 4);
+        memcpy(destination, source, 4);
+        memcpy(destination + size_t(p_width + 1) * 4, source + size_t(p_width - 1) * 4, 4);
+    }
+
+    upload(x, y, padded_width, padded_height, padded.data());
+
+    float s = float(size);
+    r_bounds = vec4((x + 1) / s, (x + 1 + p_width) / s, (y + 1) / s, (y + 1 + p_height) / s);
+
+    return true;
+}
+
+bool TextureAtlas::is_allowed(Texture2D* p_texture) const {
+    if (p_texture->get_size().x < 1.0f || p_texture->get_size().y < 1.0f) return false;
+
+    if (added.count(p_texture)) return true;
+
+    // Generated textures like render targets may change every frame.
+    if (p_texture->get_file().size() == 0 || !p_texture->get_generation()) return false;
+
+    vec2 texture_size = p_texture->get_size();
+    return texture_size.x <= MAX_ENTRY_SIZE && texture_size.y <= MAX_ENTRY_SIZE;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "math/vec3.h"
+#include "math/vec4.h"
+
+class Texture2D;
+
+// One GL texture holding copies of many small textures, so quads using different ones can be
+// drawn by one call.
+//
+// Textures loaded from a file and at most MAX_ENTRY_SIZE pixels in both directions are copied in
+// the first time they are asked for, larger or generated ones only after add(). Every copy gets a
+// border of its own edge pixels so filtering does not reach into the neighbours. The space of
+// textures is never reused, a texture that does not fit anymore is simply drawn on its own. Areas
+// reserved for data managed elsewhere are reused once they are released.
+class TextureAtlas {
+   public:
+    TextureAtlas(int p_size = 2048);
+    ~TextureAtlas();
+
+    // Allows packing p_texture regardless of its size and origin, its contents must not change
+    // unless it is reloaded.
+    void add(Texture2D* p_texture);
+
+    // Looks up or packs p_texture, r_bounds gets its area in the atlas as left, right, bottom and
+    // top texture coordinates. Returns false if it has to be drawn on its own.
+    bool find(Texture2D* p_texture, vec4& r_bounds);
+
+    // Forgets p_texture before it is deleted, its area stays taken.
+    void remove(Texture2D* p_texture);
+
+    // The area of a white block, for drawing untextured quads with the atlas bound.
+    const vec4& get_white_bounds();
+
+    // Reserves an area for data managed elsewhere, like glyphs. Returns false if the atlas is full.
+    bool reserve(int p_width, int p_height, int& r_x, int& r_y);
+
+    // Gives back a reserved area, flush the canvas batch first if it may still draw from it.
+    void release(int p_x, int p_y, int p_width, int p_height);
+
+    // Replaces RGBA pixels of a reserved area, flush the canvas batch first if it may still draw
+    // the old ones.
+    void upload(int p_x, int p_y, int p_width, int p_height, const unsigned char* p_pixels);
+
+    int get_size() const;
+    GLuint get_id() const;
+
+    static const int MAX_ENTRY_SIZE = 64;
+
+   private:
+    struct Entry {
+        vec4 bounds;
+        unsigned generation;
+        bool packed;
+    };
+
+    // Row of entries that are at most as high as the row.
+    struct Shelf {
+        int y;
+        int height;
+        int x;
+    };
+
+    struct Area {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    // Takes a released area that fits, the rest of it stays released.
+    bool reuse(int p_width, int p_height, int& r_x, int& r_y);
+
+    void create();
+
+    // Reserves p_width by p_height pixels, returns false if the atlas is full.
+    bool allocate(int p_width, int p_height, int& r_x, int& r_y);
+
+    // Copies RGBA pixels with a one pixel border, r_bounds gets the area without the border.
+    bool pack(const unsigned char* p_pixels, int p_width, int p_height, vec4& r_bounds);
+
+    bool is_allowed(Texture2D* p_texture) const;
+
+    int size;
+    GLuint id;
+
+    std::vector<Shelf> shelves;
+    int shelves_height;
+
+    std::vector<Area> released;
+
+    vec4 white_bounds;
+
+    std::unordered_map<Texture2D*, Entry> entries;
+    std::unordered_set<Texture2D*> added;
+};
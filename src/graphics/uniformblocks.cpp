@@ -0,0 +1,44 @@
+#include "uniformblocks.h"
+
+#include <cstring>
+
+#include "types/ubo.h"
+
+static_assert(sizeof(FrameData) == 16, "FrameData does not match its std140 layout");
+static_assert(sizeof(ViewData) == 6 * 64 + 2 * 16, "ViewData does not match its std140 layout");
+
+UniformBlocks* UniformBlocks::singleton;
+
+UniformBlocks::UniformBlocks() {
+    frame_ubo = new UBO;
+    frame_ubo->set_data(&frame, sizeof(frame));
+    frame_ubo->bind_at_index(UBO::BINDING_FRAME);
+
+    view_ubo = new UBO;
+    view_ubo->set_data(&view, sizeof(view));
+    view_ubo->bind_at_index(UBO::BINDING_VIEW);
+}
+
+UniformBlocks* UniformBlocks::get_singleton() {
+    if (!singleton) singleton = new UniformBlocks;
+
+    return singleton;
+}
+
+void UniformBlocks::set_frame(const FrameData& p_frame) {
+    if (memcmp(&frame, &p_frame, sizeof(frame)) == 0) return;
+
+    frame = p_frame;
+    frame_ubo->update_data(&frame, sizeof(frame));
+}
+
+void UniformBlocks::set_view(const ViewData& p_view) {
+    if (memcmp(&view, &p_view, sizeof(view)) == 0) return;
+
+    view = p_view;
+    view_ubo->update_data(&view, sizeof(view));
+}
+
+const FrameData& UniformBlocks::get_frame() const { return frame; }
+
+const ViewData& UniformBlocks::get_view() const { return view; }
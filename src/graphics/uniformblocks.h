@@ -0,0 +1,57 @@
+#pragma once
+
+#include "math/mat4.h"
+
+#define UNIFORM_BLOCKS UniformBlocks::get_singleton()
+
+class UBO;
+
+// Mirrors of the std140 blocks in engine/shaders/Uniforms.glsl, with the members in the same order
+// and the padding std140 adds made explicit.
+struct FrameData {
+    vec2 window_size;
+
+    // In seconds.
+    float time = 0.0f;
+    float padding = 0.0f;
+};
+
+struct ViewData {
+    // Projection times view, named after the uniform the shaders used before.
+    mat4 view;
+    mat4 view_matrix;
+    mat4 projection_matrix;
+
+    mat4 light_matrix_far;
+    mat4 light_matrix_middle;
+    mat4 light_matrix_near;
+
+    // Declared as vec3 in the shaders, w is padding.
+    vec4 camera_position;
+    vec4 light_direction;
+};
+
+// Buffers of the blocks every shader can include, bound once at fixed binding points. A shader that
+// reads its camera and light data from them needs no uniform calls for it.
+class UniformBlocks {
+   public:
+    UniformBlocks();
+
+    static UniformBlocks* get_singleton();
+
+    // Set once per frame and once per pass, data equal to the current data is not uploaded.
+    void set_frame(const FrameData& p_frame);
+    void set_view(const ViewData& p_view);
+
+    const FrameData& get_frame() const;
+    const ViewData& get_view() const;
+
+   private:
+    UBO* frame_ubo;
+    UBO* view_ubo;
+
+    FrameData frame;
+    ViewData view;
+
+    static UniformBlocks* singleton;
+};
@@ -1,5 +1,6 @@
 #include "viewport.h"
 
+#include "canvasbatch.h"
 #include "core/windowmanager.h"
 #include "game/scene.h"
 #include "renderer.h"
@@ -162,6 +163,9 @@ void Viewport::set_scene(Scene* p_scene) {
 Scene* Viewport::get_scene() const { return scene; }
 
 void Viewport::activate() {
+    // Viewports nest while drawing, the quads collected so far belong to the previous target.
+    CANVAS_BATCH->flush();
+
     return_viewport = VIEW->get_active_viewport();
     VIEW->set_active_viewport(this);
     renderer->activate();
@@ -228,6 +232,20 @@ vec3 Viewport::deferred_raycast(const vec2& p_pos) const {
 }
 
 Object* Viewport::raycast(const vec2& pos) const {
+    Camera* camera = world ? world->get_active_camera() : nullptr;
+
+    // Objects with bounds are picked by a ray through the pixel, the nearest one is returned.
+    if (camera) {
+        vec2 ndc = (pos - renderarea.pos) / renderarea.size;
+        mat4 inverse = camera->get_inverse();
+
+        vec4 near = inverse * vec4(ndc, -1.0f, 1.0f);
+        vec4 far = inverse * vec4(ndc, 1.0f, 1.0f);
+
+        WorldObject* object = world->cast_ray(near.get_xyz() / near.w, far.get_xyz() / far.w);
+        if (object) return object;
+    }
+
     vec2 projected = get_screen_coords(pos);
 
     if (world) {
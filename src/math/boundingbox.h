@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cmath>
+
+#include "mat4.h"
+#include "vec3.h"
+
+// Axis-aligned box.
+struct BoundingBox {
+    vec3 min;
+    vec3 max;
+
+    vec3 get_center() const { return (min + max) / 2.0f; }
+
+    // Half the size along each axis.
+    vec3 get_extents() const { return (max - min) / 2.0f; }
+
+    // Area of the six sides, the cost of a box in the spatial index.
+    float get_surface_area() const {
+        vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    // The smallest box around both boxes.
+    BoundingBox merged(const BoundingBox& p_box) const {
+        return {vec3(std::fmin(min.x, p_box.min.x), std::fmin(min.y, p_box.min.y),
+                     std::fmin(min.z, p_box.min.z)),
+                vec3(std::fmax(max.x, p_box.max.x), std::fmax(max.y, p_box.max.y),
+                     std::fmax(max.z, p_box.max.z))};
+    }
+
+    BoundingBox grown(float p_margin) const { return {min - vec3(p_margin), max + vec3(p_margin)}; }
+
+    bool contains(const BoundingBox& p_box) const {
+        return min.x <= p_box.min.x && min.y <= p_box.min.y && min.z <= p_box.min.z &&
+               max.x >= p_box.max.x && max.y >= p_box.max.y && max.z >= p_box.max.z;
+    }
+
+    bool intersects(const BoundingBox& p_box) const {
+        return min.x <= p_box.max.x && min.y <= p_box.max.y && min.z <= p_box.max.z &&
+               max.x >= p_box.min.x && max.y >= p_box.min.y && max.z >= p_box.min.z;
+    }
+
+    bool intersects(const vec3& p_center, float p_radius) const {
+        float dx = std::fmax(std::fmax(min.x - p_center.x, p_center.x - max.x), 0.0f);
+        float dy = std::fmax(std::fmax(min.y - p_center.y, p_center.y - max.y), 0.0f);
+        float dz = std::fmax(std::fmax(min.z - p_center.z, p_center.z - max.z), 0.0f);
+
+        return dx * dx + dy * dy + dz * dz <= p_radius * p_radius;
+    }
+
+    // Slab test, r_distance is where the ray enters the box or zero when it starts inside.
+    // Takes the inverse of the direction, so rays tested against many boxes divide only once.
+    bool intersects_ray(const vec3& p_origin, const vec3& p_inverse_direction,
+                        float p_max_distance, float& r_distance) const {
+        float near = 0.0f;
+        float far = p_max_distance;
+
+        const float origin[3] = {p_origin.x, p_origin.y, p_origin.z};
+        const float inverse[3] = {p_inverse_direction.x, p_inverse_direction.y,
+                                  p_inverse_direction.z};
+        const float low[3] = {min.x, min.y, min.z};
+        const float high[3] = {max.x, max.y, max.z};
+
+        for (int c = 0; c < 3; c++) {
+            float t0 = (low[c] - origin[c]) * inverse[c];
+            float t1 = (high[c] - origin[c]) * inverse[c];
+
+            // Rays parallel to a slab give infinities, which miss unless the origin is inside.
+            near = std::fmax(near, std::fmin(t0, t1));
+            far = std::fmin(far, std::fmax(t0, t1));
+        }
+
+        r_distance = near;
+        return near <= far;
+    }
+
+    bool operator==(const BoundingBox& r) const { return min == r.min && max == r.max; }
+    bool operator!=(const BoundingBox& r) const { return !(*this == r); }
+
+    // The box around this box after a transformation, which may be larger than the transformed
+    // contents.
+    BoundingBox transformed(const mat4& p_transform) const {
+        const float* m = p_transform.m;
+
+        vec3 center = get_center();
+        vec3 extents = get_extents();
+
+        vec3 new_center = (p_transform * vec4(center, 1.0f)).get_xyz();
+        vec3 new_extents;
+
+        new_extents.x = std::fabs(m[0]) * extents.x + std::fabs(m[4]) * extents.y +
+                        std::fabs(m[8]) * extents.z;
+        new_extents.y = std::fabs(m[1]) * extents.x + std::fabs(m[5]) * extents.y +
+                        std::fabs(m[9]) * extents.z;
+        new_extents.z = std::fabs(m[2]) * extents.x + std::fabs(m[6]) * extents.y +
+                        std::fabs(m[10]) * extents.z;
+
+        return {new_center - new_extents, new_center + new_extents};
+    }
+};
@@ -0,0 +1,240 @@
+#include "bvh.h"
+
+#include <algorithm>
+
+BVH::BVH() { clear(); }
+
+int BVH::create_proxy(const BoundingBox& p_box, void* p_data) {
+    int proxy = allocate_node();
+
+    Node& node = nodes[proxy];
+    node.box = p_box.grown(MARGIN);
+    node.data = p_data;
+    node.height = 0;
+
+    insert_leaf(proxy);
+    proxy_count++;
+
+    return proxy;
+}
+
+void BVH::destroy_proxy(int p_proxy) {
+    remove_leaf(p_proxy);
+    free_node(p_proxy);
+    proxy_count--;
+}
+
+bool BVH::move_proxy(int p_proxy, const BoundingBox& p_box) {
+    if (nodes[p_proxy].box.contains(p_box)) return false;
+
+    remove_leaf(p_proxy);
+    nodes[p_proxy].box = p_box.grown(MARGIN);
+    insert_leaf(p_proxy);
+
+    return true;
+}
+
+void* BVH::get_data(int p_proxy) const { return nodes[p_proxy].data; }
+
+const BoundingBox& BVH::get_box(int p_proxy) const { return nodes[p_proxy].box; }
+
+int BVH::get_proxy_count() const { return proxy_count; }
+
+int BVH::get_height() const { return root == -1 ? 0 : nodes[root].height; }
+
+void BVH::clear() {
+    nodes.clear();
+    root = -1;
+    free_list = -1;
+    proxy_count = 0;
+}
+
+int BVH::allocate_node() {
+    if (free_list == -1) {
+        nodes.push_back(Node());
+        return int(nodes.size()) - 1;
+    }
+
+    int node = free_list;
+    free_list = nodes[node].parent;
+    nodes[node] = Node();
+
+    return node;
+}
+
+void BVH::free_node(int p_node) {
+    nodes[p_node].parent = free_list;
+    nodes[p_node].height = -1;
+    free_list = p_node;
+}
+
+void BVH::insert_leaf(int p_leaf) {
+    if (root == -1) {
+        root = p_leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // Descends towards the sibling for which the tree grows the least.
+    BoundingBox leaf_box = nodes[p_leaf].box;
+    int index = root;
+
+    while (!nodes[index].is_leaf()) {
+        const Node& node = nodes[index];
+
+        float area = node.box.get_surface_area();
+        float combined_area = node.box.merged(leaf_box).get_surface_area();
+
+        // Pairing with this node makes a new parent, below it every ancestor grows.
+        float cost = 2.0f * combined_area;
+        float inheritance_cost = 2.0f * (combined_area - area);
+
+        float child_costs[2];
+        int children[2] = {node.child1, node.child2};
+
+        for (int c = 0; c < 2; c++) {
+            const Node& child = nodes[children[c]];
+            float merged_area = child.box.merged(leaf_box).get_surface_area();
+
+            if (child.is_leaf())
+                child_costs[c] = merged_area + inheritance_cost;
+            else
+                child_costs[c] =
+                    merged_area - child.box.get_surface_area() + inheritance_cost;
+        }
+
+        if (cost < child_costs[0] && cost < child_costs[1]) break;
+
+        index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+    }
+
+    int sibling = index;
+    int old_parent = nodes[sibling].parent;
+    int new_parent = allocate_node();
+
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].box = leaf_box.merged(nodes[sibling].box);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].child1 = sibling;
+    nodes[new_parent].child2 = p_leaf;
+
+    nodes[sibling].parent = new_parent;
+    nodes[p_leaf].parent = new_parent;
+
+    if (old_parent == -1) {
+        root = new_parent;
+    } else if (nodes[old_parent].child1 == sibling) {
+        nodes[old_parent].child1 = new_parent;
+    } else {
+        nodes[old_parent].child2 = new_parent;
+    }
+
+    // Refits the ancestors.
+    index = nodes[p_leaf].parent;
+
+    while (index != -1) {
+        index = balance(index);
+
+        Node& node = nodes[index];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        node.box = nodes[node.child1].box.merged(nodes[node.child2].box);
+
+        index = node.parent;
+    }
+}
+
+void BVH::remove_leaf(int p_leaf) {
+    if (p_leaf == root) {
+        root = -1;
+        return;
+    }
+
+    int parent = nodes[p_leaf].parent;
+    int grand_parent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == p_leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    // The sibling takes the place of the parent.
+    free_node(parent);
+
+    if (grand_parent == -1) {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        return;
+    }
+
+    if (nodes[grand_parent].child1 == parent)
+        nodes[grand_parent].child1 = sibling;
+    else
+        nodes[grand_parent].child2 = sibling;
+
+    nodes[sibling].parent = grand_parent;
+
+    int index = grand_parent;
+
+    while (index != -1) {
+        index = balance(index);
+
+        Node& node = nodes[index];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        node.box = nodes[node.child1].box.merged(nodes[node.child2].box);
+
+        index = node.parent;
+    }
+}
+
+int BVH::balance(int p_node) {
+    int a = p_node;
+    Node& node_a = nodes[a];
+
+    if (node_a.is_leaf() || node_a.height < 2) return a;
+
+    int b = node_a.child1;
+    int c = node_a.child2;
+    int difference = nodes[c].height - nodes[b].height;
+
+    if (difference > 1 || difference < -1) {
+        // The higher child is rotated up and its lower child moves to a.
+        bool c_higher = difference > 1;
+        int higher = c_higher ? c : b;
+        int lower = c_higher ? b : c;
+
+        Node& node_up = nodes[higher];
+        int f = node_up.child1;
+        int g = node_up.child2;
+
+        node_up.child1 = a;
+        node_up.parent = node_a.parent;
+        node_a.parent = higher;
+
+        if (node_up.parent == -1) {
+            root = higher;
+        } else if (nodes[node_up.parent].child1 == a) {
+            nodes[node_up.parent].child1 = higher;
+        } else {
+            nodes[node_up.parent].child2 = higher;
+        }
+
+        // The higher grandchild stays with the rotated node.
+        int kept = nodes[f].height > nodes[g].height ? f : g;
+        int moved = kept == f ? g : f;
+
+        node_up.child2 = kept;
+
+        if (c_higher)
+            node_a.child2 = moved;
+        else
+            node_a.child1 = moved;
+
+        nodes[moved].parent = a;
+
+        node_a.box = nodes[lower].box.merged(nodes[moved].box);
+        node_up.box = node_a.box.merged(nodes[kept].box);
+
+        node_a.height = 1 + std::max(nodes[lower].height, nodes[moved].height);
+        node_up.height = 1 + std::max(node_a.height, nodes[kept].height);
+
+        return higher;
+    }
+
+    return a;
+}
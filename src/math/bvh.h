@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+
+#include "boundingbox.h"
+#include "frustum.h"
+
+// Dynamic bounding volume hierarchy, a binary tree of boxes that is updated incrementally.
+//
+// Every proxy is stored with a box grown by MARGIN, so small moves do not touch the tree. Leaves
+// are inserted next to the sibling that grows the surface area least and the tree is rebalanced
+// with rotations on the way up, which keeps its height logarithmic in the number of proxies.
+// Queries call back with the proxy ids whose grown boxes overlap, the callback returns false to
+// stop early.
+class BVH {
+   public:
+    BVH();
+
+    int create_proxy(const BoundingBox& p_box, void* p_data);
+    void destroy_proxy(int p_proxy);
+
+    // Returns true when the proxy left its grown box and was reinserted.
+    bool move_proxy(int p_proxy, const BoundingBox& p_box);
+
+    void* get_data(int p_proxy) const;
+    const BoundingBox& get_box(int p_proxy) const;
+
+    int get_proxy_count() const;
+    int get_height() const;
+
+    void clear();
+
+    template <typename F>
+    void query(const BoundingBox& p_box, F p_callback) const;
+
+    template <typename F>
+    void query(const Frustum& p_frustum, F p_callback) const;
+
+    template <typename F>
+    void query_sphere(const vec3& p_center, float p_radius, F p_callback) const;
+
+    // Calls back with the proxy and the distance at which the ray enters its box, the callback
+    // returns the new maximum distance: the same to find all hits, the distance to find the
+    // nearest one and zero to stop.
+    template <typename F>
+    void raycast(const vec3& p_origin, const vec3& p_direction, float p_max_distance,
+                 F p_callback) const;
+
+    static constexpr float MARGIN = 0.1f;
+
+   private:
+    struct Node {
+        BoundingBox box;
+        void* data = nullptr;
+
+        // The next free node for nodes that are not in use.
+        int parent = -1;
+        int child1 = -1;
+        int child2 = -1;
+
+        // Leaves are 0, free nodes -1.
+        int height = -1;
+
+        bool is_leaf() const { return child1 == -1; }
+    };
+
+    // Descends the tree while p_overlaps holds for a node box and calls back for the leaves.
+    template <typename O, typename F>
+    void traverse(O p_overlaps, F p_callback) const;
+
+    int allocate_node();
+    void free_node(int p_node);
+
+    void insert_leaf(int p_leaf);
+    void remove_leaf(int p_leaf);
+
+    // Rotates the grandchildren of an unbalanced node up, returns the node now in its place.
+    int balance(int p_node);
+
+    // Deep enough for any tree that stays balanced.
+    static const int STACK_SIZE = 256;
+
+    std::vector<Node> nodes;
+    int root;
+    int free_list;
+    int proxy_count;
+};
+
+template <typename O, typename F>
+void BVH::traverse(O p_overlaps, F p_callback) const {
+    if (root == -1) return;
+
+    int stack[STACK_SIZE];
+    int count = 0;
+    stack[count++] = root;
+
+    while (count > 0) {
+        const Node& node = nodes[stack[--count]];
+        if (!p_overlaps(node.box)) continue;
+
+        if (node.is_leaf()) {
+            if (!p_callback(int(&node - nodes.data()))) return;
+        } else if (count + 2 <= STACK_SIZE) {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
+
+template <typename F>
+void BVH::query(const BoundingBox& p_box, F p_callback) const {
+    traverse([&p_box](const BoundingBox& p_node) { return p_node.intersects(p_box); },
+             p_callback);
+}
+
+template <typename F>
+void BVH::query(const Frustum& p_frustum, F p_callback) const {
+    traverse([&p_frustum](const BoundingBox& p_node) { return p_frustum.intersects(p_node); },
+             p_callback);
+}
+
+template <typename F>
+void BVH::query_sphere(const vec3& p_center, float p_radius, F p_callback) const {
+    traverse(
+        [&p_center, p_radius](const BoundingBox& p_node) {
+            return p_node.intersects(p_center, p_radius);
+        },
+        p_callback);
+}
+
+template <typename F>
+void BVH::raycast(const vec3& p_origin, const vec3& p_direction, float p_max_distance,
+                  F p_callback) const {
+    vec3 inverse = vec3(1.0f / p_direction.x, 1.0f / p_direction.y, 1.0f / p_direction.z);
+    float max_distance = p_max_distance;
+
+    traverse(
+        [&](const BoundingBox& p_node) {
+            float distance;
+            return p_node.intersects_ray(p_origin, inverse, max_distance, distance);
+        },
+        [&](int p_proxy) {
+            float distance;
+            nodes[p_proxy].box.intersects_ray(p_origin, inverse, max_distance, distance);
+
+            max_distance = p_callback(p_proxy, distance);
+            return max_distance > 0.0f;
+        });
+}
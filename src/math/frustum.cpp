@@ -0,0 +1,58 @@
+#include "frustum.h"
+
+#include <cmath>
+
+Frustum::Frustum() {
+    // Without planes nothing is outside.
+    for (int c = 0; c < 6; c++) planes[c] = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Frustum::Frustum(const mat4& p_view_projection) {
+    const float* m = p_view_projection.m;
+
+    vec4 rows[4];
+    for (int r = 0; r < 4; r++) rows[r] = vec4(m[r], m[4 + r], m[8 + r], m[12 + r]);
+
+    // Left, right, bottom, top, near and far.
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[3] + rows[2];
+    planes[5] = rows[3] - rows[2];
+
+    for (int c = 0; c < 6; c++) {
+        float length = planes[c].get_xyz().length();
+        if (length > 0.0f) planes[c] = planes[c] / length;
+    }
+}
+
+bool Frustum::intersects(const BoundingBox& p_box) const {
+    vec3 center = p_box.get_center();
+    vec3 extents = p_box.get_extents();
+
+    for (int c = 0; c < 6; c++) {
+        const vec4& p = planes[c];
+
+        float distance = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+        float radius =
+            std::fabs(p.x) * extents.x + std::fabs(p.y) * extents.y + std::fabs(p.z) * extents.z;
+
+        if (distance + radius < 0.0f) return false;
+    }
+
+    return true;
+}
+
+bool Frustum::intersects(const vec3& p_center, float p_radius) const {
+    for (int c = 0; c < 6; c++) {
+        const vec4& p = planes[c];
+
+        if (p.x * p_center.x + p.y * p_center.y + p.z * p_center.z + p.w < -p_radius)
+            return false;
+    }
+
+    return true;
+}
+
+bool Frustum::contains(const vec3& p_point) const { return intersects(p_point, 0.0f); }
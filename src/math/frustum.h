@@ -0,0 +1,29 @@
+#pragma once
+
+#include "boundingbox.h"
+#include "mat4.h"
+#include "vec4.h"
+
+// Objects drawn and skipped by one culled pass.
+struct CullStats {
+    int drawn = 0;
+    int culled = 0;
+};
+
+// The view volume of a camera, as six planes pointing inwards.
+class Frustum {
+   public:
+    Frustum();
+
+    // Extracts the planes of a projection * view matrix with OpenGL's clip space.
+    Frustum(const mat4& p_view_projection);
+
+    // Conservative: boxes near a corner outside of the volume may still pass.
+    bool intersects(const BoundingBox& p_box) const;
+    bool intersects(const vec3& p_center, float p_radius) const;
+
+    bool contains(const vec3& p_point) const;
+
+   private:
+    vec4 planes[6];
+};
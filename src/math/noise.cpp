@@ -2,6 +2,7 @@
 
 #include <thread>
 
+#include "graphics/glstate.h"
 #include "resources/texture.h"
 
 #ifndef BYTE
@@ -57,7 +58,7 @@ Texture2D* PerlinNoise::create_2d_texture(const vec2i& p_size) {
     }
 
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -109,7 +110,7 @@ Texture3D* PerlinNoise::create_3d_texture() {
     }
 
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_3D, id);
+    GLSTATE->bind_texture(GL_TEXTURE_3D, id);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
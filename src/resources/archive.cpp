@@ -0,0 +1,287 @@
+#include "archive.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "core/contentmanager.h"
+
+namespace {
+const char MAGIC[4] = {'T', 'P', 'A', 'K'};
+
+const size_t ALIGNMENT = 16;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+    uint64_t index_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+};
+
+size_t align(size_t p_value) { return (p_value + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+// Cooked results are packed, shader binaries only fit the driver that made them and thumbnails
+// are only used by the editor.
+bool is_skipped(const String& p_path, const String& p_name) {
+    if (p_path == ".cache") return false;
+    if (p_path == ".cache/programs" || p_path == ".cache/thumbnails") return true;
+
+    // Hidden files and cache entries that are still being written.
+    return p_name.starts_with(".") || p_name.ends_with(".tmp");
+}
+
+void collect(const File& p_directory, const String& p_prefix, Array<String>& r_paths) {
+    for (const File& file : p_directory.listdir_loose()) {
+        String name = file.get_name();
+        String path = p_prefix.size() > 0 ? p_prefix + "/" + name : name;
+
+        if (is_skipped(path, name)) continue;
+
+        if (file.is_loose_directory())
+            collect(file, path, r_paths);
+        else
+            r_paths.push_back(path);
+    }
+}
+
+void pad(std::ofstream& p_stream, size_t& r_offset) {
+    static const char zeros[ALIGNMENT] = {};
+    size_t aligned = align(r_offset);
+
+    p_stream.write(zeros, aligned - r_offset);
+    r_offset = aligned;
+}
+}  // namespace
+
+Archive::Archive() {
+    entries = nullptr;
+    entry_count = 0;
+    strings = nullptr;
+    strings_size = 0;
+}
+
+bool Archive::open(const File& p_file) {
+    close();
+
+    if (!mapped.open(p_file)) return false;
+
+    const char* data = mapped.get_data();
+    size_t size = mapped.get_size();
+
+    Header header;
+    if (size < sizeof(Header)) return false;
+    memcpy(&header, data, sizeof(Header));
+
+    bool valid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                 header.index_offset % ALIGNMENT == 0 && header.index_offset <= size &&
+                 header.entry_count <= (size - header.index_offset) / sizeof(Entry) &&
+                 header.strings_offset <= size &&
+                 header.strings_size <= size - header.strings_offset;
+
+    if (valid) {
+        entries = reinterpret_cast<const Entry*>(data + header.index_offset);
+        entry_count = header.entry_count;
+        strings = data + header.strings_offset;
+        strings_size = header.strings_size;
+
+        for (uint32_t c = 0; c < entry_count && valid; c++) {
+            const Entry& entry = entries[c];
+
+            valid = entry.offset <= size && entry.stored_size <= size - entry.offset &&
+                    entry.path_offset <= strings_size &&
+                    entry.path_length <= strings_size - entry.path_offset &&
+                    (entry.flags & COMPRESSED || entry.stored_size == entry.size);
+        }
+    }
+
+    if (!valid) {
+        T_ERROR("Invalid archive: " + p_file.get_absolute_path());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void Archive::close() {
+    mapped.close();
+
+    entries = nullptr;
+    entry_count = 0;
+    strings = nullptr;
+    strings_size = 0;
+}
+
+bool Archive::is_open() const { return entries != nullptr; }
+
+const Archive::Entry* Archive::find(const String& p_path) const {
+    std::string_view path(p_path.c_str(), p_path.size());
+    const Entry* entry = lower_bound(path);
+
+    if (entry == entries + entry_count || get_path(*entry) != path) return nullptr;
+
+    return entry;
+}
+
+bool Archive::is_directory(const String& p_path) const {
+    if (!is_open()) return false;
+    if (p_path.size() == 0) return entry_count > 0;
+
+    std::string prefix = std::string(p_path.c_str(), p_path.size()) + "/";
+    const Entry* entry = lower_bound(prefix);
+
+    return entry != entries + entry_count && get_path(*entry).substr(0, prefix.size()) == prefix;
+}
+
+Array<String> Archive::list(const String& p_directory) const {
+    Array<String> result;
+
+    std::string prefix = p_directory.size() > 0 ? std::string(p_directory.c_str()) + "/" : "";
+    std::string_view last;
+
+    for (const Entry* entry = lower_bound(prefix); entry != entries + entry_count; entry++) {
+        std::string_view path = get_path(*entry);
+        if (path.substr(0, prefix.size()) != prefix) break;
+
+        // Files in subdirectories are contiguous, the directory is listed once.
+        std::string_view name = path.substr(prefix.size());
+        name = name.substr(0, name.find('/'));
+
+        if (name == last) continue;
+
+        result.push_back(String(std::string(name)));
+        last = name;
+    }
+
+    return result;
+}
+
+bool Archive::read(const Entry* p_entry, const char*& r_data, size_t& r_size,
+                   std::vector<char>& r_buffer) const {
+    const char* stored = mapped.get_data() + p_entry->offset;
+
+    if (!(p_entry->flags & COMPRESSED)) {
+        r_data = stored;
+        r_size = p_entry->size;
+        return true;
+    }
+
+    r_buffer.resize(p_entry->size);
+    uLongf size = p_entry->size;
+
+    if (uncompress(reinterpret_cast<Bytef*>(r_buffer.data()), &size,
+                   reinterpret_cast<const Bytef*>(stored), p_entry->stored_size) != Z_OK ||
+        size != p_entry->size) {
+        T_ERROR("Corrupt archive entry: " + String(std::string(get_path(*p_entry))));
+        return false;
+    }
+
+    r_data = r_buffer.data();
+    r_size = r_buffer.size();
+    return true;
+}
+
+int Archive::get_entry_count() const { return entry_count; }
+
+bool Archive::build(const File& p_directory, const File& p_target) {
+    Array<String> paths;
+    collect(p_directory, "", paths);
+
+    std::sort(paths.begin(), paths.end(), [](const String& a, const String& b) {
+        return std::string_view(a.c_str(), a.size()) < std::string_view(b.c_str(), b.size());
+    });
+
+    std::ofstream stream(p_target.get_absolute_path().c_str(), std::ios::binary);
+    if (!stream.is_open()) {
+        T_ERROR("Could not write file: " + p_target.get_absolute_path());
+        return false;
+    }
+
+    // The header is written last, once the offsets are known.
+    Header header = {};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    size_t offset = sizeof(Header);
+
+    std::vector<Entry> index;
+    std::string names;
+
+    for (const String& path : paths) {
+        File file = p_directory.get_absolute_path() + "/" + path;
+        std::ifstream input(file.get_absolute_path().c_str(), std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(input)),
+                               std::istreambuf_iterator<char>());
+
+        if (!input.good() && !input.eof()) {
+            T_ERROR("Could not read file: " + file.get_absolute_path());
+            return false;
+        }
+
+        Entry entry = {};
+        entry.size = data.size();
+        entry.path_offset = names.size();
+        entry.path_length = path.size();
+        names.append(path.c_str(), path.size());
+
+        // Only keep the deflated data when it saves at least an eighth.
+        uLongf compressed_size = compressBound(data.size());
+        std::vector<char> compressed(compressed_size);
+
+        bool compress = data.size() > 0 &&
+                        compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                                  reinterpret_cast<const Bytef*>(data.data()), data.size(),
+                                  Z_BEST_COMPRESSION) == Z_OK &&
+                        compressed_size < data.size() - data.size() / 8;
+
+        const std::vector<char>& stored = compress ? compressed : data;
+        entry.stored_size = compress ? compressed_size : data.size();
+        entry.flags = compress ? COMPRESSED : 0;
+
+        pad(stream, offset);
+        entry.offset = offset;
+
+        stream.write(stored.data(), entry.stored_size);
+        offset += entry.stored_size;
+
+        index.push_back(entry);
+    }
+
+    pad(stream, offset);
+    header.index_offset = offset;
+    stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Entry));
+    offset += index.size() * sizeof(Entry);
+
+    header.strings_offset = offset;
+    header.strings_size = names.size();
+    stream.write(names.data(), names.size());
+
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entry_count = index.size();
+
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+    if (!stream.good()) {
+        T_ERROR("Could not write file: " + p_target.get_absolute_path());
+        return false;
+    }
+
+    return true;
+}
+
+std::string_view Archive::get_path(const Entry& p_entry) const {
+    return std::string_view(strings + p_entry.path_offset, p_entry.path_length);
+}
+
+const Archive::Entry* Archive::lower_bound(std::string_view p_path) const {
+    return std::lower_bound(entries, entries + entry_count, p_path,
+                            [this](const Entry& p_entry, std::string_view p_value) {
+                                return get_path(p_entry) < p_value;
+                            });
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "resources/mappedfile.h"
+
+#define ARCHIVE_EXTENSION "tpak"
+
+// Read-only pack of asset files, served from a single memory mapping.
+//
+// The index is sorted by path so lookups are a binary search and the entries of a directory are
+// contiguous. Entry data is aligned to 16 bytes and is deflated only when that saves space,
+// uncompressed entries are handed out without copying.
+class Archive {
+   public:
+    struct Entry {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t stored_size;
+
+        uint32_t path_offset;
+        uint32_t path_length;
+
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    enum EntryFlags { COMPRESSED = 1 };
+
+    Archive();
+
+    bool open(const File& p_file);
+    void close();
+
+    bool is_open() const;
+
+    // Paths are relative to the assets directory and use forward slashes.
+    const Entry* find(const String& p_path) const;
+    bool is_directory(const String& p_path) const;
+
+    // Names of the files and directories directly inside a directory.
+    Array<String> list(const String& p_directory) const;
+
+    // Uncompressed entries point into the mapping, compressed ones are inflated into r_buffer.
+    bool read(const Entry* p_entry, const char*& r_data, size_t& r_size,
+              std::vector<char>& r_buffer) const;
+
+    int get_entry_count() const;
+
+    // Packs every file in a directory, except hidden files. The cooked meshes and textures of the
+    // asset cache are packed as well.
+    static bool build(const File& p_directory, const File& p_target);
+
+    static const uint32_t VERSION = 1;
+
+   private:
+    std::string_view get_path(const Entry& p_entry) const;
+    const Entry* lower_bound(std::string_view p_path) const;
+
+    MappedFile mapped;
+
+    const Entry* entries;
+    uint32_t entry_count;
+
+    const char* strings;
+    size_t strings_size;
+};
@@ -0,0 +1,81 @@
+#include "assetcache.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "core/contentmanager.h"
+#include "resources/mappedfile.h"
+
+File AssetCache::get_directory(const String& p_kind) {
+    File directory = ASSETS_DIR.get_absolute_path() + "/.cache/" + p_kind;
+
+    if (!directory.is_directory()) directory.create_directory();
+
+    return directory;
+}
+
+File AssetCache::get_file(const String& p_kind, uint64_t p_key, const String& p_extension) {
+    return get_directory(p_kind).get_absolute_path() + "/" + to_hex(p_key) + "." + p_extension;
+}
+
+uint64_t AssetCache::hash(const void* p_data, size_t p_size, uint64_t p_seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(p_data);
+    uint64_t result = p_seed;
+
+    for (size_t c = 0; c < p_size; c++) {
+        result ^= bytes[c];
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+uint64_t AssetCache::hash_file(const File& p_file, uint64_t p_seed) {
+    if (!p_file.is_file()) return 0;
+
+    MappedFile mapped(p_file);
+    if (!mapped.is_open()) return 0;
+
+    return hash(mapped.get_data(), mapped.get_size(), p_seed);
+}
+
+String AssetCache::to_hex(uint64_t p_value) {
+    const char* digits = "0123456789abcdef";
+    char result[17];
+
+    for (int c = 15; c >= 0; c--) {
+        result[c] = digits[p_value & 0xf];
+        p_value >>= 4;
+    }
+
+    result[16] = '\0';
+    return String(result);
+}
+
+bool AssetCache::write(const File& p_file, const char* p_data, size_t p_size) {
+    String path = p_file.get_absolute_path();
+    String temporary = path + ".tmp";
+
+    {
+        std::ofstream stream(temporary.c_str(), std::ios::binary);
+        if (!stream.is_open()) {
+            T_ERROR("Could not write file: " + temporary);
+            return false;
+        }
+
+        stream.write(p_data, p_size);
+        if (!stream.good()) {
+            T_ERROR("Could not write file: " + temporary);
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        T_ERROR("Could not write file: " + path);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/string.h"
+#include "resources/file.h"
+
+// Location and keys of files derived from assets, such as imported meshes.
+//
+// Entries are stored under <assets>/.cache/<kind>/ and named after a hash of the source contents
+// and everything else that affects the result, so stale entries are never picked up. They can
+// be deleted at any time.
+class AssetCache {
+   public:
+    static File get_directory(const String& p_kind);
+    static File get_file(const String& p_kind, uint64_t p_key, const String& p_extension);
+
+    // 64-bit FNV-1a, chain calls by passing the previous result as seed.
+    static constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+    static uint64_t hash(const void* p_data, size_t p_size, uint64_t p_seed = HASH_SEED);
+    static uint64_t hash_file(const File& p_file, uint64_t p_seed = HASH_SEED);
+
+    static String to_hex(uint64_t p_value);
+
+    // Writes to a temporary file first, so readers never see a partially written entry.
+    static bool write(const File& p_file, const char* p_data, size_t p_size);
+};
@@ -1,5 +1,7 @@
 #include "audio.h"
 
+#include "resources/virtualfilesystem.h"
+
 // Audio
 void Audio::init() {
     if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) == -1)
@@ -10,12 +12,38 @@ void Audio::Free() { Mix_CloseAudio(); }
 // SoundEffect
 SoundEffect::~SoundEffect() { Mix_FreeChunk(effect); }
 
-void SoundEffect::Load(const String& filename) { effect = Mix_LoadWAV(filename.c_str()); }
+void SoundEffect::Load(const String& filename) {
+    set_file(filename);
+    effect = Mix_LoadWAV_RW(VFS->open_rw(filename), 1);
+}
 
 void SoundEffect::Play() {
+    if (!effect) return;
+
     if (Mix_PlayChannel(-1, effect, 0) == -1) T_ERROR("Error playing sound!");
 }
 
+void SoundEffect::reload() {
+    Mix_Chunk* reloaded = Mix_LoadWAV_RW(VFS->open_rw(file), 1);
+
+    if (!reloaded) {
+        T_ERROR("Failed to reload sound: " + file.get_relative_path());
+        return;
+    }
+
+    set_effect(reloaded);
+}
+
+void SoundEffect::set_effect(Mix_Chunk* p_effect) {
+    if (effect) Mix_FreeChunk(effect);
+
+    effect = p_effect;
+}
+
+bool SoundEffect::is_ready() const { return effect; }
+
+size_t SoundEffect::get_cpu_size() const { return effect ? effect->alen : 0; }
+
 #undef CLASSNAME
 #define CLASSNAME SoundEffect
 
@@ -32,7 +60,10 @@ void SoundEffect::bind_methods() {
 
 Music::~Music() { Mix_FreeMusic(music); }
 
-void Music::Load(const String& filename) { music = Mix_LoadMUS(filename.c_str()); }
+void Music::Load(const String& filename) {
+    set_file(filename);
+    music = Mix_LoadMUS_RW(VFS->open_rw(filename), 1);
+}
 
 void Music::Play() {
     if (!Mix_PlayMusic(music, -1)) T_ERROR("Error playing music!");
@@ -40,6 +71,19 @@ void Music::Play() {
 
 void Music::Pause() { Mix_PauseMusic(); }
 
+void Music::reload() {
+    Mix_Music* reloaded = Mix_LoadMUS_RW(VFS->open_rw(file), 1);
+
+    if (!reloaded) {
+        T_ERROR("Failed to reload music: " + file.get_relative_path());
+        return;
+    }
+
+    // Freeing the music that is playing stops it.
+    Mix_FreeMusic(music);
+    music = reloaded;
+}
+
 #undef CLASSNAME
 #define CLASSNAME Music
 
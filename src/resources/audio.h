@@ -22,12 +22,20 @@ class SoundEffect : public Resource {
     OBJ_DEFINITION(SoundEffect, Resource)
 
    public:
+    SoundEffect() { effect = nullptr; }
     SoundEffect(const String& filename) { Load(filename); }
     ~SoundEffect();
 
     void Load(const String& filename);
     void Play();
 
+    void reload() override;
+
+    // Takes ownership of a chunk that was decoded on a worker thread.
+    void set_effect(Mix_Chunk* p_effect);
+    bool is_ready() const override;
+    size_t get_cpu_size() const override;
+
     static void bind_methods();
 
    private:
@@ -45,6 +53,8 @@ class Music : public Resource {
     void Play();
     void Pause();
 
+    void reload() override;
+
     static void bind_methods();
 
    private:
@@ -8,8 +8,13 @@
 #include <sys/types.h>
 #include <unistd.h>
 #endif
+
+#include <filesystem>
+#include <system_error>
+
 #include "core/contentmanager.h"
 #include "core/definitions.h"
+#include "resources/virtualfilesystem.h"
 
 File::File() { path = ""; }
 
@@ -88,7 +93,13 @@ File::operator String() const { return path; }
 
 bool File::is_absolute_path() const { return path.starts_with(ASSETS_DIR); }
 
-Array<File> File::listdir() const {
+bool File::is_directory() const { return VFS->is_directory(*this); }
+
+bool File::is_file() const { return VFS->is_file(*this); }
+
+Array<File> File::listdir() const { return VFS->listdir(*this); }
+
+Array<File> File::listdir_loose() const {
     Array<File> result = Array<File>();
 
     DIR* d = opendir(path.c_str());
@@ -107,10 +118,24 @@ Array<File> File::listdir() const {
     return result;
 }
 
+bool File::create_directory() const {
+    std::error_code error;
+    std::filesystem::create_directories(path.c_str(), error);
+
+    if (error) {
+        T_ERROR("Could not create directory: " + path + ": " + String(error.message()));
+        return false;
+    }
+
+    return true;
+}
+
 #if PLATFORM == WINDOWS
-bool File::is_directory() const { return (get_attributes() & FILE_ATTRIBUTE_DIRECTORY) != 0; }
+bool File::is_loose_directory() const {
+    return (get_attributes() & FILE_ATTRIBUTE_DIRECTORY) != 0;
+}
 
-bool File::is_file() const {
+bool File::is_loose_file() const {
     DWORD attributes = GetFileAttributes(path.c_str());
 
     return (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY));
@@ -144,14 +169,14 @@ void File::correct_path() {
     hidden = GetFileAttributes(path.c_str()) == FILE_ATTRIBUTE_HIDDEN;
 }
 #elif PLATFORM == LINUX
-bool File::is_directory() const {
+bool File::is_loose_directory() const {
     struct stat path_stat;
     if (stat(path.c_str(), &path_stat) != 0) return false;
 
     return S_ISDIR(path_stat.st_mode);
 }
 
-bool File::is_file() const {
+bool File::is_loose_file() const {
     struct stat path_stat;
     if (stat(path.c_str(), &path_stat) != 0) return false;
 
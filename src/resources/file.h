@@ -26,12 +26,21 @@ class File : public Object {
 
     String get_name() const;
 
+    // Include the files in mounted archives.
     bool is_directory() const;
     bool is_file() const;
 
+    // Only look at the disk.
+    bool is_loose_directory() const;
+    bool is_loose_file() const;
+
     String get_extension() const;
 
     Array<File> listdir() const;
+    Array<File> listdir_loose() const;
+
+    // Creates this directory and any missing parents.
+    bool create_directory() const;
 
     File operator+(const String& r);
     void operator+=(const String& r);
@@ -0,0 +1,138 @@
+#include "filewatcher.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if PLATFORM == LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher() {
+    debounce = 0.1f;
+#if PLATFORM == LINUX
+    fd = -1;
+#endif
+}
+
+FileWatcher::~FileWatcher() { stop(); }
+
+#if PLATFORM == LINUX
+
+bool FileWatcher::watch(const File& p_directory) {
+    stop();
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (fd < 0) {
+        T_ERROR("Could not start the file watcher: " + String(strerror(errno)));
+        return false;
+    }
+
+    add_directory(p_directory.get_absolute_path());
+
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (fd >= 0) ::close(fd);
+
+    fd = -1;
+    directories.clear();
+    pending.clear();
+}
+
+bool FileWatcher::is_watching() const { return fd >= 0; }
+
+void FileWatcher::add_directory(const String& p_path) {
+    int wd = inotify_add_watch(fd, p_path.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+
+    if (wd < 0) {
+        T_WARNING("Could not watch " + p_path + ": " + String(strerror(errno)));
+        return;
+    }
+
+    directories[wd] = p_path;
+
+    for (const File& file : File(p_path).listdir_loose())
+        if (!is_ignored(file.get_name()) && file.is_loose_directory()) add_directory(file);
+}
+
+void FileWatcher::read_events() {
+    alignas(inotify_event) char buffer[4096];
+
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) T_WARNING("File watcher missed some changes");
+
+            if (event->mask & IN_IGNORED) directories.erase(event->wd);
+
+            auto directory = directories.find(event->wd);
+            if (event->len == 0 || directory == directories.end()) continue;
+
+            String name = event->name;
+            if (is_ignored(name)) continue;
+
+            String path = directory->second + "/" + name;
+
+            if (event->mask & IN_ISDIR) {
+                // Files created along with the directory are missed, they are loaded anyway.
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) add_directory(path);
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                pending[path.c_str()] = Clock::now();
+            }
+        }
+    }
+}
+
+#else
+
+bool FileWatcher::watch(const File& p_directory) { return false; }
+
+void FileWatcher::stop() { pending.clear(); }
+
+bool FileWatcher::is_watching() const { return false; }
+
+void FileWatcher::add_directory(const String& p_path) {}
+
+void FileWatcher::read_events() {}
+
+#endif
+
+void FileWatcher::set_debounce(float p_debounce) { debounce = p_debounce; }
+
+float FileWatcher::get_debounce() const { return debounce; }
+
+Array<File> FileWatcher::poll() {
+    Array<File> result;
+
+    if (!is_watching()) return result;
+
+    read_events();
+
+    Clock::time_point now = Clock::now();
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (std::chrono::duration<float>(now - it->second).count() < debounce) {
+            it++;
+            continue;
+        }
+
+        result.push_back(File(it->first.c_str()));
+        it = pending.erase(it);
+    }
+
+    return result;
+}
+
+bool FileWatcher::is_ignored(const String& p_name) {
+    // Hidden files, the asset caches and the backups and swap files of editors.
+    return p_name.size() == 0 || p_name.starts_with(".") || p_name.ends_with("~");
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include "core/array.h"
+#include "file.h"
+
+// Reports files that were written below a directory, used to hot reload resources.
+// On Linux every directory of the tree gets an inotify watch, other platforms report nothing.
+// Editors often save a file in several steps, so a change is only reported once the file has
+// not been written to for the debounce time.
+class FileWatcher {
+   public:
+    FileWatcher();
+    ~FileWatcher();
+
+    // Watches the directory and its subdirectories, hidden ones such as .cache are skipped.
+    bool watch(const File& p_directory);
+    void stop();
+
+    bool is_watching() const;
+
+    void set_debounce(float p_debounce);
+    float get_debounce() const;
+
+    // Returns the files that changed and have settled since the last call, never blocks.
+    Array<File> poll();
+
+   private:
+    typedef std::chrono::steady_clock Clock;
+
+    void add_directory(const String& p_path);
+    void read_events();
+
+    static bool is_ignored(const String& p_name);
+
+    float debounce;
+
+    // Absolute path to the time of the last write.
+    std::unordered_map<std::string, Clock::time_point> pending;
+
+#if PLATFORM == LINUX
+    int fd;
+
+    // Watch descriptor to directory path.
+    std::unordered_map<int, String> directories;
+#endif
+};
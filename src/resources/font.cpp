@@ -1,6 +1,6 @@
 #include "font.h"
 
-#include <functional>
+#include <algorithm>
 
 #if PLATFORM == LINUX
 #include "SDL2/SDL.h"
@@ -10,18 +10,53 @@
 #include "sdl_ttf.h"
 #endif
 
-#include "core/contentmanager.h"
 #include "core/string.h"
-#include "core/tchar.h"
-#include "math/arraymath.h"
+#include "resources/virtualfilesystem.h"
+#include "utility/stringutils.h"
 
-Font::Font() {}
+//=========================================================================
+// TextLayout
+//=========================================================================
+
+int TextLayout::get_index(float p_offset) const {
+    // The first glyph whose middle lies beyond the offset starts the closest boundary.
+    auto it = std::upper_bound(glyphs.begin(), glyphs.end(), p_offset,
+                               [](float p_value, const Glyph& p_glyph) {
+                                   return p_value < p_glyph.x + p_glyph.advance / 2.0f;
+                               });
+
+    return it == glyphs.end() ? length : it->index;
+}
+
+float TextLayout::get_offset(int p_index) const {
+    if (p_index <= 0 || glyphs.empty()) return 0.0f;
+    if (p_index >= length) return width;
+
+    auto it = std::upper_bound(
+        glyphs.begin(), glyphs.end(), p_index,
+        [](int p_value, const Glyph& p_glyph) { return p_value < p_glyph.index; });
+
+    return (it - 1)->x;
+}
+
+//=========================================================================
+// Font
+//=========================================================================
+
+Font::Font() {
+    font = nullptr;
+    glyphs = nullptr;
+    kerning = false;
+    height = 0.0f;
+}
+
+Font::Font(const String& name, int size) : Font(name, open(name, size)) {}
 
-Font::Font(const String& name, int size) : Font() {
+Font::Font(const String& name, TTF_Font* p_font) : Font() {
     set_file(name);
-    font = TTF_OpenFont(name.c_str(), size);
+    font = p_font;
 
-    if ((String)TTF_GetError() != "") {
+    if (!font) {
         T_ERROR("Could not open font: " + std::string(TTF_GetError()));
         return;
     }
@@ -31,116 +66,155 @@ Font::Font(const String& name, int size) : Font() {
     if (TTF_SizeText(font, " ", &w, &h)) T_ERROR(TTF_GetError());
 
     height = to_float(h);
+    kerning = TTF_GetFontKerning(font) != 0;
 
-    renderer = new FontRenderer(this);
+    glyphs = new GlyphCache(font, h);
 }
 
 Font::~Font() {
-    TTF_CloseFont(font);
+    delete glyphs;
+
+    if (font) TTF_CloseFont(font);
     font = NULL;
 }
 
+TTF_Font* Font::open(const String& name, int size) {
+    return TTF_OpenFontRW(VFS->open_rw(name), 1, size);
+}
+
 void Font::Init() {
     if (TTF_Init()) T_ERROR("Could not initialize TTF:" + std::string(TTF_GetError()));
 }
 
 void Font::Quit() { TTF_Quit(); }
 
-Texture2D* Font::DrawToTex(const String& src) {
-    String s = src;
+const TextLayout& Font::get_layout(const String& text) const {
+    const std::string& source = text;
 
-    if (s.size() == 0 || src == "\t" || src == "\n") return DrawToTex(" ");
+    auto it = layouts.find(source);
+    if (it != layouts.end()) return it->second;
 
-    SDL_Color color = {255, 255, 255};
-    text = TTF_RenderText_Blended(font, src.c_str(), color);
+    // Text that changes every frame, like statistics, would grow the cache forever.
+    if (layouts.size() >= MAX_LAYOUTS) layouts.clear();
 
-    if (!text) T_ERROR("Could not render text: " + std::string(TTF_GetError()));
+    TextLayout& layout = layouts[source];
+    layout.length = int(source.size());
 
-    Texture2D* tex = new Texture2D(text);
-    tex->set_filter(Texture2D::BILINEAR_FILTER);
-    CONTENT->AddTexture(tex);
-    return tex;
-}
-
-int Font::get_index(const String& text, float p_offset) const {
-    if (p_offset < 0) return 0;
+    const char* begin = source.c_str();
+    const char* end = begin + source.size();
 
-    Array<float> offsets;
+    float x = 0.0f;
+    uint32_t previous = 0;
 
-    for (int c = 0; c < text.size() + 1; c++) offsets.push_back(get_width(text.substr(0, c)));
+    for (const char* c = begin; c < end;) {
+        uint32_t codepoint;
+        const char* next = StringUtils::decode_utf8(c, end, codepoint);
 
-    return to_int(ArrayMath::closest_to_index(p_offset, offsets));
-}
+        x += get_kerning(previous, codepoint);
 
-float Font::get_width(const String& text) const {
-    int temp = 0;
+        float advance = get_metrics(codepoint).advance;
+        layout.glyphs.push_back({codepoint, int(c - begin), x, advance});
 
-    if (TTF_SizeText(font, text.c_str(), &temp, NULL)) {
-        T_ERROR(TTF_GetError());
-        return 0.0f;
+        x += advance;
+        previous = codepoint;
+        c = next;
     }
 
-    int tab_count = text.count('\t');
-    float w = to_float(temp);
+    layout.width = x;
 
-    if (tab_count > 0) w += get_width(" ") * 2.0f * to_float(tab_count);
+    return layout;
+}
 
-    return to_float(w);
+int Font::get_index(const String& text, float p_offset) const {
+    if (p_offset < 0) return 0;
+
+    return get_layout(text).get_index(p_offset);
 }
 
-float Font::get_height() const { return height; }
+float Font::get_offset(const String& text, int p_index) const {
+    return get_layout(text).get_offset(p_index);
+}
 
-FontRenderer* Font::get_renderer() const { return renderer; }
+float Font::get_width(const String& text) const { return get_layout(text).width; }
 
-#undef CLASSNAME
-#define CLASSNAME Font
+float Font::get_height() const { return height; }
 
-void Font::bind_methods() {
-    // test
-    // REG_PROPERTY(height);
+GlyphCache* Font::get_glyphs() const { return glyphs; }
+
+size_t Font::get_gpu_size() const { return glyphs ? glyphs->get_gpu_size() : 0; }
+
+const Font::Metrics& Font::get_metrics(uint32_t p_codepoint) const {
+    auto it = metrics.find(p_codepoint);
+    if (it != metrics.end()) return it->second;
+
+    Metrics result = {0.0f, 0.0f};
+
+    if (p_codepoint == '\t') {
+        result.advance = get_metrics(' ').advance * 3.0f;
+    } else if (p_codepoint < ' ') {
+        result.advance = get_metrics(' ').advance;
+    } else if (font) {
+        int minx, maxx, miny, maxy, advance;
+
+        // SDL_ttf only gives metrics of the basic multilingual plane, other glyphs are measured.
+        if (p_codepoint <= 0xFFFF &&
+            TTF_GlyphMetrics(font, Uint16(p_codepoint), &minx, &maxx, &miny, &maxy, &advance) ==
+                0) {
+            result.advance = to_float(advance);
+            result.left = to_float(MIN(minx, 0));
+        } else {
+            char buffer[5];
+            *StringUtils::encode_utf8(buffer, p_codepoint) = '\0';
+            result.advance = measure(buffer);
+        }
+    }
 
-    REG_METHOD(get_index);
+    return metrics[p_codepoint] = result;
 }
 
-//=========================================================================
-// FontRenderer
-//=========================================================================
-
-FontRenderer::FontRenderer(Font* p_font) {
-    font = p_font;
+float Font::get_kerning(uint32_t p_previous, uint32_t p_codepoint) const {
+    if (!kerning || p_previous <= ' ' || p_codepoint <= ' ') return 0.0f;
+    if (p_previous > 0xFFFF || p_codepoint > 0xFFFF) return 0.0f;
 
-    String text;
+    uint64_t key = uint64_t(p_previous) << 32 | p_codepoint;
 
-    for (int i = 33; i < 127; i++) text += i;
+    auto it = kernings.find(key);
+    if (it != kernings.end()) return it->second;
 
-    texture = font->DrawToTex(text);
+    // The kerning API of SDL_ttf 2.0.12 takes glyph indices it does not expose, so the pair is
+    // measured instead. Measuring starts at the left edge of the first glyph.
+    char buffer[9];
+    char* middle = StringUtils::encode_utf8(buffer, p_previous);
+    *StringUtils::encode_utf8(middle, p_codepoint) = '\0';
 
-    init();
-}
+    float pair = measure(buffer);
+    float second = measure(middle);
 
-Texture2D* FontRenderer::get_texture() const { return texture; }
+    const Metrics& first = get_metrics(p_previous);
+    const Metrics& last = get_metrics(p_codepoint);
 
-void FontRenderer::init() {
-    String text;
+    float result = pair - first.advance - second + first.left - last.left;
 
-    for (int i = 33; i < 127; i++) {
-        starts[i - 33] = font->get_width(text);
+    return kernings[key] = result;
+}
 
-        text += i;
+float Font::measure(const char* p_text) const {
+    int width = 0;
 
-        ends[i - 33] = font->get_width(text);
+    if (TTF_SizeUTF8(font, p_text, &width, NULL)) {
+        T_ERROR(TTF_GetError());
+        return 0.0f;
     }
 
-    space_offset = font->get_width(" ");
-
-    // font->get_width(" ") == font->get_width("\t") for some reason
-    tab_offset = font->get_width(" ") * 3.0f;
+    return to_float(width);
 }
 
-vec4 FontRenderer::get_bounds(Char p_c) const {
-    return vec4(starts[p_c.kar - 33], ends[p_c.kar - 33], texture->get_size().y, 0);
-}
+#undef CLASSNAME
+#define CLASSNAME Font
 
-float FontRenderer::get_space_offset() const { return space_offset; }
+void Font::bind_methods() {
+    // test
+    // REG_PROPERTY(height);
 
-float FontRenderer::get_tab_offset() const { return tab_offset; }
+    REG_METHOD(get_index);
+}
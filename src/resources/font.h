@@ -1,9 +1,39 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glyphcache.h"
 #include "texture.h"
 #include "world/sprite.h"
 
-class FontRenderer;
+// Positions of the glyphs of a string, in pixels from its start.
+struct TextLayout {
+    struct Glyph {
+        uint32_t codepoint;
+
+        // Byte in the string where the glyph starts.
+        int index;
+
+        // Pen position, kerning with the previous glyph included.
+        float x;
+        float advance;
+    };
+
+    std::vector<Glyph> glyphs;
+    float width = 0.0f;
+
+    // Bytes in the string.
+    int length = 0;
+
+    // Byte index of the glyph boundary closest to p_offset.
+    int get_index(float p_offset) const;
+
+    // Pen position at byte p_index, an index inside a glyph gives its start.
+    float get_offset(int p_index) const;
+};
 
 class Font : public Resource {
     OBJ_DEFINITION(Font, Resource)
@@ -11,46 +41,54 @@ class Font : public Resource {
    public:
     Font();
     Font(const String& name, int size);
+    Font(const String& name, TTF_Font* p_font);
     ~Font();
 
+    // Opens a font file without touching GL. SDL_ttf is not thread safe, so like every other TTF
+    // call this stays on the render thread.
+    static TTF_Font* open(const String& name, int size);
+
     static void Init();
     static void Quit();
 
-    Texture2D* DrawToTex(const String& src);
+    // Lays out UTF-8 text in one pass, recent layouts are cached. The reference is valid until
+    // the next call.
+    const TextLayout& get_layout(const String& text) const;
+
     int get_index(const String& text, float p_offset) const;
+    float get_offset(const String& text, int p_index) const;
     float get_width(const String& text) const;
     float get_height() const;
 
-    FontRenderer* get_renderer() const;
+    GlyphCache* get_glyphs() const;
+
+    size_t get_gpu_size() const override;
 
     static void bind_methods();
 
     float height;
 
    private:
-    SDL_Surface* text;
-    TTF_Font* font;
-    FontRenderer* renderer;
-};
+    struct Metrics {
+        float advance;
 
-class FontRenderer {
-   public:
-    FontRenderer(Font* p_font);
-
-    Texture2D* get_texture() const;
-    vec4 get_bounds(Char p_c) const;
+        // Where the rendered glyph starts relative to the pen, at most zero.
+        float left;
+    };
 
-    float get_space_offset() const;
-    float get_tab_offset() const;
+    const Metrics& get_metrics(uint32_t p_codepoint) const;
+    float get_kerning(uint32_t p_previous, uint32_t p_codepoint) const;
 
-    void init();
+    // Width of text as SDL_ttf measures it.
+    float measure(const char* p_text) const;
 
-   private:
-    Font* font;
-    Texture2D* texture;
+    TTF_Font* font;
+    GlyphCache* glyphs;
+    bool kerning;
 
-    float space_offset, tab_offset;
+    mutable std::unordered_map<std::string, TextLayout> layouts;
+    mutable std::unordered_map<uint32_t, Metrics> metrics;
+    mutable std::unordered_map<uint64_t, float> kernings;
 
-    float starts[94];
-    float ends[94];
+    static const int MAX_LAYOUTS = 1024;
 };
@@ -0,0 +1,184 @@
+#include "glyphcache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/tmessage.h"
+#include "graphics/canvasbatch.h"
+#include "graphics/glstate.h"
+#include "math/math.h"
+#include "utility/stringutils.h"
+
+GlyphCache::GlyphCache(TTF_Font* p_font, int p_height) {
+    font = p_font;
+
+    // Wide enough for most glyphs of a font, wider ones are cut off.
+    cell_height = MAX(p_height, 1) + 2;
+    cell_width = MAX(p_height, 1) * 3 / 2 + 2;
+    columns = MAX(PAGE_WIDTH / cell_width, 1);
+    rows = MAX(MAX(256, cell_height * 4) / cell_height, 1);
+
+    created = false;
+    page_x = 0;
+    page_y = 0;
+    texture = nullptr;
+
+    cells.reserve(columns * rows);
+    pixels.resize(size_t(cell_width) * cell_height * 4);
+}
+
+GlyphCache::~GlyphCache() {
+    if (texture) {
+        delete texture;
+        return;
+    }
+
+    if (!created) return;
+
+    // Queued quads may still show glyphs of the page.
+    CANVAS_BATCH->flush();
+    CANVAS_BATCH->get_atlas()->release(page_x, page_y, columns * cell_width, rows * cell_height);
+}
+
+const GlyphCache::Glyph* GlyphCache::get(uint32_t p_codepoint) {
+    auto it = lookup.find(p_codepoint);
+
+    if (it != lookup.end()) {
+        Cell& cell = cells[it->second];
+        uses.splice(uses.begin(), uses, cell.use);
+        return &cell.glyph;
+    }
+
+    if (missing.count(p_codepoint)) return nullptr;
+
+    if (!created) create();
+
+    int width, height;
+    float left;
+
+    if (!rasterize(p_codepoint, width, height, left)) {
+        missing.insert(p_codepoint);
+        return nullptr;
+    }
+
+    int index = take_cell();
+    Cell& cell = cells[index];
+
+    int x = page_x + index % columns * cell_width;
+    int y = page_y + index / columns * cell_height;
+
+    upload(x, y);
+
+    float atlas_size = to_float(CANVAS_BATCH->get_atlas()->get_size());
+    vec2 page_size = texture ? texture->get_size() : vec2(atlas_size, atlas_size);
+
+    cell.codepoint = p_codepoint;
+    cell.glyph.size = vec2(to_float(width), to_float(height));
+    cell.glyph.left = left;
+
+    // The first row of the surface is the top of the glyph.
+    cell.glyph.bounds = vec4((x + 1) / page_size.x, (x + 1 + width) / page_size.x,
+                             (y + 1 + height) / page_size.y, (y + 1) / page_size.y);
+
+    lookup[p_codepoint] = index;
+
+    return &cell.glyph;
+}
+
+Texture2D* GlyphCache::get_texture() const { return texture; }
+
+size_t GlyphCache::get_gpu_size() const {
+    if (!created) return 0;
+
+    return size_t(columns * cell_width) * size_t(rows * cell_height) * 4;
+}
+
+void GlyphCache::create() {
+    created = true;
+
+    int width = columns * cell_width;
+    int height = rows * cell_height;
+
+    if (CANVAS_BATCH->get_atlas()->reserve(width, height, page_x, page_y)) return;
+
+    T_LOG("Texture atlas is full, drawing glyphs from a page of their own");
+
+    page_x = 0;
+    page_y = 0;
+
+    texture = new Texture2D(vec2(to_float(width), to_float(height)), true);
+    texture->set_filter(Texture2D::BILINEAR_FILTER);
+}
+
+bool GlyphCache::rasterize(uint32_t p_codepoint, int& r_width, int& r_height, float& r_left) {
+    if (!font) return false;
+
+    // The surface starts at the left edge of the glyph when it reaches before the pen.
+    int minx = 0, maxx, miny, maxy, advance;
+    r_left = 0.0f;
+
+    if (p_codepoint <= 0xFFFF &&
+        TTF_GlyphMetrics(font, Uint16(p_codepoint), &minx, &maxx, &miny, &maxy, &advance) == 0)
+        r_left = to_float(MIN(minx, 0));
+
+    char text[5];
+    *StringUtils::encode_utf8(text, p_codepoint) = '\0';
+
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* rendered = TTF_RenderUTF8_Blended(font, text, white);
+
+    if (!rendered) return false;
+
+    // Blended text is 32 bit, but the order of the channels depends on the platform.
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(rendered);
+
+    if (!surface) return false;
+
+    r_width = MIN(surface->w, cell_width - 2);
+    r_height = MIN(surface->h, cell_height - 2);
+
+    std::fill(pixels.begin(), pixels.end(), 0);
+
+    for (int row = 0; row < r_height; row++) {
+        const unsigned char* source = (const unsigned char*)surface->pixels + row * surface->pitch;
+        memcpy(&pixels[(size_t(row + 1) * cell_width + 1) * 4], source, size_t(r_width) * 4);
+    }
+
+    SDL_FreeSurface(surface);
+
+    return r_width > 0 && r_height > 0;
+}
+
+int GlyphCache::take_cell() {
+    if (int(cells.size()) < columns * rows) {
+        int index = int(cells.size());
+
+        uses.push_front(index);
+        cells.push_back({0, Glyph(), uses.begin()});
+
+        return index;
+    }
+
+    int index = uses.back();
+    Cell& cell = cells[index];
+
+    lookup.erase(cell.codepoint);
+    uses.splice(uses.begin(), uses, cell.use);
+
+    // Quads collected earlier may still show the glyph that is replaced.
+    CANVAS_BATCH->flush();
+
+    return index;
+}
+
+void GlyphCache::upload(int p_x, int p_y) {
+    if (!texture) {
+        CANVAS_BATCH->get_atlas()->upload(p_x, p_y, cell_width, cell_height, pixels.data());
+        return;
+    }
+
+    GLSTATE->bind_texture(GL_TEXTURE_2D, texture->get_id());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, p_x, p_y, cell_width, cell_height, GL_RGBA,
+                    GL_UNSIGNED_BYTE, pixels.data());
+}
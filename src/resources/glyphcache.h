@@ -0,0 +1,84 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "math/vec3.h"
+#include "math/vec4.h"
+#include "texture.h"
+
+// Rasterized glyphs of one font, rendered the first time they are drawn.
+//
+// The glyphs share a page of equal cells, reserved in the atlas of the canvas batch so text is
+// drawn together with the rest of the interface. When all cells are taken, the glyph that was
+// drawn the longest ago makes room. A page of its own is used if the atlas is full. The page goes
+// back to the atlas when the cache is deleted.
+class GlyphCache {
+   public:
+    GlyphCache(TTF_Font* p_font, int p_height);
+    ~GlyphCache();
+
+    struct Glyph {
+        // In pixels, the left edge lies left pixels from the pen position.
+        vec2 size;
+        float left;
+
+        // Left, right, bottom and top texture coordinates.
+        vec4 bounds;
+    };
+
+    // Rasterizes p_codepoint if needed, null if the font has nothing to draw for it. The pointer
+    // is valid until the next call.
+    const Glyph* get(uint32_t p_codepoint);
+
+    // The page, null if it is part of the canvas atlas.
+    Texture2D* get_texture() const;
+
+    size_t get_gpu_size() const;
+
+   private:
+    struct Cell {
+        uint32_t codepoint;
+        Glyph glyph;
+        std::list<int>::iterator use;
+    };
+
+    void create();
+
+    // Renders p_codepoint into pixels with a transparent border, returns false if the font has
+    // nothing for it.
+    bool rasterize(uint32_t p_codepoint, int& r_width, int& r_height, float& r_left);
+
+    // A free cell, or the least recently drawn one.
+    int take_cell();
+
+    void upload(int p_x, int p_y);
+
+    TTF_Font* font;
+
+    int cell_width;
+    int cell_height;
+    int columns;
+    int rows;
+
+    bool created;
+
+    // Pixel position of the page, in the atlas or in texture.
+    int page_x;
+    int page_y;
+    Texture2D* texture;
+
+    std::vector<Cell> cells;
+
+    // Cell indices, the most recently drawn first.
+    std::list<int> uses;
+
+    std::unordered_map<uint32_t, int> lookup;
+    std::unordered_set<uint32_t> missing;
+
+    std::vector<unsigned char> pixels;
+
+    static const int PAGE_WIDTH = 1024;
+};
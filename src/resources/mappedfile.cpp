@@ -0,0 +1,106 @@
+#include "mappedfile.h"
+
+#if PLATFORM == LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#include "resources/virtualfilesystem.h"
+
+MappedFile::MappedFile() {
+    data = nullptr;
+    size = 0;
+#if PLATFORM == LINUX
+    fd = -1;
+#endif
+}
+
+MappedFile::MappedFile(const File& p_file) : MappedFile() { open(p_file); }
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::is_open() const { return data != nullptr; }
+
+const char* MappedFile::get_data() const { return data; }
+
+size_t MappedFile::get_size() const { return size; }
+
+bool MappedFile::open(const File& p_file) {
+    close();
+
+    if (!VFS->is_archived(p_file)) return open_loose(p_file);
+
+    if (!VFS->read(p_file, data, size, buffer) || size == 0) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+#if PLATFORM == LINUX
+bool MappedFile::open_loose(const File& p_file) {
+    fd = ::open(p_file.get_absolute_path().c_str(), O_RDONLY);
+    if (fd < 0) {
+        T_ERROR("Could not open file: " + p_file.get_absolute_path());
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close();
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        T_ERROR("Could not map file: " + p_file.get_absolute_path());
+        close();
+        return false;
+    }
+
+    data = static_cast<const char*>(mapping);
+    size = file_stat.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    // Without a descriptor the data belongs to an archive or the buffer.
+    if (data && fd >= 0) munmap(const_cast<char*>(data), size);
+    if (fd >= 0) ::close(fd);
+
+    buffer.clear();
+
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+#else
+bool MappedFile::open_loose(const File& p_file) {
+    std::ifstream stream(p_file.get_absolute_path().c_str(), std::ios::binary | std::ios::ate);
+    if (!stream.is_open()) {
+        T_ERROR("Could not open file: " + p_file.get_absolute_path());
+        return false;
+    }
+
+    buffer.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(buffer.data(), buffer.size());
+
+    if (buffer.size() == 0) return false;
+
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+}
+
+void MappedFile::close() {
+    buffer.clear();
+    data = nullptr;
+    size = 0;
+}
+#endif
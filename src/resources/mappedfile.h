@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "file.h"
+
+// Read-only view of a file's contents.
+// On Linux the file is mmap'ed, other platforms read it into memory. Files in a mounted archive
+// point into the archive's mapping, or into a buffer when the entry is compressed.
+class MappedFile {
+   public:
+    MappedFile();
+    MappedFile(const File& p_file);
+    ~MappedFile();
+
+    bool open(const File& p_file);
+    void close();
+
+    bool is_open() const;
+
+    const char* get_data() const;
+    size_t get_size() const;
+
+   private:
+    bool open_loose(const File& p_file);
+
+    const char* data;
+    size_t size;
+
+    std::vector<char> buffer;
+
+#if PLATFORM == LINUX
+    int fd;
+#endif
+};
@@ -0,0 +1,118 @@
+#include "programcache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "core/tmessage.h"
+#include "resources/assetcache.h"
+#include "resources/mappedfile.h"
+
+namespace {
+const char MAGIC[4] = {'T', 'P', 'R', 'G'};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t size;
+};
+}  // namespace
+
+ProgramCache::ProgramCache() {
+    uint32_t version = VERSION;
+    key = AssetCache::hash(&version, sizeof(version), get_driver_key());
+}
+
+void ProgramCache::add_source(GLenum p_stage, const String& p_source) {
+    uint32_t stage = p_stage;
+
+    key = AssetCache::hash(&stage, sizeof(stage), key);
+    key = AssetCache::hash(p_source.c_str(), p_source.size(), key);
+}
+
+GLuint ProgramCache::load() {
+    File entry = AssetCache::get_file("programs", key, "tprg");
+
+    MappedFile mapped;
+    if (!entry.is_file() || !mapped.open(entry)) return 0;
+
+    Header header;
+    if (mapped.get_size() < sizeof(Header)) return 0;
+
+    memcpy(&header, mapped.get_data(), sizeof(Header));
+
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.key != key || sizeof(Header) + header.size > mapped.get_size()) {
+        T_WARNING("Ignoring corrupt program cache entry: " + entry.get_absolute_path());
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, mapped.get_data() + sizeof(Header), header.size);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+    if (status != GL_TRUE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+bool ProgramCache::save(GLuint p_program) {
+    GLint size = 0;
+    glGetProgramiv(p_program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+    if (size <= 0) return false;
+
+    std::vector<char> buffer(sizeof(Header) + size);
+    GLsizei length = 0;
+    GLenum format = 0;
+
+    glGetProgramBinary(p_program, size, &length, &format, buffer.data() + sizeof(Header));
+
+    if (length <= 0) return false;
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = key;
+    header.format = format;
+    header.size = length;
+    memcpy(buffer.data(), &header, sizeof(Header));
+
+    return AssetCache::write(AssetCache::get_file("programs", key, "tprg"), buffer.data(),
+                             sizeof(Header) + length);
+}
+
+bool ProgramCache::is_supported() {
+    static int supported = -1;
+
+    if (supported == -1) {
+        GLint formats = 0;
+        if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+        supported = formats > 0;
+    }
+
+    return supported;
+}
+
+uint64_t ProgramCache::get_driver_key() {
+    static uint64_t driver_key = 0;
+    if (driver_key) return driver_key;
+
+    uint64_t result = AssetCache::HASH_SEED;
+    GLenum names[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+    for (GLenum name : names) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        if (value) result = AssetCache::hash(value, strlen(value), result);
+    }
+
+    driver_key = result;
+    return driver_key;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#if PLATFORM == LINUX
+#include <GL/glew.h>
+#else
+#include <GL\glew.h>
+#endif
+
+#include "core/string.h"
+#include "resources/file.h"
+
+// Linked shader programs in the driver's binary format, so they are not compiled again on the
+// next start.
+//
+// Binaries are only valid for the driver that produced them, so entries are keyed by the
+// sources of all stages and the vendor, renderer and version strings of the GL context. A
+// driver may still reject a binary, for example after an update that kept its version string,
+// the caller then compiles from source and saves a new entry.
+class ProgramCache {
+   public:
+    ProgramCache();
+
+    // Adds a stage to the key, in the order the stages are attached.
+    void add_source(GLenum p_stage, const String& p_source);
+
+    // Creates a program from a matching entry, returns 0 if there is none or it was rejected.
+    GLuint load();
+
+    // Stores the binary of a program that was linked with the retrievable hint set.
+    bool save(GLuint p_program);
+
+    // False when the driver offers no binary formats, such as Mesa with its disk cache disabled.
+    static bool is_supported();
+
+    static const uint32_t VERSION = 1;
+
+   private:
+    static uint64_t get_driver_key();
+
+    uint64_t key;
+};
@@ -1,5 +1,7 @@
 #include "resource.h"
 
+#include "resources/resourceregistry.h"
+
 #undef CLASSNAME
 #define CLASSNAME Resource
 
@@ -11,4 +13,16 @@ void Resource::set_file(const String& p_file) {
 
 String Resource::get_file() const { return file.get_relative_path(); }
 
+void Resource::referenced() {
+    if (registry) registry->acquire(this);
+}
+
+void Resource::unreferenced() {
+    // Registered resources stay cached until the registry evicts them.
+    if (registry)
+        registry->release(this);
+    else
+        Referenced::unreferenced();
+}
+
 void Resource::bind_methods() { REG_PROPERTY(file); }
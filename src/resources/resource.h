@@ -3,9 +3,13 @@
 #include "core/reference.h"
 #include "file.h"
 
+class ResourceRegistry;
+
 class Resource : public Referenced {
     OBJ_DEFINITION(Resource, Referenced);
 
+    friend class ResourceRegistry;
+
    public:
     Resource() = default;
 
@@ -14,6 +18,13 @@ class Resource : public Referenced {
     virtual void reload() {}
     virtual void free() {}
 
+    // False while the data of an asynchronously loaded resource is not available yet.
+    virtual bool is_ready() const { return true; }
+
+    // Approximate memory held in system memory and on the GPU, in bytes.
+    virtual size_t get_cpu_size() const { return 0; }
+    virtual size_t get_gpu_size() const { return 0; }
+
     void set_file(const String& p_file);
     String get_file() const;
 
@@ -22,5 +33,11 @@ class Resource : public Referenced {
    protected:
     virtual void file_loaded() {}
 
+    void referenced() override;
+    void unreferenced() override;
+
     File file;
+
+   private:
+    ResourceRegistry* registry = nullptr;
 };
@@ -0,0 +1,204 @@
+#include "resourceregistry.h"
+
+#include <iterator>
+
+#include "resources/resource.h"
+
+ResourceRegistry::ResourceRegistry() {
+    cpu_budget = 0;
+    gpu_budget = 0;
+}
+
+Resource* ResourceRegistry::find(const File& p_file) const {
+    auto it = entries.find(hash(p_file));
+
+    if (it == entries.end()) return nullptr;
+
+    // Guard against hash collisions.
+    if (it->second.resource->get_file() != p_file.get_relative_path()) return nullptr;
+
+    return it->second.resource;
+}
+
+bool ResourceRegistry::add(Resource* p_resource, bool p_pinned) {
+    size_t key = hash(p_resource->get_file());
+    auto it = entries.find(key);
+
+    if (it != entries.end()) {
+        if (it->second.resource->get_file() != p_resource->get_file()) {
+            T_ERROR("Resources " + it->second.resource->get_file() + " and " +
+                    p_resource->get_file() + " have the same key, the latter is not cached");
+            return false;
+        }
+
+        // A newer load of the same file replaces the cached one.
+        remove(it->second.resource);
+    }
+
+    Entry& entry = entries[key];
+    entry.resource = p_resource;
+    entry.pinned = p_pinned;
+    keys[p_resource] = key;
+
+    p_resource->registry = this;
+
+    return true;
+}
+
+void ResourceRegistry::remove(Resource* p_resource) {
+    auto key = keys.find(p_resource);
+    if (key == keys.end()) return;
+
+    Entry& entry = entries[key->second];
+    if (entry.unused) lru.erase(entry.lru);
+
+    entries.erase(key->second);
+    keys.erase(key);
+
+    p_resource->registry = nullptr;
+}
+
+void ResourceRegistry::pin(Resource* p_resource) {
+    auto key = keys.find(p_resource);
+    if (key == keys.end()) return;
+
+    Entry& entry = entries[key->second];
+    entry.pinned = true;
+
+    if (entry.unused) {
+        lru.erase(entry.lru);
+        entry.unused = false;
+    }
+}
+
+void ResourceRegistry::clear() {
+    for (std::pair<const size_t, Entry>& entry : entries) entry.second.resource->registry = nullptr;
+
+    entries.clear();
+    keys.clear();
+    lru.clear();
+}
+
+void ResourceRegistry::acquire(Resource* p_resource) {
+    auto key = keys.find(p_resource);
+    if (key == keys.end()) return;
+
+    Entry& entry = entries[key->second];
+    if (!entry.unused) return;
+
+    lru.erase(entry.lru);
+    entry.unused = false;
+}
+
+void ResourceRegistry::release(Resource* p_resource) {
+    auto key = keys.find(p_resource);
+    if (key == keys.end()) return;
+
+    Entry& entry = entries[key->second];
+    if (entry.unused || entry.pinned) return;
+
+    lru.push_front(p_resource);
+    entry.lru = lru.begin();
+    entry.unused = true;
+
+    if (cpu_budget || gpu_budget) evict();
+}
+
+void ResourceRegistry::set_budget(size_t p_cpu_budget, size_t p_gpu_budget) {
+    cpu_budget = p_cpu_budget;
+    gpu_budget = p_gpu_budget;
+
+    evict();
+}
+
+size_t ResourceRegistry::get_cpu_budget() const { return cpu_budget; }
+
+size_t ResourceRegistry::get_gpu_budget() const { return gpu_budget; }
+
+int ResourceRegistry::evict() {
+    if (lru.empty() || (!cpu_budget && !gpu_budget)) return 0;
+
+    size_t cpu_size = 0;
+    size_t gpu_size = 0;
+
+    for (const std::pair<const size_t, Entry>& entry : entries) {
+        cpu_size += entry.second.resource->get_cpu_size();
+        gpu_size += entry.second.resource->get_gpu_size();
+    }
+
+    int count = 0;
+    auto it = lru.end();
+
+    while (it != lru.begin() && ((cpu_budget && cpu_size > cpu_budget) ||
+                                 (gpu_budget && gpu_size > gpu_budget))) {
+        // Oldest first, removing erases the entry before it, which keeps it valid.
+        auto previous = std::prev(it);
+        Resource* resource = *previous;
+
+        // Uploads queued by asynchronous loads still write into it.
+        if (!resource->is_ready()) {
+            it = previous;
+            continue;
+        }
+
+        cpu_size -= resource->get_cpu_size();
+        gpu_size -= resource->get_gpu_size();
+
+        remove(resource);
+
+        if (evict_callback) evict_callback(resource);
+        delete resource;
+
+        count++;
+    }
+
+    if (count > 0) T_LOG("Evicted " + String(count) + " unused resources");
+
+    return count;
+}
+
+void ResourceRegistry::set_evict_callback(const std::function<void(Resource*)>& p_callback) {
+    evict_callback = p_callback;
+}
+
+Array<ResourceRegistry::Usage> ResourceRegistry::get_usage() const {
+    Array<Usage> result;
+
+    for (const std::pair<const size_t, Entry>& entry : entries) {
+        Resource* resource = entry.second.resource;
+        StringName type = resource->get_type_name();
+        Usage* usage = nullptr;
+
+        for (Usage& u : result)
+            if (u.type == type) usage = &u;
+
+        if (!usage) {
+            result.push_back(Usage());
+            usage = &result[result.size() - 1];
+            usage->type = type;
+        }
+
+        usage->count++;
+        usage->unused += entry.second.unused;
+        usage->cpu_size += resource->get_cpu_size();
+        usage->gpu_size += resource->get_gpu_size();
+    }
+
+    return result;
+}
+
+String ResourceRegistry::get_usage_report() const {
+    String report;
+
+    for (const Usage& usage : get_usage()) {
+        report += usage.type.get_source() + ": " + String(usage.count) + " (" +
+                  String(usage.unused) + " unused), cpu " + String(int(usage.cpu_size / 1024)) +
+                  " KiB, gpu " + String(int(usage.gpu_size / 1024)) + " KiB\n";
+    }
+
+    return report;
+}
+
+size_t ResourceRegistry::hash(const File& p_file) {
+    return p_file.get_absolute_path().get_hash();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include "core/array.h"
+#include "core/string.h"
+#include "resources/file.h"
+
+class Resource;
+
+// Lookup table for loaded resources, keyed by the hash of their canonical path.
+//
+// Resources that lose their last Ref are kept on an LRU list instead of being freed, so loading
+// them again is free. When the CPU or GPU memory used by all registered resources exceeds the
+// budget, the least recently released ones are evicted. Resources that are only held through
+// raw pointers never enter the list, and resources that are held through both are pinned so they
+// are never evicted either.
+class ResourceRegistry {
+   public:
+    ResourceRegistry();
+
+    struct Usage {
+        StringName type;
+        int count = 0;
+        int unused = 0;
+        size_t cpu_size = 0;
+        size_t gpu_size = 0;
+    };
+
+    Resource* find(const File& p_file) const;
+
+    template <typename T>
+    T* find(const File& p_file) const {
+        return dynamic_cast<T*>(find(p_file));
+    }
+
+    // Returns false, leaving p_resource unregistered, if a resource with another path has the same
+    // key.
+    bool add(Resource* p_resource, bool p_pinned = false);
+    void remove(Resource* p_resource);
+
+    // Keeps p_resource from being evicted, for holders that keep a raw pointer to it.
+    void pin(Resource* p_resource);
+    void clear();
+
+    // Called by Resource when its reference count changes between zero and one.
+    void acquire(Resource* p_resource);
+    void release(Resource* p_resource);
+
+    // A budget of zero disables eviction for that kind of memory.
+    void set_budget(size_t p_cpu_budget, size_t p_gpu_budget);
+    size_t get_cpu_budget() const;
+    size_t get_gpu_budget() const;
+
+    // Evicts unused resources until both budgets are met, returns the number evicted. Resources
+    // that are still loading are skipped.
+    int evict();
+
+    // Called before an evicted resource is deleted, so owners can forget about it.
+    void set_evict_callback(const std::function<void(Resource*)>& p_callback);
+
+    Array<Usage> get_usage() const;
+    String get_usage_report() const;
+
+    static size_t hash(const File& p_file);
+
+   private:
+    struct Entry {
+        Resource* resource;
+        bool unused = false;
+        bool pinned = false;
+        std::list<Resource*>::iterator lru;
+    };
+
+    std::unordered_map<size_t, Entry> entries;
+    std::unordered_map<Resource*, size_t> keys;
+
+    // Most recently released first.
+    std::list<Resource*> lru;
+
+    size_t cpu_budget;
+    size_t gpu_budget;
+
+    std::function<void(Resource*)> evict_callback;
+};
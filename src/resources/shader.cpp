@@ -1,6 +1,7 @@
 #include "shader.h"
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <string>
 
@@ -18,11 +19,15 @@
 
 #include "core/contentmanager.h"
 #include "core/string.h"
+#include "core/time.h"
 #include "core/tmessage.h"
+#include "graphics/glstate.h"
 #include "math/color.h"
 #include "math/math.h"
+#include "resources/programcache.h"
 
 #define MAX_LOG_LENGTH 1000
+#define MAX_INCLUDE_DEPTH 8
 
 Shader::Shader(const String& p_path) {
     program_id = -1;
@@ -47,46 +52,100 @@ Shader::Shader(const String& p_path) {
 
 Shader::~Shader() { free(); }
 
+Shader::LoadStats Shader::load_stats;
+Shader::UniformStats Shader::uniform_stats;
+
 void Shader::load() {
+    Stopwatch watch;
+    watch.start();
+
+    ProgramCache cache;
+    bool cacheable = ProgramCache::is_supported() && add_sources(cache);
+
+    if (cacheable) program_id = cache.load();
+
+    if (cacheable && program_id) {
+        isvalid = true;
+        GLSTATE->use_program(program_id);
+        set_info();
+
+        load_stats.cached++;
+        load_stats.cache_time += watch.stop();
+        return;
+    }
+
     isvalid = true;
 
-    // compute shader
     if (is_compute_shader()) {
+        // compute shader
         compute_id = create_shader(compute_path, GL_COMPUTE_SHADER);
-        if (compute_id) create_program();
+        if (compute_id <= 0) isvalid = false;
+    } else {
+        // vertex shader
+        vertexshader_id = create_shader(vertex_path, GL_VERTEX_SHADER);
+        if (vertexshader_id <= 0) isvalid = false;
+
+        // fragment shader
+        fragmentshader_id = create_shader(fragment_path, GL_FRAGMENT_SHADER);
+        if (fragmentshader_id <= 0) isvalid = false;
+
+        // geometry shader
+        if (has_geometry_shader()) {
+            geometryshader_id = create_shader(geometry_path, GL_GEOMETRY_SHADER);
+            if (geometryshader_id <= 0) isvalid = false;
+        }
+
+        // tesselation shaders
+        if (has_tesselation_shader()) {
+            tess_control_id = create_shader(tess_control_path, GL_TESS_CONTROL_SHADER);
+            tess_evaluation_id = create_shader(tess_evaluation_path, GL_TESS_EVALUATION_SHADER);
+            if (tess_control_id <= 0 || tess_evaluation_id <= 0) isvalid = false;
+        }
+    }
+
+    if (!isvalid) {
+        T_ERROR("Failed to compile: " + get_file() + "!");
         return;
     }
 
-    // vertex shader
-    vertexshader_id = create_shader(vertex_path, GL_VERTEX_SHADER);
-    if (!vertexshader_id) isvalid = false;
+    if (create_program() && cacheable) cache.save(program_id);
 
-    // fragment shader
-    fragmentshader_id = create_shader(fragment_path, GL_FRAGMENT_SHADER);
-    if (!fragmentshader_id) isvalid = false;
+    load_stats.compiled++;
+    load_stats.compile_time += watch.stop();
+}
 
-    // geometry shader
-    if (has_geometry_shader()) {
-        geometryshader_id = create_shader(geometry_path, GL_GEOMETRY_SHADER);
-        if (!geometryshader_id) isvalid = false;
+bool Shader::add_sources(ProgramCache& p_cache) {
+    if (is_compute_shader()) {
+        p_cache.add_source(GL_COMPUTE_SHADER, get_source(compute_path));
+        return true;
     }
 
-    // tesselation shaders
+    if (!vertex_path.is_file() || !fragment_path.is_file()) return false;
+
+    // Same order as the stages are compiled and attached.
+    p_cache.add_source(GL_VERTEX_SHADER, get_source(vertex_path));
+    p_cache.add_source(GL_FRAGMENT_SHADER, get_source(fragment_path));
+
+    if (has_geometry_shader())
+        p_cache.add_source(GL_GEOMETRY_SHADER, get_source(geometry_path));
+
     if (has_tesselation_shader()) {
-        tess_control_id = create_shader(tess_control_path, GL_TESS_CONTROL_SHADER);
-        tess_evaluation_id = create_shader(tess_evaluation_path, GL_TESS_EVALUATION_SHADER);
-        if (!tess_control_id || !tess_evaluation_id) isvalid = false;
+        p_cache.add_source(GL_TESS_CONTROL_SHADER, get_source(tess_control_path));
+        p_cache.add_source(GL_TESS_EVALUATION_SHADER, get_source(tess_evaluation_path));
     }
 
-    if (isvalid)
-        create_program();
-    else
-        T_ERROR("Failed to compile: " + get_file() + "!");
+    return true;
 }
 
 void Shader::reload() {
     free();
+
+    blocks.clear();
+
     load();
+
+    for (std::pair<const String, UBO*>& binding : block_bindings)
+        bind_block(binding.first, binding.second);
 }
 
 void Shader::free() {
@@ -97,24 +156,82 @@ void Shader::free() {
     CONTENT->free_textfile(tess_evaluation_path);
     CONTENT->free_textfile(compute_path);
 
+    for (int c = 0; c < includes.size(); c++) CONTENT->free_textfile(includes[c]);
+    includes.clear();
+
     if (!isvalid) return;
 
-    glDeleteShader(vertexshader_id);
-    glDeleteShader(fragmentshader_id);
+    // Programs loaded from the program cache have no shader objects.
+    if (vertexshader_id > 0) glDeleteShader(vertexshader_id);
+    if (fragmentshader_id > 0) glDeleteShader(fragmentshader_id);
+    if (geometryshader_id > 0) glDeleteShader(geometryshader_id);
+    if (tess_control_id > 0) glDeleteShader(tess_control_id);
+    if (tess_evaluation_id > 0) glDeleteShader(tess_evaluation_id);
+    if (compute_id > 0) glDeleteShader(compute_id);
 
-    if (geometryshader_id != -1) glDeleteShader(geometryshader_id);
+    GLSTATE->delete_program(program_id);
 
-    if (tess_control_id != -1 && tess_evaluation_id != -1) {
-        glDeleteShader(tess_control_id);
-        glDeleteShader(tess_evaluation_id);
-    }
+    program_id = -1;
+    vertexshader_id = -1;
+    fragmentshader_id = -1;
+    geometryshader_id = -1;
+    tess_control_id = -1;
+    tess_evaluation_id = -1;
+    compute_id = -1;
+}
+
+void Shader::start() { GLSTATE->use_program(program_id); }
+
+bool Shader::depends_on(const File& p_file) const {
+    String path = p_file.get_absolute_path();
 
-    if (compute_id != -1) glDeleteShader(compute_id);
+    for (int c = 0; c < includes.size(); c++)
+        if (includes[c].get_absolute_path() == path) return true;
 
-    glDeleteProgram(program_id);
+    return false;
 }
 
-void Shader::start() { glUseProgram(program_id); }
+String Shader::get_source(const File& p_path, int p_depth) {
+    String source = CONTENT->LoadTextFile(p_path)->get_source();
+
+    if (!source.contains("#include")) return source;
+
+    Array<String> lines = source.split('\n');
+    String result;
+
+    for (int c = 0; c < lines.size(); c++) {
+        String line = lines[c];
+        line.trim();
+
+        if (!line.starts_with("#include")) {
+            result += lines[c] + "\n";
+            continue;
+        }
+
+        int start = line.find_first('"');
+        int end = line.find_last('"');
+
+        if (start == -1 || end <= start || p_depth >= MAX_INCLUDE_DEPTH) {
+            T_ERROR("Invalid include in " + p_path.get_relative_path() + ": " + line);
+            continue;
+        }
+
+        // Relative to the including file.
+        File include = p_path;
+        include.go_up();
+        include.go_into(line.substr(start + 1, end - start - 1));
+
+        bool listed = false;
+        for (int i = 0; i < includes.size(); i++) listed |= includes[i] == include;
+
+        if (!listed) includes.push_back(include);
+
+        // Keeps the line numbers of compile errors pointing into the including file.
+        result += get_source(include, p_depth + 1) + "\n#line " + String(c + 2) + "\n";
+    }
+
+    return result;
+}
 
 GLint Shader::create_shader(const String& p_path, GLenum ShaderType) {
     GLint shader_id = glCreateShader(ShaderType);
@@ -123,9 +240,7 @@ GLint Shader::create_shader(const String& p_path, GLenum ShaderType) {
     GLint infologlength;
     GLint compilestatus;
 
-    TextFile* file = CONTENT->LoadTextFile(p_path);
-
-    String s = file->get_source();
+    String s = get_source(p_path);
 
     if (s == "") {
         T_ERROR("File is empty: " + p_path);
@@ -154,11 +269,14 @@ GLint Shader::create_shader(const String& p_path, GLenum ShaderType) {
     return shader_id;
 }
 
-void Shader::create_program() {
+bool Shader::create_program() {
     GLint linkStatus, infologlength;
     GLchar* infolog;
     program_id = glCreateProgram();
 
+    if (ProgramCache::is_supported())
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     if (compute_id != -1)
         glAttachShader(program_id, compute_id);
     else {
@@ -185,17 +303,18 @@ void Shader::create_program() {
 
         T_ERROR(infolog);
         delete infolog;
-        return;
+        return false;
     } else
-        glUseProgram(program_id);
+        GLSTATE->use_program(program_id);
 
     set_info();
+    return true;
 }
 
 void Shader::bind() {
-    if (isvalid) glUseProgram(program_id);
+    if (isvalid) GLSTATE->use_program(program_id);
 }
-void Shader::unbind() { glUseProgram(0); }
+void Shader::unbind() { GLSTATE->use_program(0); }
 
 bool Shader::has_geometry_shader() { return geometry_path.is_file(); }
 
@@ -206,17 +325,39 @@ bool Shader::has_tesselation_shader() {
 bool Shader::is_compute_shader() { return compute_path.is_file(); }
 
 void Shader::set_info() {
-    Uniform uni;
     GLint count = 0;
+    GLchar name[256];
+    GLsizei length;
+    GLint size;
+    GLenum type;
+
+    // A new program starts with default values, nothing has been uploaded to it yet.
+    for (Uniform& uniform : uniforms) {
+        uniform.location = -1;
+        uniform.value.clear();
+    }
 
     glGetProgramiv(program_id, GL_ACTIVE_UNIFORMS, &count);
 
     for (GLint c = 0; c < count; c++) {
-        glGetActiveUniform(program_id, c, sizeof(uni.name) - 1, &uni.length, &uni.size, &uni.type,
-                           uni.name);
-        uni.location = glGetUniformLocation(program_id, uni.name);
-        uni.index = c;
-        uniforms[uni.name] = uni;
+        glGetActiveUniform(program_id, c, sizeof(name) - 1, &length, &size, &type, name);
+
+        uint32_t hash = UniformName::get_hash(name, length);
+        auto it = uniform_indices.find(hash);
+
+        if (it != uniform_indices.end() && uniforms[it->second].name != name) {
+            T_WARNING("uniform " + String(name) + " has the same hash as " +
+                      uniforms[it->second].name + " in shader: " + get_file());
+            continue;
+        }
+
+        if (it == uniform_indices.end()) {
+            it = uniform_indices.insert({hash, int(uniforms.size())}).first;
+            uniforms.push_back(Uniform());
+            uniforms.back().name = name;
+        }
+
+        uniforms[it->second].location = glGetUniformLocation(program_id, name);
     }
 
     Block block;
@@ -229,106 +370,193 @@ void Shader::set_info() {
         block.location = glGetUniformBlockIndex(program_id, block.name);
         block.index = c;
         blocks[block.name] = block;
+
+        // The shared blocks of Uniforms.glsl have fixed binding points.
+        if (String(block.name) == "FrameData")
+            glUniformBlockBinding(program_id, block.location, UBO::BINDING_FRAME);
+        else if (String(block.name) == "ViewData")
+            glUniformBlockBinding(program_id, block.location, UBO::BINDING_VIEW);
     }
 }
 
-#if 0
-#define CHECK_NAME \
-    if (uniforms[name].count == 0) return;
-#endif
+namespace {
+void upload(GLint p_location, bool p_value) { glUniform1i(p_location, p_value ? 1 : 0); }
+void upload(GLint p_location, int p_value) { glUniform1i(p_location, p_value); }
+void upload(GLint p_location, float p_value) { glUniform1f(p_location, p_value); }
+void upload(GLint p_location, double p_value) { glUniform1f(p_location, float(p_value)); }
 
-#define CHECK_NAME                                                                            \
-    if (!uniforms.contains(name)) {                                                           \
-        T_WARNING("uniform with name: " + name + " does not exist in shader: " + get_file()); \
-        return;                                                                               \
-    }
-
-void Shader::set_uniform(const String& name, bool value) {
-    CHECK_NAME
+void upload(GLint p_location, const vec2& p_value) {
+    glUniform2f(p_location, p_value.x, p_value.y);
+}
 
-    glUniform1i(uniforms[name].location, value ? 1 : 0);
+void upload(GLint p_location, const vec2i& p_value) {
+    glUniform2i(p_location, p_value.x, p_value.y);
 }
 
-void Shader::set_uniform(const String& name, const int value) {
-    CHECK_NAME
+void upload(GLint p_location, const vec3& p_value) {
+    glUniform3f(p_location, p_value.x, p_value.y, p_value.z);
+}
 
-    glUniform1i(uniforms[name].location, value);
+void upload(GLint p_location, const vec3i& p_value) {
+    glUniform3i(p_location, p_value.x, p_value.y, p_value.z);
 }
 
-void Shader::set_uniform(const String& name, const float value) {
-    CHECK_NAME
+void upload(GLint p_location, const vec4& p_value) {
+    glUniform4f(p_location, p_value.x, p_value.y, p_value.z, p_value.w);
+}
 
-    glUniform1f(uniforms[name].location, value);
+void upload(GLint p_location, const vec4i& p_value) {
+    glUniform4i(p_location, p_value.x, p_value.y, p_value.z, p_value.w);
 }
 
-void Shader::set_uniform(const String& name, const double value)  // BETA
-{
-    CHECK_NAME
+void upload(GLint p_location, const Color& p_value) {
+    glUniform4f(p_location, p_value.x, p_value.y, p_value.z, p_value.w);
+}
 
-    glUniform1f(uniforms[name].location, (float)value);
+void upload(GLint p_location, const mat4& p_value) {
+    glUniformMatrix4fv(p_location, 1, false, &p_value.m[0]);
 }
 
-void Shader::set_uniform(const String& name, const vec2& value) {
-    CHECK_NAME
+void upload(GLint p_location, const Array<vec4>& p_value) {
+    glUniform4fv(p_location, p_value.size(), &(&p_value[0])->x);
+}
 
-    glUniform2f(uniforms[name].location, value.x, value.y);
+void upload(GLint p_location, const Array<mat4>& p_value) {
+    glUniformMatrix4fv(p_location, p_value.size(), false, &(&p_value[0])->m[0]);
 }
 
-void Shader::set_uniform(const String& name, const vec2i& value) {
-    CHECK_NAME
+// The bytes compared with the last upload.
+template <typename T>
+const void* get_data(const T& p_value, size_t& r_size) {
+    r_size = sizeof(T);
+    return &p_value;
+}
 
-    glUniform2i(uniforms[name].location, value.x, value.y);
+template <typename T>
+const void* get_data(const Array<T>& p_value, size_t& r_size) {
+    r_size = p_value.size() * sizeof(T);
+    return p_value.size() > 0 ? &p_value[0] : nullptr;
 }
+}  // namespace
 
-void Shader::set_uniform(const String& name, const vec3& value) {
-    CHECK_NAME
+template <typename T>
+void Shader::set_uniform(UniformHandle<T> p_handle,
+                         const typename UniformHandle<T>::Type& p_value) {
+    if (!p_handle.is_valid()) return;
 
-    glUniform3f(uniforms[name].location, value.x, value.y, value.z);
-}
+    Uniform& uniform = uniforms[p_handle.index];
+    if (uniform.location == -1) return;
+
+    size_t size;
+    const void* data = get_data(p_value, size);
 
-void Shader::set_uniform(const String& name, const vec3i& value) {
-    CHECK_NAME
+    if (!update_value(uniform, data, size)) {
+        uniform_stats.skipped++;
+        return;
+    }
 
-    glUniform3i(uniforms[name].location, value.x, value.y, value.z);
+    uniform_stats.uploaded++;
+    upload(uniform.location, p_value);
 }
 
-void Shader::set_uniform(const String& name, const vec4& value) {
-    CHECK_NAME
+template <typename T>
+void Shader::set_uniform(UniformName p_name, const T& p_value) {
+    UniformHandle<T> handle = get_uniform<T>(p_name);
 
-    glUniform4f(uniforms[name].location, value.x, value.y, value.z, value.w);
-}
+    if (!handle.is_valid()) {
+        T_WARNING("uniform with name: " + String(p_name.name) +
+                  " does not exist in shader: " + get_file());
+        return;
+    }
 
-void Shader::set_uniform(const String& name, const vec4i& value) {
-    CHECK_NAME
+    set_uniform(handle, p_value);
+}
 
-    glUniform4i(uniforms[name].location, value.x, value.y, value.z, value.w);
+#define INSTANTIATE_SET_UNIFORM(T)                                                         \
+    template void Shader::set_uniform<T>(UniformHandle<T>, const UniformHandle<T>::Type&); \
+    template void Shader::set_uniform<T>(UniformName, const T&);
+
+INSTANTIATE_SET_UNIFORM(bool)
+INSTANTIATE_SET_UNIFORM(int)
+INSTANTIATE_SET_UNIFORM(float)
+INSTANTIATE_SET_UNIFORM(double)
+INSTANTIATE_SET_UNIFORM(vec2)
+INSTANTIATE_SET_UNIFORM(vec2i)
+INSTANTIATE_SET_UNIFORM(vec3)
+INSTANTIATE_SET_UNIFORM(vec3i)
+INSTANTIATE_SET_UNIFORM(vec4)
+INSTANTIATE_SET_UNIFORM(vec4i)
+INSTANTIATE_SET_UNIFORM(Color)
+INSTANTIATE_SET_UNIFORM(mat4)
+INSTANTIATE_SET_UNIFORM(Array<vec4>)
+INSTANTIATE_SET_UNIFORM(Array<mat4>)
+
+#undef INSTANTIATE_SET_UNIFORM
+
+#define SET_BY_NAME(T)                                                                        \
+    UniformHandle<T> handle = get_uniform<T>(name);                                           \
+    if (!handle.is_valid()) {                                                                 \
+        T_WARNING("uniform with name: " + name + " does not exist in shader: " + get_file()); \
+        return;                                                                               \
+    }                                                                                         \
+    set_uniform(handle, value);
+
+void Shader::set_uniform(const String& name, bool value) { SET_BY_NAME(bool) }
+void Shader::set_uniform(const String& name, const int value) { SET_BY_NAME(int) }
+void Shader::set_uniform(const String& name, const float value) { SET_BY_NAME(float) }
+void Shader::set_uniform(const String& name, const double value) { SET_BY_NAME(double) }
+void Shader::set_uniform(const String& name, const vec2& value) { SET_BY_NAME(vec2) }
+void Shader::set_uniform(const String& name, const vec2i& value) { SET_BY_NAME(vec2i) }
+void Shader::set_uniform(const String& name, const vec3& value) { SET_BY_NAME(vec3) }
+void Shader::set_uniform(const String& name, const vec3i& value) { SET_BY_NAME(vec3i) }
+void Shader::set_uniform(const String& name, const vec4& value) { SET_BY_NAME(vec4) }
+void Shader::set_uniform(const String& name, const vec4i& value) { SET_BY_NAME(vec4i) }
+void Shader::set_uniform(const String& name, const Color& value) { SET_BY_NAME(Color) }
+void Shader::set_uniform(const String& name, const mat4& value) { SET_BY_NAME(mat4) }
+void Shader::set_uniform(const String& name, const Array<vec4>& value) {
+    SET_BY_NAME(Array<vec4>)
 }
-void Shader::set_uniform(const String& name, const Color& value) {
-    CHECK_NAME
 
-    glUniform4f(uniforms[name].location, value.x, value.y, value.z, value.w);
+void Shader::set_uniform(const String& name, const Array<mat4>& value) {
+    SET_BY_NAME(Array<mat4>)
 }
 
-void Shader::set_uniform(const String& name, const mat4& value) {
-    CHECK_NAME
+#undef SET_BY_NAME
 
-    glUniformMatrix4fv(uniforms[name].location, 1, false, &value.m[0]);
+int Shader::find_uniform(const String& p_name) const {
+    auto it = uniform_indices.find(UniformName::get_hash(p_name.c_str(), p_name.size()));
+
+    if (it == uniform_indices.end() || uniforms[it->second].name != p_name) return -1;
+
+    return it->second;
 }
 
-void Shader::set_uniform(const String& name, const Array<vec4>& value) {
-    CHECK_NAME
+int Shader::find_uniform(UniformName p_name) const {
+    auto it = uniform_indices.find(p_name.hash);
 
-    glUniform4fv(uniforms[name].location, value.size(), &(&value[0])->x);
+    return it == uniform_indices.end() ? -1 : it->second;
 }
 
-void Shader::set_uniform(const String& name, const Array<mat4>& value) {
-    CHECK_NAME
+bool Shader::update_value(Uniform& r_uniform, const void* p_data, size_t p_size) {
+    if (r_uniform.value.size() == p_size &&
+        (p_size == 0 || memcmp(r_uniform.value.data(), p_data, p_size) == 0))
+        return false;
+
+    r_uniform.value.resize(p_size);
+    if (p_size > 0) memcpy(r_uniform.value.data(), p_data, p_size);
 
-    glUniformMatrix4fv(uniforms[name].location, value.size(), false, &(&value[0])->m[0]);
+    return true;
 }
 
 void Shader::bind_block(const String& p_var_name, UBO* p_ubo) {
+    block_bindings[p_var_name] = p_ubo;
     glUniformBlockBinding(program_id, blocks[p_var_name].location, p_ubo->get_bound_index());
 }
 
 int Shader::get_program() const { return program_id; }
+
+const Shader::LoadStats& Shader::get_load_stats() { return load_stats; }
+
+const Shader::UniformStats& Shader::get_uniform_stats() { return uniform_stats; }
+
+void Shader::reset_uniform_stats() { uniform_stats = UniformStats(); }
@@ -6,10 +6,48 @@
 #include <GL\glew.h>
 #endif
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "file.h"
 #include "resource.h"
 #include "types/ubo.h"
 
+class ProgramCache;
+
+// The name of a uniform with its hash computed at compile time, written as "name"_uniform.
+struct UniformName {
+    constexpr UniformName(const char* p_name, size_t p_length)
+        : name(p_name), hash(get_hash(p_name, p_length)) {}
+
+    // FNV-1a, computed for the uniforms of a program when it is linked.
+    static constexpr uint32_t get_hash(const char* p_name, size_t p_length) {
+        uint32_t hash = 2166136261u;
+
+        for (size_t c = 0; c < p_length; c++) hash = (hash ^ uint8_t(p_name[c])) * 16777619u;
+
+        return hash;
+    }
+
+    const char* name;
+    uint32_t hash;
+};
+
+constexpr UniformName operator""_uniform(const char* p_name, size_t p_length) {
+    return UniformName(p_name, p_length);
+}
+
+// A uniform of one shader, looked up once. It stays valid when the shader is reloaded.
+template <typename T>
+struct UniformHandle {
+    typedef T Type;
+
+    int index = -1;
+
+    bool is_valid() const { return index != -1; }
+};
+
 class Shader : public Resource {
     OBJ_DEFINITION(Shader, Resource)
 
@@ -18,16 +56,6 @@ class Shader : public Resource {
     Shader(const String& filename);
     virtual ~Shader();
 
-    struct Uniform {
-        GLfloat count;
-        GLuint location;
-        GLuint index;
-        GLint size;
-        GLsizei length;
-        GLchar name[100];
-        GLenum type;
-    };
-
     struct Block {
         GLuint index;
         GLuint location;
@@ -43,6 +71,9 @@ class Shader : public Resource {
     void bind();
     void unbind();
 
+    // True if p_file is pasted in by an #include, directly or through another include.
+    bool depends_on(const File& p_file) const;
+
     bool has_geometry_shader();
     bool has_tesselation_shader();
     bool is_compute_shader();
@@ -62,16 +93,69 @@ class Shader : public Resource {
     void set_uniform(const String& name, const Array<vec4>& value);
     void set_uniform(const String& name, const Array<mat4>& value);
 
+    // Returns an invalid handle if the program has no uniform with the name, setting it does
+    // nothing then.
+    template <typename T>
+    UniformHandle<T> get_uniform(const String& p_name) const;
+    template <typename T>
+    UniformHandle<T> get_uniform(UniformName p_name) const;
+
+    // Values equal to the last one uploaded to this program are skipped. Defined for the types of
+    // the set_uniform overloads above.
+    template <typename T>
+    void set_uniform(UniformHandle<T> p_handle, const typename UniformHandle<T>::Type& p_value);
+    template <typename T>
+    void set_uniform(UniformName p_name, const T& p_value);
+
     void bind_block(const String& p_var_name, UBO* p_ubo);
 
     int get_program() const;
 
+    struct LoadStats {
+        int compiled = 0;
+        int cached = 0;
+        float compile_time = 0.0f;
+        float cache_time = 0.0f;
+    };
+
+    // Programs compiled from source and loaded from the program cache since startup.
+    static const LoadStats& get_load_stats();
+
+    struct UniformStats {
+        int uploaded = 0;
+        int skipped = 0;
+    };
+
+    // Uniform values uploaded and skipped as unchanged since the last reset.
+    static const UniformStats& get_uniform_stats();
+    static void reset_uniform_stats();
+
    private:
+    struct Uniform {
+        String name;
+        GLint location = -1;
+
+        // Of the last upload to the current program, empty before the first.
+        std::vector<unsigned char> value;
+    };
+
+    // Loads the source of a stage with the files named by #include "file" lines pasted in.
+    String get_source(const File& p_path, int p_depth = 0);
+
     GLint create_shader(const String& p_path, GLenum ShaderType);
-    void create_program();
+    bool create_program();
+
+    // Adds the sources of all stages to the key of a program cache entry.
+    bool add_sources(ProgramCache& p_cache);
 
     void set_info();
 
+    int find_uniform(const String& p_name) const;
+    int find_uniform(UniformName p_name) const;
+
+    // Returns false if the value equals the last upload to the uniform, stores it otherwise.
+    static bool update_value(Uniform& r_uniform, const void* p_data, size_t p_size);
+
     int program_id;
     int vertexshader_id;
     int fragmentshader_id;
@@ -82,13 +166,41 @@ class Shader : public Resource {
 
     bool isvalid = false;
 
-    Dictionary<String, Uniform> uniforms;
+    // Uniforms keep their index over reloads, uniforms the new program lacks get no location.
+    std::vector<Uniform> uniforms;
+    std::unordered_map<uint32_t, int> uniform_indices;
+
     Dictionary<String, Block> blocks;
 
+    // Restored when the program is linked again on reload.
+    Dictionary<String, UBO*> block_bindings;
+
     File vertex_path;
     File fragment_path;
     File geometry_path;
     File tess_control_path;
     File tess_evaluation_path;
     File compute_path;
+
+    // Files pasted in by #include, freed with the stages.
+    Array<File> includes;
+
+    static LoadStats load_stats;
+    static UniformStats uniform_stats;
 };
+
+template <typename T>
+UniformHandle<T> Shader::get_uniform(const String& p_name) const {
+    UniformHandle<T> handle;
+    handle.index = find_uniform(p_name);
+
+    return handle;
+}
+
+template <typename T>
+UniformHandle<T> Shader::get_uniform(UniformName p_name) const {
+    UniformHandle<T> handle;
+    handle.index = find_uniform(p_name);
+
+    return handle;
+}
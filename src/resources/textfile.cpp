@@ -4,26 +4,13 @@
 #include <iostream>
 #include <string>
 
+#include "resources/mappedfile.h"
+
 TextFile::TextFile(const File& p_file) { load(p_file); }
 
 String TextFile::load(const File& p_file) {
     file = p_file;
-
-    std::string line;
-    String src;
-    std::ifstream myfile(file.get_absolute_path());
-
-    if (!myfile.is_open()) {
-        T_ERROR("Error loading file: " + file.get_relative_path());
-        source = "";
-        return source;
-    }
-
-    while (std::getline(myfile, line)) src.append(line + String("\n"));
-
-    myfile.close();
-
-    source = src;
+    load();
 
     return source;
 }
@@ -41,17 +28,22 @@ void TextFile::write(const String& p_source) {
 }
 
 void TextFile::load() {
-    std::string line;
-    String src;
-    std::ifstream myfile(file.get_absolute_path());
+    source = "";
+    revision++;
 
-    if (!myfile.is_open()) T_ERROR("Error loading file: " + file.get_relative_path());
+    if (!file.is_file()) {
+        T_ERROR("Error loading file: " + file.get_relative_path());
+        return;
+    }
 
-    while (std::getline(myfile, line)) src.append(line + String("\n"));
+    // Empty files can not be mapped.
+    MappedFile mapped;
+    if (!mapped.open(file)) return;
 
-    myfile.close();
+    source = std::string(mapped.get_data(), mapped.get_size());
 
-    source = src;
+    // Every line ends with a newline, including the last one.
+    if (source.size() > 0 && source[source.size() - 1] != '\n') source += "\n";
 }
 
 void TextFile::save() {
@@ -66,4 +58,10 @@ void TextFile::save() {
     myfile.close();
 }
 
+void TextFile::reload() { load(); }
+
 String TextFile::get_source() const { return source; }
+
+unsigned TextFile::get_revision() const { return revision; }
+
+size_t TextFile::get_cpu_size() const { return source.size(); }
@@ -13,9 +13,16 @@ class TextFile : public Resource {
 
     void load() override;
     void save() override;
+    void reload() override;
 
     String get_source() const;
 
+    // Incremented every time the source is read, so users can tell when it changed.
+    unsigned get_revision() const;
+
+    size_t get_cpu_size() const override;
+
    private:
     String source;
+    unsigned revision = 0;
 };
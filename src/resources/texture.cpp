@@ -1,7 +1,14 @@
 #include "texture.h"
 
 #include "assimp/texture.h"
+#include "graphics/glstate.h"
 #include "graphics/renderer.h"
+#include "resources/texturecache.h"
+#include "resources/virtualfilesystem.h"
+
+namespace {
+unsigned generations = 0;
+}  // namespace
 
 //=========================================================================
 // Texture
@@ -9,7 +16,8 @@
 
 void Texture::generate_gl_texture() {
     glGenTextures(1, &id);
-    glBindTexture(type, id);
+    generation = ++generations;
+    GLSTATE->bind_texture(type, id);
     set_filter(NO_FILTER);
     glTexParameteri(type, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(type, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -17,19 +25,20 @@ void Texture::generate_gl_texture() {
     loaded = true;
 }
 
-Texture::~Texture() { glDeleteTextures(1, &id); }
+Texture::~Texture() { GLSTATE->delete_texture(id); }
 
 void Texture::bind(int p_unit) {
-    if (!loaded) return;
+    if (!loaded) {
+        if (placeholder) placeholder->bind(p_unit);
+        return;
+    }
 
-    glActiveTexture(GL_TEXTURE0 + p_unit);
-    glBindTexture(type, id);
+    GLSTATE->bind_texture(p_unit, type, id);
 }
 void Texture::unbind(int p_unit) {
     if (!loaded) return;
 
-    glActiveTexture(GL_TEXTURE0 + p_unit);
-    glBindTexture(type, 0);
+    GLSTATE->bind_texture(p_unit, type, 0);
 }
 
 void Texture::set_filter(FilterType p_filter_type) {
@@ -52,7 +61,9 @@ void Texture::set_filter(FilterType p_filter_type) {
 
             glTexParameteri(type, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
             glTexParameteri(type, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glGenerateMipmap(type);
+
+            // Cooked textures come with their mip chain.
+            if (!mipmapped) glGenerateMipmap(type);
             break;
     }
 }
@@ -64,6 +75,12 @@ void Texture::set_shadow_parameters() {
 
 unsigned Texture::get_id() const { return id; }
 
+unsigned Texture::get_generation() const { return generation; }
+
+void Texture::set_placeholder(Texture* p_placeholder) { placeholder = p_placeholder; }
+
+bool Texture::is_ready() const { return loaded; }
+
 #undef CLASSNAME
 #define CLASSNAME Texture
 
@@ -107,11 +124,23 @@ Texture2D::Texture2D(const vec2& p_size, bool p_byte = true) : Texture2D() {
 }
 
 Texture2D::Texture2D(const String& p_filepath) : Texture2D() {
-    String path = File(p_filepath).get_absolute_path();
-    SDL_Surface* image = IMG_Load(path.c_str());
+    TextureCache cache(p_filepath);
+
+    if (cache.prepare() && cache.upload(this)) return;
+
+    upload(p_filepath, decode(p_filepath));
+}
+
+Texture2D::Texture2D(const String& p_filepath, SDL_Surface* p_image) : Texture2D() {
+    upload(p_filepath, p_image);
+}
+
+void Texture2D::upload(const String& p_filepath, SDL_Surface* p_image) {
+    SDL_Surface* image = p_image;
 
     if (!image) {
-        T_ERROR("Failed to load Image: " + path + ", reason: " + IMG_GetError());
+        T_ERROR("Failed to load Image: " + File(p_filepath).get_absolute_path() +
+                ", reason: " + IMG_GetError());
         return;
     }
 
@@ -126,9 +155,13 @@ Texture2D::Texture2D(const String& p_filepath) : Texture2D() {
     SDL_FreeSurface(image);
 }
 
+SDL_Surface* Texture2D::decode(const String& p_filepath) {
+    return IMG_Load_RW(VFS->open_rw(p_filepath), 1);
+}
+
 Texture2D::Texture2D(const String& p_filepath, const vec2i& p_size, const Color& p_color)
     : Texture2D() {
-    SDL_Surface* image = IMG_Load((p_filepath).c_str());
+    SDL_Surface* image = IMG_Load_RW(VFS->open_rw(p_filepath), 1);
 
     if (!image) {
         T_ERROR("Failed to load svg: " + p_filepath + ", reason: " + IMG_GetError());
@@ -200,6 +233,38 @@ Texture2D::Texture2D(aiTexture* p_texture) : Texture2D() {
 
 vec2 Texture2D::get_size() const { return size; }
 
+size_t Texture2D::get_gpu_size() const {
+    if (!loaded) return 0;
+
+    return gpu_size ? gpu_size : size_t(size.x) * size_t(size.y) * 4;
+}
+
+void Texture2D::reload() {
+    // Decode first, so the old image stays if the file can not be read.
+    TextureCache cache(file);
+    bool cooked = cache.prepare();
+    SDL_Surface* image = cooked ? nullptr : decode(file);
+
+    if (!cooked && !image) {
+        T_ERROR("Failed to reload Image: " + file.get_relative_path() + ", reason: " +
+                IMG_GetError());
+        return;
+    }
+
+    FilterType filter = loaded ? filter_type : NO_FILTER;
+
+    if (loaded) GLSTATE->delete_texture(id);
+
+    loaded = false;
+    mipmapped = false;
+    gpu_size = 0;
+
+    if (!cooked || !cache.upload(this)) upload(file, image ? image : decode(file));
+
+    // The new texture is still bound after the upload.
+    if (loaded) set_filter(filter);
+}
+
 #undef CLASSNAME
 #define CLASSNAME Texture2D
 
@@ -222,7 +287,7 @@ void Texture1D::bind_methods() {}
 //=========================================================================
 
 RawTexture2D::RawTexture2D(const String& p_filepath) {
-    surface = IMG_Load((p_filepath).c_str());
+    surface = IMG_Load_RW(VFS->open_rw(p_filepath), 1);
 
     if (!surface) {
         T_ERROR("Failed to load Image: " + p_filepath);
@@ -255,7 +320,7 @@ DepthTexture2D::DepthTexture2D(const vec2i& p_size) {
     loaded = true;
 
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
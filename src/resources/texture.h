@@ -51,6 +51,15 @@ class Texture : public Resource {
 
     unsigned get_id() const;
 
+    // Changes whenever a new GL texture is created for this texture, so copies of its data can
+    // tell that they are stale. Zero for textures wrapping a GL texture created elsewhere.
+    unsigned get_generation() const;
+
+    // Bound instead of this texture while its data is still being loaded.
+    void set_placeholder(Texture* p_placeholder);
+
+    bool is_ready() const override;
+
     inline Texture2D* cast_to_texture_2d() {
         if (derives_from_type<Texture2D*>()) return reinterpret_cast<Texture2D*>(this);
 
@@ -63,7 +72,10 @@ class Texture : public Resource {
     void generate_gl_texture();
 
     bool loaded = false;
+    bool mipmapped = false;
+    Texture* placeholder = nullptr;
     GLuint id;
+    unsigned generation = 0;
     FilterType filter_type;
     int type;
 };
@@ -86,6 +98,9 @@ class Texture3D : public Texture {
 class Texture2D : public Texture {
     OBJ_DEFINITION(Texture2D, Texture)
 
+    friend class TextureCache;
+    friend class ThumbnailCache;
+
    public:
     Texture2D() : Texture(GL_TEXTURE_2D) {}
     Texture2D(const vec2& p_size, bool p_byte);
@@ -93,16 +108,31 @@ class Texture2D : public Texture {
         : Texture2D(vec2(to_float(p_size.x), to_float(p_size.y)), p_byte) {}
     Texture2D(const vec2& p_size, int p_index);
     Texture2D(const String& p_filepath);
+    Texture2D(const String& p_filepath, SDL_Surface* p_image);
     Texture2D(const String& p_filepath, const vec2i& p_size, const Color& p_color);
     Texture2D(SDL_Surface* p_surface);
     Texture2D(aiTexture* p_texture);
 
     vec2 get_size() const;
 
+    size_t get_gpu_size() const override;
+
+    // Replaces the GL texture with the current contents of the file, keeping the filter.
+    void reload() override;
+
+    // Uploads a decoded image and frees it, must be called on the render thread.
+    void upload(const String& p_filepath, SDL_Surface* p_image);
+
+    // Decodes an image file without touching GL, so it can run on a worker thread.
+    static SDL_Surface* decode(const String& p_filepath);
+
     static void bind_methods();
 
    protected:
     vec2 size;
+
+    // Set when the uploaded size differs from four bytes per pixel, e.g. for cooked textures.
+    size_t gpu_size = 0;
 };
 
 class Texture1D : public Texture {
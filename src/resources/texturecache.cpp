@@ -0,0 +1,358 @@
+#include "texturecache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "resources/assetcache.h"
+#include "resources/texture.h"
+
+namespace {
+const char MAGIC[4] = {'T', 'T', 'E', 'X'};
+
+const size_t BLOB_ALIGNMENT = 16;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t level_count;
+};
+
+struct LevelHeader {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct Image {
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+};
+
+size_t align(size_t p_value) { return (p_value + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1); }
+
+// Halves the image with a box filter, odd edges repeat the last row or column.
+Image downsample(const Image& p_image) {
+    Image result;
+    result.width = MAX(p_image.width / 2, 1);
+    result.height = MAX(p_image.height / 2, 1);
+    result.pixels.resize(size_t(result.width) * result.height * 4);
+
+    for (int y = 0; y < result.height; y++) {
+        int y0 = MIN(y * 2, p_image.height - 1);
+        int y1 = MIN(y * 2 + 1, p_image.height - 1);
+
+        for (int x = 0; x < result.width; x++) {
+            int x0 = MIN(x * 2, p_image.width - 1);
+            int x1 = MIN(x * 2 + 1, p_image.width - 1);
+
+            const uint8_t* a = &p_image.pixels[(size_t(y0) * p_image.width + x0) * 4];
+            const uint8_t* b = &p_image.pixels[(size_t(y0) * p_image.width + x1) * 4];
+            const uint8_t* c = &p_image.pixels[(size_t(y1) * p_image.width + x0) * 4];
+            const uint8_t* d = &p_image.pixels[(size_t(y1) * p_image.width + x1) * 4];
+            uint8_t* out = &result.pixels[(size_t(y) * result.width + x) * 4];
+
+            for (int i = 0; i < 4; i++) out[i] = (a[i] + b[i] + c[i] + d[i] + 2) / 4;
+        }
+    }
+
+    return result;
+}
+
+uint16_t to_565(const uint8_t* p_color) {
+    return ((p_color[0] >> 3) << 11) | ((p_color[1] >> 2) << 5) | (p_color[2] >> 3);
+}
+
+void from_565(uint16_t p_color, int* r_color) {
+    r_color[0] = ((p_color >> 11) & 31) * 255 / 31;
+    r_color[1] = ((p_color >> 5) & 63) * 255 / 63;
+    r_color[2] = (p_color & 31) * 255 / 31;
+}
+
+// Compresses one 4x4 block, the endpoints are the corners of the block's bounding box.
+void encode_bc1_block(const uint8_t p_block[16][4], uint8_t* r_output) {
+    uint8_t low[3] = {255, 255, 255};
+    uint8_t high[3] = {0, 0, 0};
+
+    for (int p = 0; p < 16; p++) {
+        for (int i = 0; i < 3; i++) {
+            low[i] = MIN(low[i], p_block[p][i]);
+            high[i] = MAX(high[i], p_block[p][i]);
+        }
+    }
+
+    uint16_t color0 = to_565(high);
+    uint16_t color1 = to_565(low);
+    uint32_t indices = 0;
+
+    // Equal endpoints would select the three color mode, every pixel uses color0 instead.
+    if (color0 != color1) {
+        if (color0 < color1) std::swap(color0, color1);
+
+        int palette[4][3];
+        from_565(color0, palette[0]);
+        from_565(color1, palette[1]);
+
+        for (int i = 0; i < 3; i++) {
+            palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+        }
+
+        for (int p = 0; p < 16; p++) {
+            int best = 0;
+            int best_distance = INT32_MAX;
+
+            for (int e = 0; e < 4; e++) {
+                int distance = 0;
+
+                for (int i = 0; i < 3; i++) {
+                    int delta = p_block[p][i] - palette[e][i];
+                    distance += delta * delta;
+                }
+
+                if (distance < best_distance) {
+                    best = e;
+                    best_distance = distance;
+                }
+            }
+
+            indices |= uint32_t(best) << (p * 2);
+        }
+    }
+
+    memcpy(r_output, &color0, 2);
+    memcpy(r_output + 2, &color1, 2);
+    memcpy(r_output + 4, &indices, 4);
+}
+
+std::vector<uint8_t> encode_bc1(const Image& p_image) {
+    int blocks_x = (p_image.width + 3) / 4;
+    int blocks_y = (p_image.height + 3) / 4;
+
+    std::vector<uint8_t> result(size_t(blocks_x) * blocks_y * 8);
+    uint8_t block[16][4];
+
+    for (int by = 0; by < blocks_y; by++) {
+        for (int bx = 0; bx < blocks_x; bx++) {
+            for (int p = 0; p < 16; p++) {
+                int x = MIN(bx * 4 + p % 4, p_image.width - 1);
+                int y = MIN(by * 4 + p / 4, p_image.height - 1);
+
+                memcpy(block[p], &p_image.pixels[(size_t(y) * p_image.width + x) * 4], 4);
+            }
+
+            encode_bc1_block(block, &result[(size_t(by) * blocks_x + bx) * 8]);
+        }
+    }
+
+    return result;
+}
+
+bool is_opaque(const Image& p_image) {
+    for (size_t c = 3; c < p_image.pixels.size(); c += 4)
+        if (p_image.pixels[c] != 255) return false;
+
+    return true;
+}
+}  // namespace
+
+TextureCache::TextureCache(const File& p_source) {
+    source = p_source;
+    key = 0;
+    hashed = false;
+    format = RGBA8;
+}
+
+bool TextureCache::open() {
+    uint64_t k = get_key();
+    if (!k) return false;
+
+    entry = AssetCache::get_file("textures", k, "ttex");
+
+    if (!entry.is_file() || !mapped.open(entry)) return false;
+
+    if (!parse()) {
+        T_WARNING("Ignoring corrupt texture cache entry: " + entry.get_absolute_path());
+        mapped.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool TextureCache::is_open() const { return mapped.is_open(); }
+
+bool TextureCache::cook(bool p_compress) {
+    uint64_t k = get_key();
+    if (!k) return false;
+
+    SDL_Surface* decoded = Texture2D::decode(source);
+    if (!decoded) {
+        T_ERROR("Failed to load Image: " + source.get_absolute_path() +
+                ", reason: " + IMG_GetError());
+        return false;
+    }
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(decoded);
+
+    if (!converted) {
+        T_ERROR("Failed to convert Image: " + source.get_absolute_path() +
+                ", reason: " + SDL_GetError());
+        return false;
+    }
+
+    Image image;
+    image.width = converted->w;
+    image.height = converted->h;
+    image.pixels.resize(size_t(image.width) * image.height * 4);
+
+    for (int y = 0; y < image.height; y++)
+        memcpy(&image.pixels[size_t(y) * image.width * 4],
+               static_cast<uint8_t*>(converted->pixels) + size_t(y) * converted->pitch,
+               size_t(image.width) * 4);
+
+    SDL_FreeSurface(converted);
+
+    Format cooked_format = p_compress && is_opaque(image) ? BC1 : RGBA8;
+
+    std::vector<std::vector<uint8_t>> blobs;
+    std::vector<LevelHeader> level_headers;
+
+    while (true) {
+        if (cooked_format == BC1)
+            blobs.push_back(encode_bc1(image));
+        else
+            blobs.push_back(image.pixels);
+
+        level_headers.push_back({uint32_t(image.width), uint32_t(image.height), 0,
+                                 blobs.back().size()});
+
+        if (image.width == 1 && image.height == 1) break;
+
+        image = downsample(image);
+    }
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = k;
+    header.format = cooked_format;
+    header.level_count = level_headers.size();
+
+    size_t offset = align(sizeof(Header) + level_headers.size() * sizeof(LevelHeader));
+
+    for (LevelHeader& level : level_headers) {
+        level.offset = offset;
+        offset = align(offset + level.size);
+    }
+
+    std::vector<char> buffer(offset, 0);
+    memcpy(buffer.data(), &header, sizeof(Header));
+    memcpy(buffer.data() + sizeof(Header), level_headers.data(),
+           level_headers.size() * sizeof(LevelHeader));
+
+    for (size_t c = 0; c < blobs.size(); c++)
+        memcpy(buffer.data() + level_headers[c].offset, blobs[c].data(), blobs[c].size());
+
+    mapped.close();
+    entry = AssetCache::get_file("textures", k, "ttex");
+
+    return AssetCache::write(entry, buffer.data(), buffer.size());
+}
+
+bool TextureCache::prepare() {
+    if (open()) return true;
+
+    return cook() && open();
+}
+
+bool TextureCache::upload(Texture2D* p_texture) {
+    if (!is_open()) return false;
+
+    if (format == BC1 && !GLEW_EXT_texture_compression_s3tc) return false;
+
+    p_texture->generate_gl_texture();
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels.size() - 1);
+
+    size_t gpu_size = 0;
+
+    for (int c = 0; c < levels.size(); c++) {
+        const Level& level = levels[c];
+
+        if (format == BC1)
+            glCompressedTexImage2D(GL_TEXTURE_2D, c, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width,
+                                   level.height, 0, level.size, level.data);
+        else
+            glTexImage2D(GL_TEXTURE_2D, c, GL_RGBA, level.width, level.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, level.data);
+
+        gpu_size += level.size;
+    }
+
+    p_texture->size = vec2(to_float(levels[0].width), to_float(levels[0].height));
+    p_texture->gpu_size = gpu_size;
+    p_texture->mipmapped = true;
+
+    // The pixels live in the GL texture now.
+    mapped.close();
+    levels.clear();
+
+    return true;
+}
+
+TextureCache::Format TextureCache::get_format() const { return format; }
+
+int TextureCache::get_level_count() const { return levels.size(); }
+
+bool TextureCache::is_supported(const File& p_file) {
+    String extension = p_file.get_extension();
+
+    return extension == "png" || extension == "jpg" || extension == "jpeg" ||
+           extension == "bmp" || extension == "tga";
+}
+
+bool TextureCache::parse() {
+    const char* data = mapped.get_data();
+    size_t size = mapped.get_size();
+
+    if (size < sizeof(Header)) return false;
+
+    Header header;
+    memcpy(&header, data, sizeof(Header));
+
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.key != key || header.format > BC1 || header.level_count == 0)
+        return false;
+
+    if (sizeof(Header) + size_t(header.level_count) * sizeof(LevelHeader) > size) return false;
+
+    format = Format(header.format);
+    levels.clear();
+
+    for (uint32_t c = 0; c < header.level_count; c++) {
+        LevelHeader level;
+        memcpy(&level, data + sizeof(Header) + c * sizeof(LevelHeader), sizeof(LevelHeader));
+
+        if (level.offset > size || level.size > size - level.offset) return false;
+
+        levels.push_back({level.width, level.height, data + level.offset, size_t(level.size)});
+    }
+
+    return true;
+}
+
+uint64_t TextureCache::get_key() {
+    if (hashed) return key;
+
+    uint32_t version = VERSION;
+
+    key = AssetCache::hash_file(source, AssetCache::hash(&version, sizeof(version)));
+    hashed = true;
+
+    return key;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "resources/mappedfile.h"
+
+class Texture2D;
+
+// Cooked textures: decoded pixels with a prebuilt mip chain, optionally block compressed.
+//
+// Images are cooked on first use or ahead of time with titan_cook, and stored in the asset cache
+// keyed by the contents of the source image. Loading a cooked texture maps the entry and uploads
+// every level as is, instead of decoding the image and generating mipmaps on the driver.
+class TextureCache {
+   public:
+    enum Format {
+        RGBA8,
+        BC1,
+    };
+
+    TextureCache(const File& p_source);
+
+    // Hashes the source and maps a matching entry. Does not touch GL, so it can run on a worker.
+    bool open();
+    bool is_open() const;
+
+    // Decodes the source and writes an entry. BC1 is only used for fully opaque images.
+    bool cook(bool p_compress = false);
+
+    // Opens the entry, cooking it first when there is none yet.
+    bool prepare();
+
+    // Must run on the render thread. Fails when the format is not supported by the driver, in
+    // that case the source has to be decoded instead.
+    bool upload(Texture2D* p_texture);
+
+    Format get_format() const;
+    int get_level_count() const;
+
+    static bool is_supported(const File& p_file);
+
+    static const uint32_t VERSION = 1;
+
+   private:
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+
+        const char* data;
+        size_t size;
+    };
+
+    bool parse();
+    uint64_t get_key();
+
+    File source;
+    File entry;
+
+    uint64_t key;
+    bool hashed;
+
+    MappedFile mapped;
+
+    Format format;
+    Array<Level> levels;
+};
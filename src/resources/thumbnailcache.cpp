@@ -0,0 +1,322 @@
+#include "thumbnailcache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+
+#include "core/contentmanager.h"
+#include "core/threadpool.h"
+#include "graphics/fbo.h"
+#include "graphics/glstate.h"
+#include "graphics/uniformblocks.h"
+#include "resources/assetcache.h"
+#include "resources/mappedfile.h"
+#include "resources/texturecache.h"
+#include "world/mesh.h"
+#include "world/meshcache.h"
+
+namespace {
+const char MAGIC[4] = {'T', 'T', 'H', 'M'};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t width;
+    uint32_t height;
+};
+}  // namespace
+
+ThumbnailCache* ThumbnailCache::singleton;
+
+ThumbnailCache::ThumbnailCache() { fbo = nullptr; }
+
+ThumbnailCache* ThumbnailCache::get_singleton() {
+    // Created on first use, only the editor browses content.
+    if (!singleton) singleton = new ThumbnailCache;
+
+    return singleton;
+}
+
+Texture2D* ThumbnailCache::get_thumbnail(const File& p_file) {
+    if (!has_preview(p_file)) return nullptr;
+
+    std::string path = p_file.get_absolute_path().c_str();
+    uint64_t key = get_key(p_file);
+
+    auto it = thumbnails.find(path);
+
+    if (it != thumbnails.end()) {
+        Thumbnail& thumbnail = it->second;
+
+        // The source changed since the thumbnail was made.
+        if (thumbnail.key != key) {
+            thumbnail.key = key;
+            generate(thumbnail.texture, p_file, key);
+        }
+
+        return thumbnail.texture;
+    }
+
+    Texture2D* texture = new Texture2D;
+    texture->set_file(p_file);
+    texture->set_placeholder(CONTENT->get_placeholder_texture());
+
+    // Tiles are laid out before the thumbnail is known.
+    texture->size = vec2(to_float(SIZE));
+
+    thumbnails[path] = {texture, key};
+    generate(texture, p_file, key);
+
+    return texture;
+}
+
+bool ThumbnailCache::has_preview(const File& p_file) {
+    return TextureCache::is_supported(p_file) || CONTENT->GetType(p_file).is_of_type<Mesh>();
+}
+
+void ThumbnailCache::generate(Texture2D* p_texture, const File& p_file, uint64_t p_key) {
+    File entry = AssetCache::get_file("thumbnails", p_key, "tthm");
+    bool is_mesh = !TextureCache::is_supported(p_file);
+
+    CONTENT->pending_count++;
+
+    THREADPOOL->add_task([this, p_texture, p_file, p_key, entry, is_mesh]() {
+        std::shared_ptr<Image> image = std::make_shared<Image>();
+
+        if (read(entry, p_key, *image)) {
+            CONTENT->queue_upload([p_texture, image]() { upload(p_texture, *image); });
+            return;
+        }
+
+        if (!is_mesh) {
+            if (scale(Texture2D::decode(p_file), *image)) write(entry, p_key, *image);
+
+            CONTENT->queue_upload([p_texture, image]() { upload(p_texture, *image); });
+            return;
+        }
+
+        // Meshes are imported here and rendered on the render thread.
+        std::shared_ptr<MeshCache> cache = std::make_shared<MeshCache>(p_file);
+        std::shared_ptr<Assimp::Importer> importer = std::make_shared<Assimp::Importer>();
+        const aiScene* scene = cache->open() ? nullptr : Mesh::read(*importer, p_file);
+
+        CONTENT->queue_upload([this, p_texture, p_file, p_key, entry, image, cache, importer,
+                               scene]() {
+            Mesh* mesh = new Mesh;
+            mesh->set_file(p_file);
+
+            bool built = cache->is_open() ? cache->build(mesh) : scene && mesh->build(scene);
+
+            if (built) {
+                if (scene) cache->save(mesh, *importer);
+
+                render(mesh, *image);
+                upload(p_texture, *image);
+
+                // The readback is small, the write can still wait for a worker.
+                THREADPOOL->add_task([entry, p_key, image]() { write(entry, p_key, *image); });
+            } else if (!cache->is_open()) {
+                T_ERROR(importer->GetErrorString());
+            }
+
+            delete mesh;
+        });
+    });
+}
+
+void ThumbnailCache::render(Mesh* p_mesh, Image& r_image) {
+    if (!fbo) {
+        fbo = new FBO2D(vec2i(SIZE));
+        fbo->add_color_texture();
+        fbo->add_depth_texture();
+        fbo->init();
+        fbo->clear_color = Color(0.0f, 0.0f, 0.0f, 0.0f);
+        fbo->cleared_every_frame = false;
+    }
+
+    BoundingBox box = p_mesh->get_bounding_box();
+    vec3 center = (box.min + box.max) / 2.0f;
+    float radius = MAX((box.max - box.min).length() / 2.0f, 0.001f);
+
+    // Camera conventions: looking along +y with -z up, the mesh is seen from above and aside.
+    vec3 direction = vec3(0.6f, -1.0f, -0.7f).normalize();
+
+    mat4 projection, view;
+    projection.perspective(rect2(), 40.0f, 1.0f, radius * 0.5f, radius * 6.0f);
+    view.look_at(center + direction * radius * 3.0f, center, vec3(0, 0, -1));
+
+    GLboolean depth_test = GLSTATE->is_enabled(GL_DEPTH_TEST);
+    GLSTATE->set_enabled(GL_DEPTH_TEST, true);
+
+    fbo->bind();
+    fbo->clear();
+
+    // The shader reads the view from the shared block, the pass that was drawing gets it back.
+    ViewData previous = UNIFORM_BLOCKS->get_view();
+    ViewData thumbnail = previous;
+    thumbnail.view = projection * view;
+    thumbnail.view_matrix = view;
+    thumbnail.projection_matrix = projection;
+    thumbnail.camera_position = vec4(center + direction * radius * 3.0f, 1.0f);
+    UNIFORM_BLOCKS->set_view(thumbnail);
+
+    Shader* shader = CONTENT->LoadShader("engine/shaders/Shader3D");
+    shader->bind();
+    shader->set_uniform("model", mat4());
+    shader->set_uniform("color_id", vec3());
+    shader->set_uniform("color", Color::White);
+
+    p_mesh->draw();
+
+    UNIFORM_BLOCKS->set_view(previous);
+
+    r_image.width = SIZE;
+    r_image.height = SIZE;
+    r_image.pixels.resize(SIZE * SIZE * 4);
+
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, r_image.pixels.data());
+    glReadBuffer(GL_NONE);
+
+    fbo->unbind();
+
+    if (!depth_test) GLSTATE->set_enabled(GL_DEPTH_TEST, false);
+
+    // GL reads bottom-up, images are stored top-down.
+    int pitch = SIZE * 4;
+    std::vector<unsigned char> row(pitch);
+
+    for (int y = 0; y < SIZE / 2; y++) {
+        unsigned char* top = r_image.pixels.data() + y * pitch;
+        unsigned char* bottom = r_image.pixels.data() + (SIZE - 1 - y) * pitch;
+
+        memcpy(row.data(), top, pitch);
+        memcpy(top, bottom, pitch);
+        memcpy(bottom, row.data(), pitch);
+    }
+}
+
+uint64_t ThumbnailCache::get_key(const File& p_file) {
+    String path = p_file.get_relative_path();
+    uint32_t version = VERSION;
+
+    uint64_t key = AssetCache::hash(&version, sizeof(version));
+    key = AssetCache::hash(path.c_str(), path.size(), key);
+
+    // Archived files only change along with the archive, they are keyed by their path.
+    if (!p_file.is_loose_file()) return key;
+
+    std::error_code error;
+    std::filesystem::path source = p_file.get_absolute_path().c_str();
+
+    int64_t modified = std::filesystem::last_write_time(source, error).time_since_epoch().count();
+    uint64_t size = std::filesystem::file_size(source, error);
+
+    key = AssetCache::hash(&modified, sizeof(modified), key);
+    return AssetCache::hash(&size, sizeof(size), key);
+}
+
+bool ThumbnailCache::read(const File& p_entry, uint64_t p_key, Image& r_image) {
+    MappedFile mapped;
+    if (!p_entry.is_file() || !mapped.open(p_entry)) return false;
+
+    Header header;
+    if (mapped.get_size() < sizeof(Header)) return false;
+
+    memcpy(&header, mapped.get_data(), sizeof(Header));
+
+    size_t size = size_t(header.width) * size_t(header.height) * 4;
+
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.key != p_key || sizeof(Header) + size != mapped.get_size())
+        return false;
+
+    r_image.width = header.width;
+    r_image.height = header.height;
+    r_image.pixels.assign(mapped.get_data() + sizeof(Header),
+                          mapped.get_data() + sizeof(Header) + size);
+
+    return true;
+}
+
+bool ThumbnailCache::write(const File& p_entry, uint64_t p_key, const Image& p_image) {
+    if (p_image.pixels.empty()) return false;
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = p_key;
+    header.width = p_image.width;
+    header.height = p_image.height;
+
+    std::vector<char> buffer(sizeof(Header) + p_image.pixels.size());
+    memcpy(buffer.data(), &header, sizeof(Header));
+    memcpy(buffer.data() + sizeof(Header), p_image.pixels.data(), p_image.pixels.size());
+
+    return AssetCache::write(p_entry, buffer.data(), buffer.size());
+}
+
+bool ThumbnailCache::scale(SDL_Surface* p_surface, Image& r_image) {
+    if (!p_surface) return false;
+
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(p_surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(p_surface);
+
+    if (!surface) return false;
+
+    int width = surface->w;
+    int height = surface->h;
+    float factor = MAX(1.0f, to_float(MAX(width, height)) / to_float(SIZE));
+
+    r_image.width = MAX(1, to_int(width / factor));
+    r_image.height = MAX(1, to_int(height / factor));
+    r_image.pixels.resize(size_t(r_image.width) * r_image.height * 4);
+
+    // Every target pixel is the average of the source pixels it covers.
+    for (int y = 0; y < r_image.height; y++) {
+        int y0 = y * height / r_image.height;
+        int y1 = MAX(y0 + 1, (y + 1) * height / r_image.height);
+
+        for (int x = 0; x < r_image.width; x++) {
+            int x0 = x * width / r_image.width;
+            int x1 = MAX(x0 + 1, (x + 1) * width / r_image.width);
+
+            unsigned sum[4] = {0, 0, 0, 0};
+
+            for (int sy = y0; sy < y1; sy++) {
+                const unsigned char* row =
+                    static_cast<const unsigned char*>(surface->pixels) + sy * surface->pitch;
+
+                for (int sx = x0; sx < x1; sx++)
+                    for (int c = 0; c < 4; c++) sum[c] += row[sx * 4 + c];
+            }
+
+            unsigned count = (y1 - y0) * (x1 - x0);
+            unsigned char* target = &r_image.pixels[(size_t(y) * r_image.width + x) * 4];
+
+            for (int c = 0; c < 4; c++) target[c] = sum[c] / count;
+        }
+    }
+
+    SDL_FreeSurface(surface);
+    return true;
+}
+
+void ThumbnailCache::upload(Texture2D* p_texture, const Image& p_image) {
+    if (p_image.pixels.empty()) return;
+
+    SDL_Surface* surface = SDL_CreateRGBSurface(0, p_image.width, p_image.height, 32, 0x000000ff,
+                                                0x0000ff00, 0x00ff0000, 0xff000000);
+
+    for (int y = 0; y < p_image.height; y++)
+        memcpy(static_cast<unsigned char*>(surface->pixels) + y * surface->pitch,
+               &p_image.pixels[size_t(y) * p_image.width * 4], p_image.width * 4);
+
+    // Replaces the previous thumbnail when the source changed.
+    if (p_texture->loaded) GLSTATE->delete_texture(p_texture->id);
+
+    p_texture->upload(p_texture->get_file(), surface);
+    p_texture->set_filter(Texture::BILINEAR_FILTER);
+}
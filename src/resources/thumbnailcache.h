@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "resources/file.h"
+
+#define THUMBNAILS ThumbnailCache::get_singleton()
+
+class FBO2D;
+class Mesh;
+class Texture2D;
+struct SDL_Surface;
+
+// Small previews of images and meshes for the content browser.
+//
+// Images are decoded and scaled down on the worker pool, meshes are imported there and rendered
+// offscreen on the render thread. Thumbnails are stored in the asset cache keyed by the path,
+// modification time and size of the source, so browsing a folder again only reads the small
+// images. The returned textures show the placeholder until their thumbnail has been uploaded.
+class ThumbnailCache {
+   public:
+    ThumbnailCache();
+
+    static ThumbnailCache* get_singleton();
+
+    // Returns nullptr for files without a preview.
+    Texture2D* get_thumbnail(const File& p_file);
+
+    static bool has_preview(const File& p_file);
+
+    // Width and height of the largest side in pixels.
+    static const int SIZE = 128;
+    static const uint32_t VERSION = 1;
+
+   private:
+    struct Image {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    struct Thumbnail {
+        Texture2D* texture;
+        uint64_t key;
+    };
+
+    void generate(Texture2D* p_texture, const File& p_file, uint64_t p_key);
+    void render(Mesh* p_mesh, Image& r_image);
+
+    static uint64_t get_key(const File& p_file);
+
+    static bool read(const File& p_entry, uint64_t p_key, Image& r_image);
+    static bool write(const File& p_entry, uint64_t p_key, const Image& p_image);
+
+    // Converts to RGBA and averages the pixels down to SIZE, frees the surface.
+    static bool scale(SDL_Surface* p_surface, Image& r_image);
+
+    static void upload(Texture2D* p_texture, const Image& p_image);
+
+    std::unordered_map<std::string, Thumbnail> thumbnails;
+
+    FBO2D* fbo;
+
+    static ThumbnailCache* singleton;
+};
@@ -0,0 +1,210 @@
+#include "virtualfilesystem.h"
+
+#include "core/contentmanager.h"
+#include "core/definitions.h"
+
+#if PLATFORM == LINUX
+#include "SDL2/SDL.h"
+#else
+#include "sdl.h"
+#endif
+
+VirtualFileSystem* VirtualFileSystem::singleton;
+
+namespace {
+// Owns the inflated data of a compressed entry for as long as SDL reads from it.
+struct MemoryStream {
+    std::vector<char> buffer;
+    size_t position = 0;
+};
+
+MemoryStream* get_stream(SDL_RWops* p_context) {
+    return static_cast<MemoryStream*>(p_context->hidden.unknown.data1);
+}
+
+Sint64 SDLCALL stream_size(SDL_RWops* p_context) { return get_stream(p_context)->buffer.size(); }
+
+Sint64 SDLCALL stream_seek(SDL_RWops* p_context, Sint64 p_offset, int p_whence) {
+    MemoryStream* stream = get_stream(p_context);
+    Sint64 base = 0;
+
+    if (p_whence == RW_SEEK_CUR)
+        base = stream->position;
+    else if (p_whence == RW_SEEK_END)
+        base = stream->buffer.size();
+
+    Sint64 position = base + p_offset;
+    if (position < 0 || position > Sint64(stream->buffer.size()))
+        return SDL_SetError("Seek out of range");
+
+    stream->position = position;
+    return position;
+}
+
+size_t SDLCALL stream_read(SDL_RWops* p_context, void* p_data, size_t p_size, size_t p_count) {
+    MemoryStream* stream = get_stream(p_context);
+    if (p_size == 0) return 0;
+
+    size_t count = MIN(p_count, (stream->buffer.size() - stream->position) / p_size);
+    memcpy(p_data, stream->buffer.data() + stream->position, count * p_size);
+    stream->position += count * p_size;
+
+    return count;
+}
+
+size_t SDLCALL stream_write(SDL_RWops*, const void*, size_t, size_t) {
+    SDL_SetError("Archived files are read-only");
+    return 0;
+}
+
+int SDLCALL stream_close(SDL_RWops* p_context) {
+    delete get_stream(p_context);
+    SDL_FreeRW(p_context);
+    return 0;
+}
+}  // namespace
+
+VirtualFileSystem::VirtualFileSystem() { loose_override = true; }
+
+VirtualFileSystem::~VirtualFileSystem() { unmount_all(); }
+
+bool VirtualFileSystem::mount(const File& p_archive) {
+    Archive* archive = new Archive;
+
+    if (!archive->open(p_archive)) {
+        delete archive;
+        return false;
+    }
+
+    archives.push_back(archive);
+
+    T_LOG("Mounted " + p_archive.get_absolute_path() + " with " +
+          String(archive->get_entry_count()) + " files");
+    return true;
+}
+
+void VirtualFileSystem::unmount_all() { archives.clean(); }
+
+bool VirtualFileSystem::has_archives() const { return archives.size() > 0; }
+
+void VirtualFileSystem::set_loose_override(bool p_enabled) { loose_override = p_enabled; }
+
+bool VirtualFileSystem::get_loose_override() const { return loose_override; }
+
+bool VirtualFileSystem::is_file(const File& p_file) const {
+    return find(p_file, nullptr) || p_file.is_loose_file();
+}
+
+bool VirtualFileSystem::is_directory(const File& p_file) const {
+    String path;
+
+    if (has_archives() && get_archive_path(p_file, path)) {
+        for (const Archive* archive : archives)
+            if (archive->is_directory(path)) return true;
+    }
+
+    return p_file.is_loose_directory();
+}
+
+Array<File> VirtualFileSystem::listdir(const File& p_directory) const {
+    Array<File> result = p_directory.listdir_loose();
+    String path;
+
+    if (!has_archives() || !get_archive_path(p_directory, path)) return result;
+
+    Array<String> names;
+    for (const File& file : result) names.push_back(file.get_name());
+
+    for (const Archive* archive : archives) {
+        for (const String& name : archive->list(path)) {
+            if (names.contains(name)) continue;
+
+            names.push_back(name);
+            result.push_back(p_directory.get_absolute_path() + "/" + name);
+        }
+    }
+
+    return result;
+}
+
+bool VirtualFileSystem::is_archived(const File& p_file) const {
+    if (!find(p_file, nullptr)) return false;
+
+    return !loose_override || !p_file.is_loose_file();
+}
+
+bool VirtualFileSystem::read(const File& p_file, const char*& r_data, size_t& r_size,
+                             std::vector<char>& r_buffer) const {
+    const Archive* archive;
+    const Archive::Entry* entry = find(p_file, &archive);
+
+    return entry && archive->read(entry, r_data, r_size, r_buffer);
+}
+
+SDL_RWops* VirtualFileSystem::open_rw(const File& p_file) const {
+    if (!is_archived(p_file)) return SDL_RWFromFile(p_file.get_absolute_path().c_str(), "rb");
+
+    const char* data;
+    size_t size;
+    MemoryStream* stream = new MemoryStream;
+
+    if (!read(p_file, data, size, stream->buffer)) {
+        delete stream;
+        return nullptr;
+    }
+
+    // Uncompressed entries stay valid for as long as the archive is mounted.
+    if (stream->buffer.empty()) {
+        delete stream;
+        return SDL_RWFromConstMem(data, int(size));
+    }
+
+    SDL_RWops* rw = SDL_AllocRW();
+    if (!rw) {
+        delete stream;
+        return nullptr;
+    }
+
+    rw->size = stream_size;
+    rw->seek = stream_seek;
+    rw->read = stream_read;
+    rw->write = stream_write;
+    rw->close = stream_close;
+    rw->type = SDL_RWOPS_UNKNOWN;
+    rw->hidden.unknown.data1 = stream;
+
+    return rw;
+}
+
+VirtualFileSystem* VirtualFileSystem::get_singleton() {
+    // Files can be constructed during static initialization.
+    if (!singleton) singleton = new VirtualFileSystem;
+
+    return singleton;
+}
+
+const Archive::Entry* VirtualFileSystem::find(const File& p_file,
+                                              const Archive** r_archive) const {
+    String path;
+    if (!has_archives() || !get_archive_path(p_file, path)) return nullptr;
+
+    for (int c = archives.size() - 1; c >= 0; c--) {
+        const Archive::Entry* entry = archives[c]->find(path);
+
+        if (entry) {
+            if (r_archive) *r_archive = archives[c];
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+bool VirtualFileSystem::get_archive_path(const File& p_file, String& r_path) {
+    r_path = p_file.get_relative_path();
+
+    if (r_path.size() == 0) return false;
+    if (r_path == "/") r_path = "";
+
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "core/vector.h"
+#include "resources/archive.h"
+
+struct SDL_RWops;
+
+// Serves asset files from mounted archives, next to the loose files in the assets directory.
+//
+// Existence checks and directory listings see the union of both. When loose files override the
+// archives, which is the default during development, a loose file is read instead of the archived
+// copy. Without the override a file that is in an archive never touches the disk.
+class VirtualFileSystem {
+   public:
+    VirtualFileSystem();
+    ~VirtualFileSystem();
+
+    // Archives mounted later take precedence.
+    bool mount(const File& p_archive);
+    void unmount_all();
+
+    bool has_archives() const;
+
+    void set_loose_override(bool p_enabled);
+    bool get_loose_override() const;
+
+    bool is_file(const File& p_file) const;
+    bool is_directory(const File& p_file) const;
+    Array<File> listdir(const File& p_directory) const;
+
+    // True when reading the file is served by an archive.
+    bool is_archived(const File& p_file) const;
+
+    // Reads an archived file, see Archive::read.
+    bool read(const File& p_file, const char*& r_data, size_t& r_size,
+              std::vector<char>& r_buffer) const;
+
+    // Stream for the SDL loaders, closed by them.
+    SDL_RWops* open_rw(const File& p_file) const;
+
+    static VirtualFileSystem* get_singleton();
+
+   private:
+    const Archive::Entry* find(const File& p_file, const Archive** r_archive) const;
+
+    // Fails for files outside of the assets directory.
+    static bool get_archive_path(const File& p_file, String& r_path);
+
+    Vector<Archive> archives;
+    bool loose_override;
+
+    static VirtualFileSystem* singleton;
+};
+
+#define VFS VirtualFileSystem::get_singleton()
@@ -0,0 +1,26 @@
+/*
+titan_cook
+Prebuilds the caches of the assets tree, so the engine does not have to decode images on startup.
+*/
+
+#include "core/definitions.h"
+#include "tools/cookapp.h"
+
+#if PLATFORM == LINUX
+#define NEW_PLATFORM new Linux
+#include "core/platform/linux.h"
+#else
+#define NEW_PLATFORM new Windows
+#include "core/platform/windows.h"
+#endif
+
+#undef main
+
+int main(int argc, char* argv[]) {
+    Array<String> args = Array<String>();
+
+    for (int c = 1; c < argc; c++) args.push_back(argv[c]);
+
+    CookApp cook(NEW_PLATFORM);
+    return cook.run(args);
+}
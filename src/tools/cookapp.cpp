@@ -0,0 +1,97 @@
+#include "cookapp.h"
+
+#include <atomic>
+#include <filesystem>
+
+#include "core/contentmanager.h"
+#include "core/threadpool.h"
+#include "core/time.h"
+#include "resources/archive.h"
+#include "resources/texturecache.h"
+
+CookApp::CookApp(Platform* p_platform) : Application(p_platform) { graphics_enabled = false; }
+
+int CookApp::run(const Array<String>& p_args) {
+    bool compress = false;
+    bool force = false;
+    bool pack = false;
+    String directory;
+
+    for (const String& arg : p_args) {
+        if (arg == "--compress") {
+            compress = true;
+        } else if (arg == "--force") {
+            force = true;
+        } else if (arg == "--pack") {
+            pack = true;
+        } else if (arg.starts_with("--")) {
+            T_ERROR("Unknown option: " + arg);
+            return 1;
+        } else {
+            directory = arg;
+        }
+    }
+
+    InitEngine();
+
+    if (directory.size() > 0)
+        CONTENT->set_assets_dir(String(std::filesystem::absolute(directory.c_str()).string()));
+
+    File assets = ASSETS_DIR;
+
+    if (!assets.is_directory()) {
+        T_ERROR("Assets directory not found: " + assets.get_absolute_path());
+        return 1;
+    }
+
+    Stopwatch watch;
+    watch.start();
+
+    Array<File> files;
+    collect(assets, files);
+
+    std::atomic<int> cooked(0);
+    std::atomic<int> failed(0);
+
+    for (const File& file : files) {
+        THREADPOOL->add_task([&cooked, &failed, file, compress, force]() {
+            TextureCache cache(file);
+
+            if (!force && cache.open()) return;
+
+            if (cache.cook(compress))
+                cooked++;
+            else
+                failed++;
+        });
+    }
+
+    THREADPOOL->wait();
+
+    T_LOG("Cooked " + String(cooked.load()) + " of " + String(files.size()) + " textures in " +
+          String(watch.stop()) + " s, " + String(failed.load()) + " failed");
+
+    if (pack) {
+        File archive = assets.get_absolute_path() + "." + ARCHIVE_EXTENSION;
+
+        watch.start();
+        if (!Archive::build(assets, archive)) return 1;
+
+        T_LOG("Packed " + assets.get_absolute_path() + " into " + archive.get_absolute_path() +
+              " in " + String(watch.stop()) + " s");
+    }
+
+    return failed > 0 ? 1 : 0;
+}
+
+void CookApp::collect(const File& p_directory, Array<File>& r_files) {
+    for (const File& file : p_directory.listdir()) {
+        // Skips the cache itself and other hidden directories.
+        if (file.get_name().starts_with(".")) continue;
+
+        if (file.is_directory())
+            collect(file, r_files);
+        else if (TextureCache::is_supported(file))
+            r_files.push_back(file);
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "core/application.h"
+
+// Command line tool that prebuilds the texture cache for a whole assets tree, and optionally
+// packs the tree into an archive next to it. The archive includes the cooked textures and any mesh
+// cache entries the engine wrote earlier.
+//
+// Usage: titan_cook [--compress] [--force] [--pack] [assets directory]
+class CookApp : public Application {
+    OBJ_DEFINITION(CookApp, Application);
+
+   public:
+    CookApp(Platform* p_platform);
+
+    // Returns the exit code of the process.
+    int run(const Array<String>& p_args);
+
+   private:
+    void collect(const File& p_directory, Array<File>& r_files);
+};
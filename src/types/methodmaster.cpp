@@ -42,36 +42,67 @@ void MethodMaster::init() {
 
     method_master->add_fundamental_methods();
     method_master->add_static_functions();
-    method_master->add_inherited_methods();
 }
 
-void MethodMaster::add_inherited_methods() {
-    for (std::pair<const StringName, ObjectType>& o : TypeManager::get_singleton()->object_types) {
-        Array<String> a = o.second.path.split('/');
+void MethodMaster::add_binder(const StringName& p_type, Binder p_binder) {
+    binders[VariantType(p_type)] = p_binder;
+}
+
+ObjectCallables& MethodMaster::get_callables(VariantType type) {
+    ObjectCallables& callables = object_callables[type];
+    if (!callables.bound) bind(type, callables);
+
+    return callables;
+}
 
-        // do not add the object's own methods again
-        a.removelast();
+void MethodMaster::bind(VariantType type, ObjectCallables& r_callables) {
+    // Set first, binding the ancestors never comes back to this type.
+    r_callables.bound = true;
 
-        for (int c = 0; c < a.size(); c++) {
-            VariantType t = a[c];
+    if (binders.contains(type)) binders[type]();
 
-            for (Method* method : object_callables[t].methods) {
-                method->inherits_from = t;
-                register_method(o.second.name, method);
-            }
+    StringName name = type.get_type_name();
+    if (!TYPEMAN->object_types.contains(name)) return;
+
+    Array<String> a = TYPEMAN->object_types[name].path.split('/');
+
+    // do not add the object's own methods again
+    a.removelast();
+
+    for (int c = 0; c < a.size(); c++) {
+        ObjectCallables& ancestor = get_callables(VariantType(a[c]));
 
-            for (Property* property : object_callables[t].properties) {
-                property->inherits_from = t;
-                register_property(o.second.name, property);
-            }
-        }
+        for (Method* method : ancestor.methods) register_method(type, method);
+        for (Property* property : ancestor.properties) register_property(type, property);
     }
 }
 
 void MethodMaster::add_fundamental_methods() {
-    // register vec2
     TYPEMAN->add_type(StringName("vec2"));
+    TYPEMAN->add_type(StringName("vec3"));
+    TYPEMAN->add_type(StringName("vec4"));
+    TYPEMAN->add_type(StringName("String"));
+    TYPEMAN->add_type(StringName("Transform"));
+
+    add_binder(StringName("vec2"), bind_vec2);
+    add_binder(StringName("vec3"), bind_vec3);
+    add_binder(StringName("vec4"), bind_vec4);
+    add_binder(StringName("String"), bind_string);
+    add_binder(StringName("Transform"), bind_transform);
+
+    // register rect2
+    /*TYPEMAN->add_type(StringName("rect2"));
+
+    REG_CSTR_NO(rect2, 0);
+    REG_CSTR_NO_OVRLD_1(Transform, vec2);
+    REG_CSTR_NO(rect2, 2);
+    REG_CSTR_NO(rect2, 4);
 
+    REG_PROPERTY_NO(rect2, pos);
+    REG_PROPERTY_NO(rect2, size);*/
+}
+
+void MethodMaster::bind_vec2() {
     REG_CSTR_NO(vec2, 0);
     REG_CSTR_NO(vec2, 2);
     REG_CSTR_NO_OVRLD_1(vec2, float);
@@ -84,10 +115,9 @@ void MethodMaster::add_fundamental_methods() {
 
     REG_PROPERTY_NO(vec2, x);
     REG_PROPERTY_NO(vec2, y);
+}
 
-    // register vec3
-    TYPEMAN->add_type(StringName("vec3"));
-
+void MethodMaster::bind_vec3() {
     REG_CSTR_NO(vec3, 0);
     REG_CSTR_NO(vec3, 3);
     REG_CSTR_NO_OVRLD_1(vec3, float);
@@ -103,10 +133,9 @@ void MethodMaster::add_fundamental_methods() {
     REG_PROPERTY_NO(vec3, x);
     REG_PROPERTY_NO(vec3, y);
     REG_PROPERTY_NO(vec3, z);
+}
 
-    // register vec4
-    TYPEMAN->add_type(StringName("vec4"));
-
+void MethodMaster::bind_vec4() {
     REG_CSTR_NO(vec4, 0);
     REG_CSTR_NO(vec4, 4);
     REG_CSTR_NO_OVRLD_1(vec4, float);
@@ -127,15 +156,13 @@ void MethodMaster::add_fundamental_methods() {
     REG_PROPERTY_NO(vec4, y);
     REG_PROPERTY_NO(vec4, z);
     REG_PROPERTY_NO(vec4, w);
+}
 
-    // register String
-    TYPEMAN->add_type(StringName("String"));
-
+void MethodMaster::bind_string() {
     REG_CSTR_FULL(String, "String", 0);
+}
 
-    // register Transform
-    TYPEMAN->add_type(StringName("Transform"));
-
+void MethodMaster::bind_transform() {
     REG_CSTR_NO(Transform, 0);
     REG_CSTR_NO_OVRLD_1(Transform, vec3);
     REG_CSTR_NO_OVRLD_2(Transform, vec2, vec2);
@@ -150,17 +177,6 @@ void MethodMaster::add_fundamental_methods() {
     REG_PROPERTY_NO(Transform, pos);
     REG_PROPERTY_NO(Transform, size);
     REG_PROPERTY_NO(Transform, rotation);
-
-    // register rect2
-    /*TYPEMAN->add_type(StringName("rect2"));
-
-    REG_CSTR_NO(rect2, 0);
-    REG_CSTR_NO_OVRLD_1(Transform, vec2);
-    REG_CSTR_NO(rect2, 2);
-    REG_CSTR_NO(rect2, 4);
-
-    REG_PROPERTY_NO(rect2, pos);
-    REG_PROPERTY_NO(rect2, size);*/
 }
 
 void MethodMaster::add_static_functions() {
@@ -185,17 +201,19 @@ void MethodMaster::register_singleton(VariantType type, Variant p_singleton) {
 
 // register
 void MethodMaster::register_method(VariantType type, Method* method) {
-    if (!method_exists(type, method->name)) object_callables[type].methods.push_back(method);
+    ObjectCallables& callables = object_callables[type];
+    if (!callables.get_method_by_name(method->name)) callables.methods.push_back(method);
 }
 
 void MethodMaster::register_property(VariantType type, Property* getset) {
-    if (!property_exists(type, getset->var_name))
-        object_callables[type].properties.push_back(getset);
+    ObjectCallables& callables = object_callables[type];
+    if (!callables.get_getsetter_by_name(getset->var_name)) callables.properties.push_back(getset);
 }
 
 void MethodMaster::register_constructor(VariantType type, TConstructor* cstr) {
-    if (!constructor_exists(type, cstr->arg_count))
-        object_callables[type].constructors.push_back(cstr);
+    ObjectCallables& callables = object_callables[type];
+    if (!callables.get_constructor_by_params(cstr->arg_count))
+        callables.constructors.push_back(cstr);
 }
 
 void MethodMaster::register_static_func(StringName name, Method* method) {
@@ -208,37 +226,22 @@ void MethodMaster::register_signal(const VariantType& p_type, const StringName&
 
 // does exist
 bool MethodMaster::method_exists(VariantType type, const StringName& name) {
-    if (!object_callables.contains(type)) return false;
-
-    for (Method* m : object_callables[type].methods)
-        if (m->name == name) return true;
-
-    return false;
+    return get_callables(type).get_method_by_name(name);
 }
 bool MethodMaster::property_exists(VariantType type, const StringName& name) {
-    if (!object_callables.contains(type)) return false;
-
-    for (Property* gs : object_callables[type].properties)
-        if (gs->var_name == name) return true;
-
-    return false;
+    return get_callables(type).get_getsetter_by_name(name);
 }
 bool MethodMaster::constructor_exists(VariantType type, int argc) {
-    if (!object_callables.contains(type)) return false;
-
-    for (TConstructor* m : object_callables[type].constructors)
-        if (m->arg_count == argc) return true;
-
-    return false;
+    return get_callables(type).get_constructor_by_params(argc);
 }
 
 bool MethodMaster::signal_exists(const VariantType& p_type, const StringName& p_signal) {
-    if (!object_callables.contains(p_type)) return false;
+    if (!TYPEMAN->object_types.contains(p_type.get_type_name())) return false;
 
     Array<String> a = TYPEMAN->get_object_type(p_type.get_type_name()).path.split('/');
 
     for (int c = 0; c < a.size(); c++) {
-        if (object_callables[VariantType(a[c])].signal_names.contains(p_signal)) return true;
+        if (get_callables(VariantType(a[c])).signal_names.contains(p_signal)) return true;
     }
 
     return false;
@@ -246,35 +249,16 @@ bool MethodMaster::signal_exists(const VariantType& p_type, const StringName& p_
 
 // get
 Method* MethodMaster::get_method(VariantType type, const StringName& name) {
-    if (object_callables.contains(type)) {
-        if (name == "CollisionEvent")
-            for (auto m : object_callables[type].methods)
-                std::cout << (m->name).get_source() << std::endl;
-
-        Method* m = object_callables[type].get_method_by_name(name);
-        return object_callables[type].get_method_by_name(name);
-    } else
-        return nullptr;
+    return get_callables(type).get_method_by_name(name);
 }
 Property* MethodMaster::get_property(VariantType type, const StringName& name) {
-    if (object_callables.contains(type))
-        return object_callables[type].get_getsetter_by_name(name);
-    else
-        return nullptr;
+    return get_callables(type).get_getsetter_by_name(name);
 }
 TConstructor* MethodMaster::get_constructor(VariantType type, int param_count) {
-    if (object_callables.contains(type))
-        return object_callables[type].get_constructor_by_params(param_count);
-    else
-        return nullptr;
+    return get_callables(type).get_constructor_by_params(param_count);
 }
 
-Variant MethodMaster::get_singleton(VariantType p_type) {
-    if (object_callables.contains(p_type))
-        return object_callables[p_type].singleton;
-    else
-        return NULL_VAR;
-}
+Variant MethodMaster::get_singleton(VariantType p_type) { return get_callables(p_type).singleton; }
 
 void MethodMaster::clean() {
     for (std::pair<const int, ObjectCallables>& oc : MMASTER->object_callables) oc.second.free();
@@ -287,7 +271,7 @@ Array<StringName> MethodMaster::list_method_names(VariantType type) {
 
     Array<StringName> result;
 
-    for (Method* m : object_callables[type].methods) result.push_back(m->name);
+    for (Method* m : get_callables(type).methods) result.push_back(m->name);
 
     return result;
 }
@@ -297,7 +281,7 @@ Array<StringName> MethodMaster::list_property_names(VariantType type) {
 
     Array<StringName> result;
 
-    for (Property* m : object_callables[type].properties) result.push_back(m->var_name);
+    for (Property* m : get_callables(type).properties) result.push_back(m->var_name);
 
     return result;
 }
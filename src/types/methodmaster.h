@@ -35,14 +35,28 @@ class ObjectCallables {
     Array<StringName> signal_names;
 
     Variant singleton;
+
+    // Set once the type's own members and those of its ancestors have been added.
+    bool bound = false;
 };
 
+// Methods, properties, constructors and signals of all types, by type.
+//
+// A type's table is built on first use: its bind_methods runs, then the members of its ancestors
+// are added. Tools and tests that touch a handful of types only bind those.
 class MethodMaster {
    public:
-    void add_inherited_methods();
+    typedef void (*Binder)();
+
     void add_fundamental_methods();
     void add_static_functions();
 
+    template <typename T>
+    void add_binder() {
+        add_binder(T::get_type_name_static(), &T::bind_methods);
+    }
+    void add_binder(const StringName& p_type, Binder p_binder);
+
     void register_constant(VariantType type, const ConstantMember& p_constant);
     void register_singleton(VariantType type, Variant p_singleton);
     void register_method(VariantType type, Method* method);
@@ -73,7 +87,18 @@ class MethodMaster {
     static MethodMaster* get_method_master();
 
    private:
+    // Binds the type first if needed.
+    ObjectCallables& get_callables(VariantType type);
+    void bind(VariantType type, ObjectCallables& r_callables);
+
+    static void bind_vec2();
+    static void bind_vec3();
+    static void bind_vec4();
+    static void bind_string();
+    static void bind_transform();
+
     Dictionary<int, ObjectCallables> object_callables;
+    Dictionary<int, Binder> binders;
 
     static MethodMaster* method_master;
 };
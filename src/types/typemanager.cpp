@@ -36,6 +36,8 @@ void TypeManager::set_object_type(const ObjectType& p_object_type) {
 
 TypeManager* TypeManager::get_singleton() { return singleton; }
 
+#include "core/binaryserializer.h"
+#include "core/prefab.h"
 #include "core/time.h"
 #include "core/titanscript/titanscript.h"
 #include "editor/editorapp.h"
@@ -120,6 +122,8 @@ void TypeManager::init() {
     Viewport::init_type();
     EditorViewport::init_type();
     ContentManager::init_type();
+    BinarySerializer::init_type();
+    Prefab::init_type();
     EditorApp::init_type();
     Project::init_type();
     Scene::init_type();
@@ -181,111 +185,111 @@ void TypeManager::init() {
     SoundEffect::init_type();
     TextFile::init_type();
 
-    // Bind all methods.
+    // Methods are bound when a type is first looked up.
     MethodMaster::init();
 
-    Project::bind_methods();
-    Scene::bind_methods();
-    Layer::bind_methods();
+    MMASTER->add_binder<Project>();
+    MMASTER->add_binder<Scene>();
+    MMASTER->add_binder<Layer>();
 
-    WorldObject::bind_methods();
-    PointLight::bind_methods();
-    DirectionalLight::bind_methods();
-    ConeLight::bind_methods();
-    Sprite::bind_methods();
-    World::bind_methods();
-    Camera::bind_methods();
-    Terrain::bind_methods();
-    TerrainNoise::bind_methods();
-    TerrainBrush::bind_methods();
-    Water::bind_methods();
-    Sky::bind_methods();
-    Clouds::bind_methods();
-    Vegetation::bind_methods();
-    Model::bind_methods();
-    Mesh::bind_methods();
-    Material::bind_methods();
-    Environment::bind_methods();
+    MMASTER->add_binder<WorldObject>();
+    MMASTER->add_binder<PointLight>();
+    MMASTER->add_binder<DirectionalLight>();
+    MMASTER->add_binder<ConeLight>();
+    MMASTER->add_binder<Sprite>();
+    MMASTER->add_binder<World>();
+    MMASTER->add_binder<Camera>();
+    MMASTER->add_binder<Terrain>();
+    MMASTER->add_binder<TerrainNoise>();
+    MMASTER->add_binder<TerrainBrush>();
+    MMASTER->add_binder<Water>();
+    MMASTER->add_binder<Sky>();
+    MMASTER->add_binder<Clouds>();
+    MMASTER->add_binder<Vegetation>();
+    MMASTER->add_binder<Model>();
+    MMASTER->add_binder<Mesh>();
+    MMASTER->add_binder<Material>();
+    MMASTER->add_binder<Environment>();
 
-    Scriptable::bind_methods();
-    TitanScript::bind_methods();
-    Mouse::bind_methods();
-    Event::bind_methods();
-    InputEvent::bind_methods();
-    UIEvent::bind_methods();
-    CollisionEvent::bind_methods();
-    Keyboard::bind_methods();
-    Key::bind_methods();
-    Time::bind_methods();
-    RigidBody2D::bind_methods();
-    RigidBody3D::bind_methods();
-    CollisionShape2D::bind_methods();
-    CircleShape2D::bind_methods();
-    BoxShape2D::bind_methods();
-    TransformComponent::bind_methods();
-    RenderComponent::bind_methods();
-    Component::bind_methods();
-    Viewport::bind_methods();
-    EditorViewport::bind_methods();
-    ContentManager::bind_methods();
-    ListView::bind_methods();
-    TileView::bind_methods();
-    TreeView::bind_methods();
-    EditorApp::bind_methods();
-    PropertyTab::bind_methods();
-    GamePreviewTab::bind_methods();
-    ToolTab::bind_methods();
-    PropertyView::bind_methods();
-    WorldView::bind_methods();
-    TextButton::bind_methods();
-    ColorField::bind_methods();
-    Texture2DField::bind_methods();
-    ObjectField::bind_methods();
-    EditableLabel::bind_methods();
-    NumberField::bind_methods();
-    TextField::bind_methods();
-    Vec2Field::bind_methods();
-    Vec3Field::bind_methods();
-    Vec4Field::bind_methods();
-    TransformField::bind_methods();
-    PropertyControl::bind_methods();
+    MMASTER->add_binder<Scriptable>();
+    MMASTER->add_binder<TitanScript>();
+    MMASTER->add_binder<Mouse>();
+    MMASTER->add_binder<Event>();
+    MMASTER->add_binder<InputEvent>();
+    MMASTER->add_binder<UIEvent>();
+    MMASTER->add_binder<CollisionEvent>();
+    MMASTER->add_binder<Keyboard>();
+    MMASTER->add_binder<Key>();
+    MMASTER->add_binder<Time>();
+    MMASTER->add_binder<RigidBody2D>();
+    MMASTER->add_binder<RigidBody3D>();
+    MMASTER->add_binder<CollisionShape2D>();
+    MMASTER->add_binder<CircleShape2D>();
+    MMASTER->add_binder<BoxShape2D>();
+    MMASTER->add_binder<TransformComponent>();
+    MMASTER->add_binder<RenderComponent>();
+    MMASTER->add_binder<Component>();
+    MMASTER->add_binder<Viewport>();
+    MMASTER->add_binder<EditorViewport>();
+    MMASTER->add_binder<ContentManager>();
+    MMASTER->add_binder<BinarySerializer>();
+    MMASTER->add_binder<Prefab>();
+    MMASTER->add_binder<ListView>();
+    MMASTER->add_binder<TileView>();
+    MMASTER->add_binder<TreeView>();
+    MMASTER->add_binder<EditorApp>();
+    MMASTER->add_binder<PropertyTab>();
+    MMASTER->add_binder<GamePreviewTab>();
+    MMASTER->add_binder<ToolTab>();
+    MMASTER->add_binder<PropertyView>();
+    MMASTER->add_binder<WorldView>();
+    MMASTER->add_binder<TextButton>();
+    MMASTER->add_binder<ColorField>();
+    MMASTER->add_binder<Texture2DField>();
+    MMASTER->add_binder<ObjectField>();
+    MMASTER->add_binder<EditableLabel>();
+    MMASTER->add_binder<NumberField>();
+    MMASTER->add_binder<TextField>();
+    MMASTER->add_binder<Vec2Field>();
+    MMASTER->add_binder<Vec3Field>();
+    MMASTER->add_binder<Vec4Field>();
+    MMASTER->add_binder<TransformField>();
+    MMASTER->add_binder<PropertyControl>();
 
-    Node::bind_methods();
-    Canvas::bind_methods();
+    MMASTER->add_binder<Node>();
+    MMASTER->add_binder<Canvas>();
 
-    Label::bind_methods();
-    Button::bind_methods();
-    LabelButton::bind_methods();
-    ImageButton::bind_methods();
-    TextButton::bind_methods();
-    Toggle::bind_methods();
-    ToggleStrip::bind_methods();
-    Tab::bind_methods();
-    TextEditorTab::bind_methods();
-    ShaderEditorTab::bind_methods();
-    TextBox::bind_methods();
-    Slider::bind_methods();
-    ToolBar::bind_methods();
-    ContextMenu::bind_methods();
-    Dialog::bind_methods();
-    ConfirmationDialog::bind_methods();
-    FileDialog::bind_methods();
-    ColorPickDialog::bind_methods();
-    MessageDialog::bind_methods();
-    TypePickDialog::bind_methods();
-    ConsoleTab::bind_methods();
-    ExplorerTab::bind_methods();
-    ContentTab::bind_methods();
-    ComboBox::bind_methods();
+    MMASTER->add_binder<Label>();
+    MMASTER->add_binder<Button>();
+    MMASTER->add_binder<LabelButton>();
+    MMASTER->add_binder<ImageButton>();
+    MMASTER->add_binder<TextButton>();
+    MMASTER->add_binder<Toggle>();
+    MMASTER->add_binder<ToggleStrip>();
+    MMASTER->add_binder<Tab>();
+    MMASTER->add_binder<TextEditorTab>();
+    MMASTER->add_binder<ShaderEditorTab>();
+    MMASTER->add_binder<TextBox>();
+    MMASTER->add_binder<Slider>();
+    MMASTER->add_binder<ToolBar>();
+    MMASTER->add_binder<ContextMenu>();
+    MMASTER->add_binder<Dialog>();
+    MMASTER->add_binder<ConfirmationDialog>();
+    MMASTER->add_binder<FileDialog>();
+    MMASTER->add_binder<ColorPickDialog>();
+    MMASTER->add_binder<MessageDialog>();
+    MMASTER->add_binder<TypePickDialog>();
+    MMASTER->add_binder<ConsoleTab>();
+    MMASTER->add_binder<ExplorerTab>();
+    MMASTER->add_binder<ContentTab>();
+    MMASTER->add_binder<ComboBox>();
 
     // Resources
-    Font::bind_methods();
-    Texture::bind_methods();
-    Texture2D::bind_methods();
-    Shader::bind_methods();
-    Music::bind_methods();
-    SoundEffect::bind_methods();
-    TextFile::bind_methods();
-
-    MMASTER->add_inherited_methods();
+    MMASTER->add_binder<Font>();
+    MMASTER->add_binder<Texture>();
+    MMASTER->add_binder<Texture2D>();
+    MMASTER->add_binder<Shader>();
+    MMASTER->add_binder<Music>();
+    MMASTER->add_binder<SoundEffect>();
+    MMASTER->add_binder<TextFile>();
 }
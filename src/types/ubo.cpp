@@ -2,55 +2,39 @@
 
 #include "resources/texture.h"
 
-UBO::UBO() { glGenBuffers(1, &ubo); }
+UBO::UBO() {
+    glGenBuffers(1, &ubo);
+    bound_index = 0;
+}
 
-UBO::~UBO() {}
+UBO::~UBO() { glDeleteBuffers(1, &ubo); }
 
 void UBO::set_data(const Array<float>& p_buffer) {
-    GLuint ubo = 0;
-    data_size = p_buffer.size();
-    data = new float[data_size];
-
-    for (int c = 0; c < p_buffer.size(); c++) data[c] = p_buffer[c];
-
-    init();
+    set_data(p_buffer.size() > 0 ? &p_buffer[0] : nullptr, p_buffer.size() * sizeof(float));
 }
 
 void UBO::set_data(const Array<mat4>& p_buffer) {
-    GLuint ubo = 0;
-    data_size = p_buffer.size() * 16;
-    data = new float[data_size];
-
-    for (int c = 0; c < p_buffer.size(); c++)
-        for (int i = 0; i < 16; i++) data[c * 16 + i] = p_buffer[c].m[i];
-
-    init();
+    set_data(p_buffer.size() > 0 ? &p_buffer[0] : nullptr, p_buffer.size() * sizeof(mat4));
 }
 
-void UBO::init() {
-    GLuint ubo = 0;
-    glGenBuffers(1, &ubo);
+void UBO::set_data(const void* p_data, int p_size) {
     bind();
-    glBufferData(GL_UNIFORM_BUFFER, data_size * sizeof(float), &data[0], GL_STATIC_DRAW);
+    glBufferData(GL_UNIFORM_BUFFER, p_size, p_data, GL_DYNAMIC_DRAW);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void UBO::update_data(const Array<float>& p_buffer) {
-    bind();
-
-    GLvoid* p = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
-    memcpy(p, &p_buffer, p_buffer.size() * sizeof(float));
-
-    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    if (p_buffer.size() > 0) update_data(&p_buffer[0], p_buffer.size() * sizeof(float));
 }
 
 void UBO::update_data(const Array<mat4>& p_buffer) {
-    bind();
-
-    GLvoid* p = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
-    memcpy(p, &p_buffer, p_buffer.size() * 16 * sizeof(float));
+    if (p_buffer.size() > 0) update_data(&p_buffer[0], p_buffer.size() * sizeof(mat4));
+}
 
-    glUnmapBuffer(GL_UNIFORM_BUFFER);
+void UBO::update_data(const void* p_data, int p_size) {
+    bind();
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, p_size, p_data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void UBO::bind() { glBindBuffer(GL_UNIFORM_BUFFER, ubo); }
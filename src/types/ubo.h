@@ -9,11 +9,16 @@ class UBO : public Resource {
     UBO();
     virtual ~UBO();
 
+    // Binding points of the blocks in engine/shaders/Uniforms.glsl, other blocks start after them.
+    enum Binding { BINDING_FRAME, BINDING_VIEW, BINDING_FIRST_FREE };
+
     void set_data(const Array<float>& p_buffer);
     void set_data(const Array<mat4>& p_buffer);
+    void set_data(const void* p_data, int p_size);
 
     void update_data(const Array<float>& p_buffer);
     void update_data(const Array<mat4>& p_buffer);
+    void update_data(const void* p_data, int p_size);
 
     void bind();
 
@@ -21,11 +26,6 @@ class UBO : public Resource {
     int get_bound_index() const;
 
    private:
-    void init();
-
     unsigned ubo;
     unsigned bound_index;
-
-    float* data;
-    int data_size;
 };
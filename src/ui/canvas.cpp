@@ -46,7 +46,10 @@ Canvas::Canvas() {
 
 Canvas::~Canvas() {}
 
-void Canvas::schedule_update(Control* p_control) { scheduled_updates.push_back(p_control); }
+void Canvas::schedule_update(Control* p_control) {
+    scheduled_updates.push_back(p_control);
+    p_control->flag_dirty();
+}
 
 void Canvas::add_layer() { layers.push_back(CanvasLayer(layers.size() - 1)); }
 
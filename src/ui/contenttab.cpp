@@ -3,6 +3,7 @@
 #include "canvas.h"
 #include "container.h"
 #include "imagebutton.h"
+#include "resources/thumbnailcache.h"
 #include "textfield.h"
 #include "tileview.h"
 
@@ -91,12 +92,10 @@ void ContentTab::update_list() {
     for (int c = 0; c < files.size(); c++) {
         File f = files[c];
 
-        VariantType t = CONTENT->GetType(f);
-
         if (f.is_directory())
             tile_view->push_back_item(f.get_name(), directory_icon);
-        else if (t.is_of_type<Texture2D>())
-            tile_view->push_back_item(f.get_name(), CONTENT->LoadTexture(f));
+        else if (ThumbnailCache::has_preview(f))
+            tile_view->push_back_item(f.get_name(), THUMBNAILS->get_thumbnail(f));
         else
             tile_view->push_back_item(f.get_name(), file_icon);
     }
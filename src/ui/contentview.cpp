@@ -1,9 +1,13 @@
 #include "contentview.h"
 
 #include "core/string.h"
+#include "resources/thumbnailcache.h"
 #include "utility/stringutils.h"
 
-ContentTile::ContentTile(const String& filepath) : ImageButton(filepath) {}
+ContentTile::ContentTile(const String& filepath)
+    : ImageButton(ThumbnailCache::has_preview(filepath)
+                      ? THUMBNAILS->get_thumbnail(filepath)
+                      : CONTENT->LoadFontAwesomeIcon("regular/file")) {}
 
 vec2 ContentTile::get_required_size() const { return vec2(60); }
 
@@ -2,6 +2,9 @@
 
 #include "core/tchar.h"
 #include "core/windowmanager.h"
+#include "graphics/canvasbatch.h"
+#include "graphics/canvastarget.h"
+#include "graphics/glstate.h"
 #include "graphics/renderer.h"
 #include "graphics/view.h"
 #include "resources/texture.h"
@@ -25,6 +28,18 @@ Control::Control() {
     visible = true;
     to_be_updated = true;
     use_scissor = false;
+
+    retained = false;
+    retained_dirty = true;
+    target = nullptr;
+}
+
+Control* Control::retaining;
+
+Control::~Control() {
+    if (retaining == this) retaining = nullptr;
+
+    delete target;
 }
 
 void Control::bind_parent(Control* p_parent) { parent = p_parent; }
@@ -212,9 +227,13 @@ void Control::add_child(Node* p_child) {
     Node::add_child(p_child);
 
     p_child->cast_to_type<Control*>()->init();
+    flag_dirty();
 }
 
-void Control::remove_child(Node* p_child) { Node::remove_child(p_child); }
+void Control::remove_child(Node* p_child) {
+    Node::remove_child(p_child);
+    flag_dirty();
+}
 
 bool Control::get_focused() const { return ACTIVE_CANVAS->get_focused() == this; }
 
@@ -224,7 +243,18 @@ void Control::set_focused(bool value) {
     update();
 }
 
-void Control::set_visible(bool p_visible) { visible = p_visible; }
+void Control::set_visible(bool p_visible) {
+    if (visible == p_visible) return;
+
+    visible = p_visible;
+    flag_dirty();
+
+    // Drawn again when shown, the GL objects are not kept meanwhile.
+    if (!visible && target) {
+        target->release();
+        retained_textures.clear();
+    }
+}
 
 bool Control::get_visible() const { return visible; }
 
@@ -235,7 +265,10 @@ void Control::check_size_changed() {
         children[c]->cast_to_type<Control*>()->check_size_changed();
 }
 
-void Control::flag_size_changed() { flagged_size_changed = true; }
+void Control::flag_size_changed() {
+    flagged_size_changed = true;
+    flag_dirty();
+}
 
 void Control::size_changed() {
     vec2 minimum_size = get_required_size();
@@ -316,9 +349,39 @@ void Control::set_tip_description(const String& p_description) { tip_description
 
 String Control::get_tip_description() const { return tip_description; }
 
+void Control::set_retained(bool p_retained) {
+    retained = p_retained;
+    retained_dirty = true;
+
+    if (!retained) {
+        delete target;
+        target = nullptr;
+        retained_textures.clear();
+    }
+}
+
+bool Control::get_retained() const { return retained; }
+
+void Control::flag_dirty() {
+    Control* control = this;
+
+    while (control) {
+        control->retained_dirty = true;
+        control = control->parent ? control->parent->cast_to_type<Control*>() : nullptr;
+    }
+}
+
 void Control::draw() {
     if (!visible) return;
 
+    // Retained controls inside a target are drawn into that one.
+    if (retained && !CanvasTarget::is_active())
+        draw_retained();
+    else
+        draw_tree();
+}
+
+void Control::draw_tree() {
     if (to_be_updated || update_continuoulsy) {
         draw_commands.clear();
         drawing = true;
@@ -327,11 +390,73 @@ void Control::draw() {
         to_be_updated = false;
     }
 
+    if (update_continuoulsy) flag_dirty();
+
     render();
 
     for (Node* n : children) n->cast_to_type<Control*>()->draw();
 }
 
+void Control::draw_retained() {
+    if (!retained_dirty && target && target->is_valid() && !retained_textures_changed()) {
+        target->draw();
+        return;
+    }
+
+    // Controls drawing below set it again, e.g. for textures that are still loading.
+    retained_dirty = false;
+    retained_textures.clear();
+
+    // These would redraw the target every frame, and may draw other viewports in between.
+    if (is_continuous()) {
+        delete target;
+        target = nullptr;
+
+        draw_tree();
+        return;
+    }
+
+    if (!target) target = new CanvasTarget;
+
+    retaining = this;
+
+    target->begin(area);
+    draw_tree();
+    target->end();
+
+    retaining = nullptr;
+
+    target->draw();
+}
+
+void Control::add_retained_texture(Texture2D* p_texture) {
+    if (!retaining || !p_texture) return;
+
+    for (const RetainedTexture& entry : retaining->retained_textures)
+        if (entry.texture == p_texture) return;
+
+    retaining->retained_textures.push_back({p_texture, p_texture->get_generation()});
+}
+
+bool Control::retained_textures_changed() const {
+    // Checked only while no control in the subtree changed, so the textures are still in use.
+    for (const RetainedTexture& entry : retained_textures)
+        if (entry.texture->get_generation() != entry.generation) return true;
+
+    return false;
+}
+
+bool Control::is_continuous() {
+    if (!visible) return false;
+
+    if (update_continuoulsy) return true;
+
+    for (Node* n : children)
+        if (n->cast_to_type<Control*>()->is_continuous()) return true;
+
+    return false;
+}
+
 #define CHECK_DRAWING                                      \
     if (!drawing) {                                        \
         T_ERROR("Can only draw inside NOTIFICATION_DRAW"); \
@@ -445,87 +570,60 @@ void Control::update() {
     if (!visible) return;
 
     to_be_updated = true;
+    flag_dirty();
 }
 
 void Control::render_texture(const DrawCommand& p_draw_command) {
-    const DrawCommand& draw_command = p_draw_command;
-    SimpleMesh* mesh = MeshHandler::get_singleton()->get_plane();
-    Shader* shader = CanvasData::get_singleton()->get_default_shader();
-    Transform transform = Transform(draw_command.area.pos, draw_command.area.size);
+    // Drawn again once loaded.
+    if (!p_draw_command.tex->is_ready()) flag_dirty();
 
-    shader->bind();
-    shader->set_uniform("texbounds", draw_command.bounds);
-    shader->set_uniform("color", draw_command.color);
-    shader->set_uniform("texture_enabled", true);
+    add_retained_texture(p_draw_command.tex);
 
-    draw_command.tex->bind(0);
-
-    mat4 final = RENDERER->get_final_matrix() * transform.get_model();
-    shader->set_uniform("model", final);
-    mesh->bind();
-    mesh->draw();
+    CANVAS_BATCH->add_quad(p_draw_command.tex, p_draw_command.area, p_draw_command.bounds,
+                           p_draw_command.color);
 }
 
 void Control::render_font(const DrawCommand& p_draw_command) {
     const DrawCommand& draw_command = p_draw_command;
 
-    if (draw_command.font->get_renderer() == nullptr) return;
-
-    float offset = 0.0f;
-
-    vec2i parent_size = WINDOWSIZE;
-    vec2 delta;
-    vec2 pos = draw_command.pos;
-
-    pos = vec2(Math::floor(pos.x), Math::floor(pos.y)) + delta;
-
-    Texture2D* tex = draw_command.font->get_renderer()->get_texture();
-    SimpleMesh* mesh = MeshHandler::get_singleton()->get_plane();
-    Shader* shader = CanvasData::get_singleton()->get_default_shader();
     Font* font = draw_command.font;
+    GlyphCache* glyphs = font->get_glyphs();
 
-    shader->bind();
-    shader->set_uniform("color", draw_command.color);
-    shader->set_uniform("texture_enabled", true);
-
-    tex->bind(0);
-
-    for (int i = 0; i < draw_command.text.size(); i++) {
-        Char c = draw_command.text[i];
+    if (glyphs == nullptr) return;
 
-        if (c == ' ') {
-            offset += font->get_renderer()->get_space_offset();
-            continue;
-        }
-        if (c == '\t') {
-            offset += font->get_renderer()->get_tab_offset();
-            continue;
-        }
-        if (c < 33 || c > 126) {
-            offset += font->get_renderer()->get_space_offset();
-            continue;
-        }
-
-        vec4 bounds = font->get_renderer()->get_bounds(c);
-        vec4 b = vec4(bounds.x / tex->get_size().x, bounds.y / tex->get_size().x, 1, 0);
+    vec2 pos = draw_command.pos;
+    pos = vec2(Math::floor(pos.x), Math::floor(pos.y));
 
-        float delta = bounds.y - bounds.x;
+    for (const TextLayout::Glyph& glyph : font->get_layout(draw_command.text).glyphs) {
+        if (glyph.codepoint <= ' ') continue;
 
-        Transform transform = Transform(vec2(pos.x + offset + delta / 2.0f, pos.y),
-                                        vec2(delta, tex->get_size().y) / 2.0f);
+        const GlyphCache::Glyph* image = glyphs->get(glyph.codepoint);
 
-        shader->set_uniform("model", RENDERER->get_final_matrix() * transform.get_model());
-        shader->set_uniform("texbounds", b);
+        if (!image) continue;
 
-        mesh->draw();
+        rect2 glyph_area = rect2(vec2(pos.x + glyph.x + image->left + image->size.x / 2.0f, pos.y),
+                                 image->size / 2.0f);
 
-        offset += delta;
+        // Pages that did not fit in the atlas are drawn on their own.
+        if (glyphs->get_texture())
+            CANVAS_BATCH->add_quad(glyphs->get_texture(), glyph_area, image->bounds,
+                                   draw_command.color);
+        else
+            CANVAS_BATCH->add_atlas_quad(glyph_area, image->bounds, draw_command.color);
     }
 }
 
 void Control::render_box(const DrawCommand& p_draw_command) {
     const DrawCommand& draw_command = p_draw_command;
 
+    if (draw_command.shader == CanvasData::get_singleton()->get_default_shader()) {
+        CANVAS_BATCH->add_quad(nullptr, draw_command.area, vec4(0, 1, 0, 1), draw_command.color);
+        return;
+    }
+
+    // Custom shaders set their own uniforms, their boxes are drawn on their own.
+    CANVAS_BATCH->flush();
+
     SimpleMesh* mesh = MeshHandler::get_singleton()->get_plane();
     Shader* shader = draw_command.shader;
     Transform transform = Transform(draw_command.area.pos, draw_command.area.size);
@@ -534,89 +632,50 @@ void Control::render_box(const DrawCommand& p_draw_command) {
     shader->set_uniform("color", draw_command.color);
     shader->set_uniform("texture_enabled", false);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, 0);
 
     shader->set_uniform("model", RENDERER->get_final_matrix() * transform.get_model());
+    mesh->bind();
     mesh->draw();
 }
 
 void Control::render_frame(const DrawCommand& p_draw_command) {
     const DrawCommand& draw_command = p_draw_command;
 
+    if (!draw_command.tex->is_ready()) flag_dirty();
+
+    add_retained_texture(draw_command.tex);
+
     vec2 tex_size = draw_command.tex->get_size();
     vec2 size = draw_command.area.size;
 
     vec2 pos = draw_command.area.get_bottom_left();
     vec2 extension = {size.x * 2 - tex_size.x * 2 / 3, size.y * 2 - tex_size.x * 2 / 3};
 
-    Array<float> h_off = {0, tex_size.x / 3, 2 * tex_size.x / 3, tex_size.x};
-    Array<float> v_off = {0, tex_size.y / 3, 2 * tex_size.y / 3, tex_size.y};
-    Array<float> h_pos = {pos.x, pos.x + h_off[1], pos.x + extension.x + h_off[1],
-                          pos.x + extension.x + h_off[2]};
-    Array<float> v_pos = {pos.y, pos.y + v_off[1], pos.y + extension.y + v_off[1],
-                          pos.y + extension.y + v_off[2]};
-
-    SimpleMesh* mesh = MeshHandler::get_singleton()->get_plane();
-    Shader* shader = CanvasData::get_singleton()->get_default_shader();
-    Transform transform;
-
-    shader->bind();
-    shader->set_uniform("color", draw_command.color);
-    shader->set_uniform("texture_enabled", true);
-
-    draw_command.tex->bind(0);
-
-    mesh->bind();
+    float h_off[4] = {0, tex_size.x / 3, 2 * tex_size.x / 3, tex_size.x};
+    float v_off[4] = {0, tex_size.y / 3, 2 * tex_size.y / 3, tex_size.y};
+    float h_pos[4] = {pos.x, pos.x + h_off[1], pos.x + extension.x + h_off[1],
+                      pos.x + extension.x + h_off[2]};
+    float v_pos[4] = {pos.y, pos.y + v_off[1], pos.y + extension.y + v_off[1],
+                      pos.y + extension.y + v_off[2]};
 
     for (int x = 0; x < 3; x++) {
         for (int y = 0; y < 3; y++) {
-            vec2 horiz_bounds = vec2(h_off[x], h_off[x + 1]);
-            vec2 vert_bounds = vec2(v_off[y], v_off[y + 1]);
-
             rect2 new_area = rect2(h_pos[x], h_pos[x + 1], v_pos[y + 1], v_pos[y]);
 
-            vec4 b = vec4(horiz_bounds, vert_bounds);
-            vec4 bounds = vec4(vec2(b.x, b.y) / draw_command.tex->get_size().x,
-                               vec2(b.z, b.w) / draw_command.tex->get_size().y);
+            vec4 bounds = vec4(h_off[x] / tex_size.x, h_off[x + 1] / tex_size.x,
+                               v_off[y] / tex_size.y, v_off[y + 1] / tex_size.y);
 
-            transform = Transform(new_area.pos, new_area.size);
-
-            shader->set_uniform("texbounds", bounds);
-            shader->set_uniform("model", RENDERER->get_final_matrix() * transform.get_model());
-
-            mesh->draw();
+            CANVAS_BATCH->add_quad(draw_command.tex, new_area, bounds, draw_command.color);
         }
     }
 }
 
 void Control::render_line(const DrawCommand& p_draw_command) {
     const DrawCommand& draw_command = p_draw_command;
-    SimpleMesh* mesh = MeshHandler::get_singleton()->get_line();
-    Shader* shader = CanvasData::get_singleton()->get_default_shader();
-
-    // center-like coordinates
-    vec2 start = draw_command.area.get_bottom_left();
-    vec2 end = draw_command.area.get_upper_right();
-    vec2 delta = start - end;
-    vec2 center = (end + start) / 2.0f;
 
-    float angle = delta.angle(vec2(0, -1.0f));
-    float length = delta.length() / 2.0f;
-
-    Transform transform = Transform(center, vec2(1.0f, length), angle);
-
-    shader->bind();
-    shader->set_uniform("color", draw_command.color);
-    shader->set_uniform("texture_enabled", false);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    shader->set_uniform("model", RENDERER->get_final_matrix() * transform.get_model());
-    mesh->bind();
-    mesh->draw();
-
-    mesh = MeshHandler::get_singleton()->get_plane();
-    mesh->bind();
+    CANVAS_BATCH->add_line(draw_command.area.get_bottom_left(), draw_command.area.get_upper_right(),
+                           draw_command.color);
 }
 
 void Control::render_polygon(const DrawCommand& p_draw_command) {}
@@ -639,6 +698,9 @@ void Control::render_draw_command(const DrawCommand& p_draw_command) {
 }
 
 void Control::render() {
+    if (draw_commands.size() == 0) return;
+
+    // Changing the scissor flushes the batch.
     if (use_scissor) RENDERER->use_scissor(area);
 
     for (int c = 0; c < draw_commands.size(); c++) render_draw_command(draw_commands[c]);
@@ -8,6 +8,7 @@ class Texture2D;
 class Font;
 class Color;
 class Canvas;
+class CanvasTarget;
 class Shader;
 
 class Control : public Node {
@@ -15,6 +16,7 @@ class Control : public Node {
 
    public:
     Control();
+    ~Control();
 
     enum AnchorType { ANCHOR_BEGIN, ANCHOR_END, ANCHOR_CENTER, ANCHOR_CUSTOM };
 
@@ -111,6 +113,15 @@ class Control : public Node {
     void flag_size_changed();
     void size_changed();
 
+    // Keeps the drawn subtree in an offscreen target, which is reused until a control in it is
+    // updated, resized or hidden, or a texture it draws is uploaded again. Subtrees with
+    // continuously updated controls are drawn directly. Hiding the control frees the target.
+    void set_retained(bool p_retained);
+    bool get_retained() const;
+
+    // Outdates the targets of this control and its retained ancestors.
+    void flag_dirty();
+
     void set_tip_description(const String& p_description);
     String get_tip_description() const;
 
@@ -161,6 +172,19 @@ class Control : public Node {
    private:
     void render();
 
+    // Draws this control and its children without a target.
+    void draw_tree();
+    void draw_retained();
+
+    // True if a visible control in the subtree is updated continuously.
+    bool is_continuous();
+
+    // Remembers the GL texture of p_texture that the target being drawn into shows.
+    static void add_retained_texture(Texture2D* p_texture);
+
+    // True if a texture in the target was uploaded again since, e.g. by a hot reload.
+    bool retained_textures_changed() const;
+
     Array<DrawCommand> draw_commands;
 
     bool to_be_updated;
@@ -179,4 +203,18 @@ class Control : public Node {
     bool visible;
     bool enabled;
     bool flagged_size_changed;
+
+    bool retained;
+    bool retained_dirty;
+    CanvasTarget* target;
+
+    struct RetainedTexture {
+        Texture2D* texture;
+        unsigned generation;
+    };
+
+    Array<RetainedTexture> retained_textures;
+
+    // The control whose target is drawn into.
+    static Control* retaining;
 };
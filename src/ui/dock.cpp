@@ -24,6 +24,9 @@ Dock::Dock() {
     active = -1;
 
     tab_area, selectors_area = rect2();
+
+    // Docks mostly stay the same, they are drawn from a cached target until they change.
+    set_retained(true);
 }
 
 vec2 Dock::get_required_size() const { return vec2(150); }
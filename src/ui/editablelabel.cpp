@@ -3,6 +3,7 @@
 #include "input/cursor.h"
 #include "input/input.h"
 #include "ui/canvas.h"
+#include "utility/stringutils.h"
 
 EditableLabel::EditableLabel() : EditableLabel("") {}
 
@@ -123,7 +124,7 @@ void EditableLabel::handle_event(UIEvent* ui_event) {
         case UIEvent::TEXT_INPUT:
             if (selecting) delete_selection();
 
-            handle_input(ui_event->text[0]);
+            handle_input(ui_event->text);
             break;
 
         case UIEvent::KEY_PRESS:
@@ -227,9 +228,10 @@ void EditableLabel::handle_event(UIEvent* ui_event) {
 
                         if (selecting)
                             delete_selection();
-                        else {
-                            remove_at_index(cursor_index - 1);
-                            move_cursor_left();
+                        else if (cursor_index > 0) {
+                            int previous = get_previous_index(cursor_index);
+                            remove_at_index(previous, cursor_index - previous);
+                            set_cursor_index(previous);
                         }
 
                         break;
@@ -241,7 +243,8 @@ void EditableLabel::handle_event(UIEvent* ui_event) {
                         if (selecting)
                             delete_selection();
                         else
-                            remove_at_index(cursor_index);
+                            remove_at_index(cursor_index,
+                                            get_next_index(cursor_index) - cursor_index);
                         set_cursor_index(cursor_index);
 
                         break;
@@ -285,9 +288,35 @@ void EditableLabel::move_cursor_begin() { set_cursor_index(0); }
 
 void EditableLabel::move_cursor_end() { set_cursor_index(get_text().size()); }
 
-void EditableLabel::move_cursor_left() { set_cursor_index(cursor_index - 1); }
+void EditableLabel::move_cursor_left() { set_cursor_index(get_previous_index(cursor_index)); }
+
+void EditableLabel::move_cursor_right() { set_cursor_index(get_next_index(cursor_index)); }
+
+int EditableLabel::get_previous_index(int p_index) const {
+    // Decodes from the start, so invalid bytes step the same way in both directions.
+    const char* begin = text.c_str();
+    const char* end = begin + text.size();
+    const char* current = begin;
+    int previous = 0;
+
+    while (current < end && current - begin < p_index) {
+        previous = int(current - begin);
+
+        uint32_t codepoint;
+        current = StringUtils::decode_utf8(current, end, codepoint);
+    }
 
-void EditableLabel::move_cursor_right() { set_cursor_index(cursor_index + 1); }
+    return previous;
+}
+
+int EditableLabel::get_next_index(int p_index) const {
+    if (p_index >= int(text.size())) return text.size();
+
+    const char* begin = text.c_str();
+    uint32_t codepoint;
+
+    return int(StringUtils::decode_utf8(begin + p_index, begin + text.size(), codepoint) - begin);
+}
 
 void EditableLabel::set_cursor_index(int p_cursor_index) {
     cursor_index = p_cursor_index;
@@ -316,10 +345,10 @@ void EditableLabel::insert_at_index(int index, const String& kar) {
     set_text(get_text().insert(index, kar));
 }
 
-void EditableLabel::remove_at_index(int index) {
+void EditableLabel::remove_at_index(int index, int p_length) {
     if (index < 0 || index > get_text().size() + 1) return;
 
-    set_text(get_text().erase(index, 1));
+    set_text(get_text().erase(index, p_length));
 }
 
 bool EditableLabel::cursor_is_at_end() { return cursor_index == get_text().size(); }
@@ -361,7 +390,7 @@ int EditableLabel::get_index(float x) const {
 float EditableLabel::get_position_x(int index) const {
     float origin_x = area.get_left() + start_margin;
     Font* f = CanvasData::get_singleton()->get_default_theme()->get_font();
-    return (origin_x + (float)f->get_width(text.substr(0, index)));
+    return (origin_x + f->get_offset(text, index));
 }
 
 void EditableLabel::select_all() {
@@ -404,12 +433,12 @@ void EditableLabel::update_selection_box() {
     update();
 }
 
-void EditableLabel::insert_at_selection(char c) {
-    insert_at_index(cursor_index, c);
-    move_cursor_right();
+void EditableLabel::insert_at_selection(const String& p_text) {
+    insert_at_index(cursor_index, p_text);
+    set_cursor_index(cursor_index + p_text.size());
 }
 
-void EditableLabel::handle_input(char c) { insert_at_selection(c); }
+void EditableLabel::handle_input(const String& p_text) { insert_at_selection(p_text); }
 
 #undef CLASSNAME
 #define CLASSNAME EditableLabel
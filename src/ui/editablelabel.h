@@ -30,9 +30,13 @@ class EditableLabel : public PropertyControl {
     void move_cursor_right();
     void set_cursor_index(int p_cursor_index);
 
+    // Byte index of the code point before and after p_index.
+    int get_previous_index(int p_index) const;
+    int get_next_index(int p_index) const;
+
     void insert_at_index(int index, char kar);
     void insert_at_index(int index, const String& kar);
-    void remove_at_index(int index);
+    void remove_at_index(int index, int p_length = 1);
 
     bool cursor_is_at_end();
 
@@ -60,9 +64,10 @@ class EditableLabel : public PropertyControl {
     static void bind_methods();
 
    protected:
-    void insert_at_selection(char c);
+    void insert_at_selection(const String& p_text);
 
-    virtual void handle_input(char c);
+    // Receives the UTF-8 text of one input event.
+    virtual void handle_input(const String& p_text);
 
     String text;
     String empty_text;
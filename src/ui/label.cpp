@@ -27,7 +27,7 @@ int Label::get_index(float x) const {
 }
 float Label::get_position_x(int index) const {
     float origin_x = area.get_left();
-    return (origin_x + (float)get_font()->get_width(text.substr(0, index)));
+    return (origin_x + get_font()->get_offset(text, index));
 }
 
 void Label::set_centering_type(const Image::CenteringType& centering_type) {
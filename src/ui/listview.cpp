@@ -48,7 +48,7 @@ int ListElement::get_index(float x) const {
 }
 float ListElement::get_position_x(int index) const {
     float origin_x = area.get_left();
-    return (origin_x + (float)listview->get_font()->get_width(text.substr(0, index)));
+    return (origin_x + listview->get_font()->get_offset(text, index));
 }
 
 //=========================================================================
@@ -36,7 +36,7 @@ void NumberField::notification(int p_notification) {
     }
 }
 
-void NumberField::handle_input(char c) { insert_at_selection(c); }
+void NumberField::handle_input(const String& p_text) { insert_at_selection(p_text); }
 
 void NumberField::set_text(const String& p_text) {
     text = p_text;
@@ -16,7 +16,7 @@ class NumberField : public EditableLabel {
 
     void notification(int p_notification) override;
 
-    void handle_input(char c) override;
+    void handle_input(const String& p_text) override;
     void set_text(const String& p_text) override;
 
     void value_changed() override;
@@ -2,7 +2,12 @@
 
 #include "dock.h"
 
-Tab::Tab() { title = ""; }
+Tab::Tab() {
+    title = "";
+
+    // Used when the dock around it can not be retained.
+    set_retained(true);
+}
 
 Tab::~Tab() {}
 
@@ -54,7 +54,7 @@ int TextLine::get_index(float x) const {
 }
 float TextLine::get_position_x(int index) const {
     float origin_x = area.get_left();
-    return (origin_x + (float)textbox->get_font()->get_width(text.substr(0, index)));
+    return (origin_x + textbox->get_font()->get_offset(text, index));
 }
 
 //=========================================================================
@@ -468,7 +468,7 @@ void TextBox::notification(int p_notification) {
                     draw_text(font, c, vec2(area.get_left() + 4, lines[c].get_area().pos.y),
                               line_numbers_color);
 
-                float offset = lines[c].get_area().get_left();
+                float left = lines[c].get_area().get_left();
 
                 for (int s = 0; s < lines[c].styles.size(); s++) {
                     const TextStyle& style = lines[c].styles[s];
@@ -478,8 +478,10 @@ void TextBox::notification(int p_notification) {
 
                     String src = lines[c].get_text().substr(style.start, end - style.start + 1);
 
+                    // Placed by the layout of the whole line, like the cursor.
+                    float offset = left + font->get_offset(lines[c].get_text(), style.start);
+
                     draw_text(font, src, vec2(offset, lines[c].get_area().pos.y), style.color);
-                    offset += font->get_width(src);
                 }
             }
             if (line_numbers_enabled)
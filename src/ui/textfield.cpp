@@ -44,7 +44,7 @@ void TextField::value_changed() {
     if (v.type == Variant::FLOAT) set_text(v.ToString());
 }
 
-void TextField::handle_input(char c) { insert_at_selection(c); }
+void TextField::handle_input(const String& p_text) { insert_at_selection(p_text); }
 
 void TextField::set_text(const String& p_text) {
     text = p_text;
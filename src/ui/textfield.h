@@ -18,7 +18,7 @@ class TextField : public EditableLabel {
 
     void value_changed() override;
 
-    void handle_input(char c) override;
+    void handle_input(const String& p_text) override;
     void set_text(const String& p_text) override;
 
     static void bind_methods();
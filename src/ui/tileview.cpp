@@ -51,7 +51,7 @@ int TileElement::get_index(float x) const {
 }
 float TileElement::get_position_x(int index) const {
     float origin_x = area.get_left();
-    return (origin_x + (float)tileview->get_font()->get_width(text.substr(0, index)));
+    return (origin_x + tileview->get_font()->get_offset(text, index));
 }
 
 //=========================================================================
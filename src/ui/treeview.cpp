@@ -139,7 +139,7 @@ int TreeElement::get_index(float x) const {
 }
 float TreeElement::get_position_x(int index) const {
     float origin_x = area.get_left();
-    return (origin_x + (float)treeview->get_font()->get_width(text.substr(0, index)));
+    return (origin_x + treeview->get_font()->get_offset(text, index));
 }
 
 void TreeElement::set_expanded(bool p_expanded) {
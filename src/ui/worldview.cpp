@@ -1,6 +1,7 @@
 #include "worldview.h"
 
 #include "core/windowmanager.h"
+#include "graphics/canvasbatch.h"
 #include "graphics/renderer.h"
 #include "graphics/view.h"
 #include "input/keyboard.h"
@@ -522,6 +523,9 @@ void WorldView::post_draw_world() {
         render_box(command);
         command.area = rect2(item_pos + offset * vec2(-1, 1), handle_size);
         render_box(command);
+
+        // Drawn into the world pass, before the raycast buffer is bound.
+        CANVAS_BATCH->flush();
     }
 
     // draw transformation handles
@@ -545,7 +549,6 @@ void WorldView::post_draw_world() {
     }
 
     raycast_shader->bind();
-    raycast_shader->set_uniform("view", RENDERER->get_final_matrix());
 
     raycast_shader->set_uniform("model", t1.get_model());
     plane->bind();
@@ -753,6 +756,22 @@ void WorldView::set_transform_type(int p_transform_type) {
 int WorldView::get_transform_type() const { return transform_type; }
 
 void WorldView::set_simulating(bool p_simulating) {
+    if (simulating != p_simulating && get_scene()) {
+        Stopwatch watch;
+        watch.start();
+
+        if (p_simulating) {
+            snapshot.capture(get_scene());
+
+            T_LOG("Captured " + String(snapshot.get_object_count()) + " objects (" +
+                  String(int(snapshot.get_size())) + " bytes) in " +
+                  String(watch.stop() * 1000.0f) + " ms");
+        } else if (snapshot.restore(get_scene())) {
+            T_LOG("Restored " + String(snapshot.get_object_count()) + " objects in " +
+                  String(watch.stop() * 1000.0f) + " ms");
+        }
+    }
+
     simulating = p_simulating;
     display_mode = DISPLAY_WORLD;
 }
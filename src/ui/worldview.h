@@ -1,6 +1,7 @@
 #pragma once
 
 #include "control.h"
+#include "core/snapshot.h"
 #include "graphics/viewport.h"
 
 class Model;
@@ -106,5 +107,8 @@ class WorldView : public Control {
 
     bool simulating;
 
+    // State of the scene before simulating, restored when play mode is left.
+    Snapshot snapshot;
+
     int preview_type;
 };
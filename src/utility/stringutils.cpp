@@ -1,6 +1,7 @@
 #include "stringutils.h"
 
-#include <iomanip>
+#include <cctype>
+#include <charconv>
 #include <iostream>
 
 #include "core/string.h"
@@ -104,17 +105,143 @@ String StringUtils::CharToString(const char c) {
     return s;
 }
 String StringUtils::FloatToString(const float f) {
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(3) << f;
+    char buffer[NUMBER_SIZE];
+    char* end = format_fixed(buffer, f, 3);
+
+    // 2.500 becomes 2.5 and 2.000 becomes 2.
+    while (end > buffer && end[-1] == '0') end--;
+    if (end > buffer && end[-1] == '.') end--;
+
+    return std::string(buffer, end);
+}
+String StringUtils::IntToString(int i) {
+    char buffer[NUMBER_SIZE];
+    return std::string(buffer, format_int(buffer, i));
+}
+float StringUtils::StringToFloat(const String& s) {
+    float value = 0.0f;
+    parse_float(s.c_str(), s.c_str() + s.size(), value);
+    return value;
+}
+
+char* StringUtils::format_float(char* p_buffer, float p_value) {
+    std::to_chars_result r = std::to_chars(p_buffer, p_buffer + NUMBER_SIZE, p_value);
+    return r.ec == std::errc() ? r.ptr : p_buffer;
+}
+
+char* StringUtils::format_float(char* p_buffer, float p_value, int p_digits) {
+    std::to_chars_result r = std::to_chars(p_buffer, p_buffer + NUMBER_SIZE, p_value,
+                                           std::chars_format::general, p_digits);
+    return r.ec == std::errc() ? r.ptr : p_buffer;
+}
+
+char* StringUtils::format_fixed(char* p_buffer, float p_value, int p_decimals) {
+    std::to_chars_result r = std::to_chars(p_buffer, p_buffer + NUMBER_SIZE, p_value,
+                                           std::chars_format::fixed, p_decimals);
+    return r.ec == std::errc() ? r.ptr : p_buffer;
+}
+
+char* StringUtils::format_int(char* p_buffer, long long p_value) {
+    return std::to_chars(p_buffer, p_buffer + NUMBER_SIZE, p_value).ptr;
+}
+
+namespace {
+// Leading whitespace and a '+' sign, which from_chars does not accept.
+const char* skip_prefix(const char* p_begin, const char* p_end) {
+    while (p_begin < p_end && isspace((unsigned char)*p_begin)) p_begin++;
+    if (p_begin < p_end && *p_begin == '+') p_begin++;
+
+    return p_begin;
+}
+}  // namespace
+
+const char* StringUtils::parse_float(const char* p_begin, const char* p_end, float& r_value) {
+    const char* start = skip_prefix(p_begin, p_end);
+
+    std::from_chars_result r = std::from_chars(start, p_end, r_value);
+    return r.ec == std::errc() ? r.ptr : p_begin;
+}
 
-    std::string str = ss.str();
-    str.erase(str.find_last_not_of('0') + 1, std::string::npos);
-    str.erase(str.find_last_not_of('.') + 1, std::string::npos);
+const char* StringUtils::parse_int(const char* p_begin, const char* p_end, int& r_value) {
+    const char* start = skip_prefix(p_begin, p_end);
+
+    std::from_chars_result r = std::from_chars(start, p_end, r_value);
+    return r.ec == std::errc() ? r.ptr : p_begin;
+}
+
+const char* StringUtils::decode_utf8(const char* p_begin, const char* p_end,
+                                     uint32_t& r_codepoint) {
+    const uint32_t REPLACEMENT = 0xFFFD;
+    unsigned char first = (unsigned char)*p_begin;
+
+    int length;
+    uint32_t minimum;
+
+    if (first < 0x80) {
+        r_codepoint = first;
+        return p_begin + 1;
+    } else if ((first & 0xE0) == 0xC0) {
+        length = 2;
+        minimum = 0x80;
+        r_codepoint = first & 0x1F;
+    } else if ((first & 0xF0) == 0xE0) {
+        length = 3;
+        minimum = 0x800;
+        r_codepoint = first & 0x0F;
+    } else if ((first & 0xF8) == 0xF0) {
+        length = 4;
+        minimum = 0x10000;
+        r_codepoint = first & 0x07;
+    } else {
+        r_codepoint = REPLACEMENT;
+        return p_begin + 1;
+    }
+
+    if (p_end - p_begin < length) {
+        r_codepoint = REPLACEMENT;
+        return p_begin + 1;
+    }
+
+    for (int c = 1; c < length; c++) {
+        unsigned char next = (unsigned char)p_begin[c];
+
+        if ((next & 0xC0) != 0x80) {
+            r_codepoint = REPLACEMENT;
+            return p_begin + 1;
+        }
+
+        r_codepoint = r_codepoint << 6 | (next & 0x3F);
+    }
+
+    // Overlong forms, surrogates and values past the last plane.
+    if (r_codepoint < minimum || (r_codepoint >= 0xD800 && r_codepoint <= 0xDFFF) ||
+        r_codepoint > 0x10FFFF) {
+        r_codepoint = REPLACEMENT;
+        return p_begin + 1;
+    }
+
+    return p_begin + length;
+}
+
+char* StringUtils::encode_utf8(char* p_buffer, uint32_t p_codepoint) {
+    if (p_codepoint < 0x80) {
+        *p_buffer++ = char(p_codepoint);
+    } else if (p_codepoint < 0x800) {
+        *p_buffer++ = char(0xC0 | p_codepoint >> 6);
+        *p_buffer++ = char(0x80 | (p_codepoint & 0x3F));
+    } else if (p_codepoint < 0x10000) {
+        *p_buffer++ = char(0xE0 | p_codepoint >> 12);
+        *p_buffer++ = char(0x80 | (p_codepoint >> 6 & 0x3F));
+        *p_buffer++ = char(0x80 | (p_codepoint & 0x3F));
+    } else {
+        *p_buffer++ = char(0xF0 | p_codepoint >> 18);
+        *p_buffer++ = char(0x80 | (p_codepoint >> 12 & 0x3F));
+        *p_buffer++ = char(0x80 | (p_codepoint >> 6 & 0x3F));
+        *p_buffer++ = char(0x80 | (p_codepoint & 0x3F));
+    }
 
-    return str;
+    return p_buffer;
 }
-String StringUtils::IntToString(int i) { return std::to_string(i); }
-float StringUtils::StringToFloat(const String& s) { return std::stof(s); }
 
 String StringUtils::MultiplyString(const String& src, const int i) {
     String res = "";
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 
@@ -35,6 +36,27 @@ class StringUtils {
 
     static float StringToFloat(const String& d);
 
+    // Locale independent and without allocations, p_buffer must hold NUMBER_SIZE characters and
+    // the end of the written text is returned. Without a precision, floats are written as the
+    // shortest text that parses back to exactly the same value.
+    static char* format_float(char* p_buffer, float p_value);
+    static char* format_float(char* p_buffer, float p_value, int p_digits);
+    static char* format_fixed(char* p_buffer, float p_value, int p_decimals);
+    static char* format_int(char* p_buffer, long long p_value);
+
+    // Skips leading whitespace and a '+', returns p_begin when there is no number.
+    static const char* parse_float(const char* p_begin, const char* p_end, float& r_value);
+    static const char* parse_int(const char* p_begin, const char* p_end, int& r_value);
+
+    static const int NUMBER_SIZE = 64;
+
+    // Decodes the code point starting at p_begin and returns the byte after it. Invalid or
+    // truncated sequences decode to U+FFFD and take one byte.
+    static const char* decode_utf8(const char* p_begin, const char* p_end, uint32_t& r_codepoint);
+
+    // Writes at most four bytes and returns the end of the written text.
+    static char* encode_utf8(char* p_buffer, uint32_t p_codepoint);
+
     static String MultiplyString(const String& src, const int i);
 
     static String Trim(const String& src);
@@ -1,7 +1,12 @@
 #include "mesh.h"
 
 #include "core/contentmanager.h"
+#include "core/time.h"
+#include "graphics/glstate.h"
 #include "graphics/renderer.h"
+#include "graphics/renderqueue.h"
+#include "meshcache.h"
+#include "meshiosystem.h"
 #include "model.h"
 #include "resources/file.h"
 
@@ -24,7 +29,7 @@ void SimpleMesh::init(const Array<Vertex>& p_vertices, const Array<Face>& p_face
     for (int c = 0; c < p_faces.size(); c++) faces[c] = p_faces[c];
 
     glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices_count, &vertices[0], GL_STATIC_DRAW);
 
     glGenBuffers(1, &EBO);
@@ -101,12 +106,12 @@ void SimpleMesh::SetAttributes(Shader* shader) {
 }
 
 void SimpleMesh::bind() {
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, VBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 }
 
 void SimpleMesh::unbind() {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
@@ -132,6 +137,10 @@ void SimpleMesh::draw_instanced(int p_count) {
 // Mesh
 //=========================================================================
 
+const unsigned Mesh::IMPORT_FLAGS = aiProcess_FlipUVs | aiProcess_Triangulate |
+                                   aiProcess_JoinIdenticalVertices | aiProcess_SortByPType |
+                                   aiProcess_GenSmoothNormals;
+
 Mesh::Mesh() {}
 
 Mesh::Mesh(const String& p_path) {
@@ -139,85 +148,204 @@ Mesh::Mesh(const String& p_path) {
     import(p_path);
 }
 
-Mesh::~Mesh() {
-    // glDeleteBuffers(1, &VBO);
-    // glDeleteBuffers(1, &EBO);
-}
+Mesh::~Mesh() { free(); }
 
 BoundingBox Mesh::get_bounding_box(Mesh* p_mesh, const mat4& p_transform) {
     BoundingBox box;
+    bool empty = true;
 
+    // The boxes of the nodes, which are kept when their vertex arrays are not.
     for (int c = 0; c < p_mesh->meshes.size(); c++) {
         MeshNode* node = p_mesh->meshes[c];
+        if (node->vertex_count == 0) continue;
 
-        for (int t = 0; t < node->vertices.size(); ++t) {
-            vec3 tmp = node->vertices[t].position;
-
-            box.min.x = MIN(box.min.x, tmp.x);
-            box.min.y = MIN(box.min.y, tmp.y);
-            box.min.z = MIN(box.min.z, tmp.z);
-
-            box.max.x = MAX(box.max.x, tmp.x);
-            box.max.y = MAX(box.max.y, tmp.y);
-            box.max.z = MAX(box.max.z, tmp.z);
-        }
+        // Starting from the first node, so the box does not always contain the origin.
+        box = empty ? node->bounds : box.merged(node->bounds);
+        empty = false;
     }
 
     return box;
 }
 
+Mesh::Mesh(const String& p_path, const aiScene* p_scene) {
+    file = p_path;
+    build(p_scene);
+}
+
+const aiScene* Mesh::read(Assimp::Importer& p_importer, const String& p_filepath) {
+    // Loose and archived files alike, the IO system records what the import opens for the mesh
+    // cache.
+    p_importer.SetIOHandler(new MeshIOSystem);
+
+    return p_importer.ReadFile(File(p_filepath).get_absolute_path(), IMPORT_FLAGS);
+}
+
 bool Mesh::import(const String& p_filepath) {
+    Stopwatch watch;
+    watch.start();
+
+    MeshCache cache(p_filepath);
+
+    if (cache.open() && cache.build(this)) {
+        T_LOG("Loaded " + get_file() + " from the mesh cache in " +
+              String(watch.stop() * 1000.0f) + " ms");
+        return true;
+    }
+
     Assimp::Importer importer;
 
-    const aiScene* scene = importer.ReadFile(
-        p_filepath, aiProcess_FlipUVs | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices |
-                        aiProcess_SortByPType | aiProcess_GenSmoothNormals);
+    const aiScene* scene = read(importer, p_filepath);
 
     if (!scene) {
         T_ERROR(importer.GetErrorString());
         return false;
     }
 
-    for (unsigned c = 0; c < scene->mNumMeshes; c++) {
+    bool result = build(scene);
+    float import_time = watch.stop();
+
+    if (result) cache.save(this, importer);
+
+    T_LOG("Imported " + get_file() + " in " + String(import_time * 1000.0f) + " ms, cached in " +
+          String((watch.stop() - import_time) * 1000.0f) + " ms");
+
+    return result;
+}
+
+bool Mesh::build(const aiScene* p_scene) {
+    placeholder = nullptr;
+
+    for (unsigned c = 0; c < p_scene->mNumMeshes; c++) {
         MeshNode* node = new MeshNode;
-        node->init(scene->mMeshes[c]);
+        node->init(p_scene->mMeshes[c]);
         node->parent = this;
         meshes.push_back(node);
     }
 
-    for (unsigned c = 0; c < scene->mNumTextures; c++)
-        textures.push_back(new Texture2D(scene->mTextures[c]));
+    for (unsigned c = 0; c < p_scene->mNumTextures; c++)
+        textures.push_back(new Texture2D(p_scene->mTextures[c]));
 
-    for (unsigned c = 0; c < scene->mNumMaterials; c++) {
+    for (unsigned c = 0; c < p_scene->mNumMaterials; c++) {
         Material* material = new Material;
         material->mesh = this;
-        material->load_material(scene->mMaterials[c]);
+        material->load_material(p_scene->mMaterials[c]);
         materials.push_back(material);
     }
 
     for (int c = 0; c < meshes.size(); c++) {
         unsigned mat_index = meshes[c]->mat_index;
         meshes[c]->material = materials[mat_index];
-
-        bounding_box = get_bounding_box(this, mat4());
     }
 
+    set_bounding_box(get_bounding_box(this, mat4()));
+
     return true;
 }
 
-void Mesh::draw() {
+void Mesh::reload() {
+    Mesh reloaded;
+    reloaded.set_file(file);
+
+    if (!reloaded.import(file)) return;
+
+    // Shaders are assigned to the materials after loading, carry them over.
+    for (int c = 0; c < reloaded.materials.size() && c < materials.size(); c++)
+        reloaded.materials[c]->set_shader(materials[c]->get_shader());
+
+    free();
+
+    meshes = reloaded.meshes;
+    materials = reloaded.materials;
+    textures = reloaded.textures;
+    set_bounding_box(reloaded.bounding_box);
+
+    for (int c = 0; c < meshes.size(); c++) meshes[c]->parent = this;
+    for (int c = 0; c < materials.size(); c++) materials[c]->mesh = this;
+
+    // The nodes belong to this mesh now.
+    reloaded.meshes = Vector<MeshNode>();
+    reloaded.materials = Vector<Material>();
+    reloaded.textures = Vector<Texture2D>();
+}
+
+void Mesh::free() {
+    for (MeshNode* node : meshes) {
+        GLSTATE->delete_vertex_array(node->VAO);
+        GLSTATE->delete_buffer(node->VBO);
+        GLSTATE->delete_buffer(node->EBO);
+    }
+
+    meshes.clean();
+    materials.clean();
+    textures.clean();
+}
+
+void Mesh::draw(const Model* p_model) {
+    if (placeholder) {
+        placeholder->draw();
+        return;
+    }
+
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
     glEnableVertexAttribArray(2);
 
-    for (MeshNode* mesh : meshes) mesh->draw();
+    for (MeshNode* node : meshes)
+        node->draw(p_model ? p_model->get_material(node->mat_index) : node->material);
 
     glDisableVertexAttribArray(0);
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(2);
 }
 
-BoundingBox Mesh::get_bounding_box() const { return bounding_box; }
+void Mesh::collect(RenderQueue& r_queue, DrawPacket p_packet, const Model* p_model) {
+    if (placeholder) {
+        placeholder->collect(r_queue, p_packet);
+        return;
+    }
+
+    for (MeshNode* node : meshes) {
+        p_packet.material = p_model ? p_model->get_material(node->mat_index) : node->material;
+        p_packet.texture = p_packet.material ? p_packet.material->get_diffuse_texture() : nullptr;
+        p_packet.vao = node->VAO;
+        p_packet.index_count = node->face_count * 3;
+
+        r_queue.add(p_packet);
+    }
+}
+
+void Mesh::set_placeholder(Mesh* p_placeholder) { placeholder = p_placeholder; }
+
+void Mesh::set_bounding_box(const BoundingBox& p_bounding_box) {
+    bounding_box = p_bounding_box;
+
+    for (int c = 0; c < models.size(); c++) models[c]->update_bounds();
+}
+
+bool Mesh::is_ready() const { return !placeholder; }
+
+size_t Mesh::get_cpu_size() const {
+    size_t result = 0;
+
+    for (const MeshNode* node : meshes)
+        result += node->vertices.size() * sizeof(Vertex) + node->faces.size() * sizeof(Face) +
+                  node->colors.size() * sizeof(Color);
+
+    return result;
+}
+
+size_t Mesh::get_gpu_size() const {
+    size_t result = 0;
+
+    for (const MeshNode* node : meshes)
+        result += node->vertex_count * sizeof(Vertex) + node->face_count * sizeof(Face);
+
+    return result;
+}
+
+BoundingBox Mesh::get_bounding_box() const {
+    return placeholder ? placeholder->get_bounding_box() : bounding_box;
+}
 
 Array<Variant> Mesh::get_materials() const {
     Array<Variant> v;
@@ -227,7 +355,29 @@ Array<Variant> Mesh::get_materials() const {
     return v;
 }
 
-void Mesh::set_materials(const Array<Variant>& p_materials) {}
+void Mesh::set_materials(const Array<Variant>& p_materials) {
+    Vector<Material> replaced = materials;
+    materials = Vector<Material>();
+
+    for (const Variant& v : p_materials) {
+        Object* object = v.type == Variant::OBJECT ? static_cast<Object*>(v) : nullptr;
+        Material* material = object ? object->cast_to_type<Material*>() : nullptr;
+        if (!material) continue;
+
+        material->mesh = this;
+        materials.push_back(material);
+    }
+
+    for (Material* material : replaced)
+        if (materials.getindex(material) == -1) delete material;
+
+    for (MeshNode* node : meshes)
+        node->material = node->mat_index < unsigned(materials.size()) ? materials[node->mat_index]
+                                                                      : nullptr;
+
+    // The copies of the models were made from the old materials.
+    for (Model* model : models) model->materials.clear();
+}
 
 #undef CLASSNAME
 #define CLASSNAME Mesh
@@ -243,29 +393,32 @@ void Mesh::bind_methods() {
 // MeshNode
 //=========================================================================
 
-void Mesh::MeshNode::draw() {
-    glBindVertexArray(VAO);
+void Mesh::MeshNode::draw(Material* p_material) {
+    GLSTATE->bind_vertex_array(VAO);
 
-    if (material) {
-        if (material->get_diffuse_texture()) {
+    if (p_material) {
+        if (p_material->get_diffuse_texture()) {
             RENDERER->use_blending();
-            material->get_shader()->set_uniform("texture_enabled", true);
-            material->get_diffuse_texture()->bind(0);
+            p_material->get_shader()->set_uniform("texture_enabled", true);
+            p_material->get_diffuse_texture()->bind(0);
         } else {
-            material->get_shader()->set_uniform("texture_enabled", false);
+            p_material->get_shader()->set_uniform("texture_enabled", false);
         }
     }
 
     RENDERER->use_blending();
 
-    glDrawElements(GL_TRIANGLES, faces.size() * 3, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, face_count * 3, GL_UNSIGNED_INT, 0);
 
-    glBindVertexArray(0);
+    GLSTATE->bind_vertex_array(0);
 }
 
 void Mesh::MeshNode::init(aiMesh* p_mesh) {
     mat_index = p_mesh->mMaterialIndex;
 
+    vertices.reserve(p_mesh->mNumVertices);
+    faces.reserve(p_mesh->mNumFaces);
+
     // add vertices
     for (GLuint i = 0; i < p_mesh->mNumVertices; i++) {
         Vertex vertex;
@@ -280,6 +433,9 @@ void Mesh::MeshNode::init(aiMesh* p_mesh) {
         vertex.normal = vec3(n.x, n.y, n.z);
         vertex.texcoords = vec2(t.x, t.y - 1.0);
 
+        if (i == 0) bounds = {vertex.position, vertex.position};
+        bounds = bounds.merged({vertex.position, vertex.position});
+
         vertices.push_back(vertex);
     }
 
@@ -292,20 +448,24 @@ void Mesh::MeshNode::init(aiMesh* p_mesh) {
         faces.push_back(face);
     }
 
-    setup_buffers();
+    setup_buffers(vertices.data(), vertices.size(), faces.data(), faces.size());
 }
 
-void Mesh::MeshNode::setup_buffers() {
+void Mesh::MeshNode::setup_buffers(const Vertex* p_vertices, unsigned p_vertex_count,
+                                   const Face* p_faces, unsigned p_face_count) {
+    vertex_count = p_vertex_count;
+    face_count = p_face_count;
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    GLSTATE->bind_vertex_array(VAO);
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(Vertex), p_vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, faces.size() * sizeof(Face), &faces[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_count * sizeof(Face), p_faces, GL_STATIC_DRAW);
 
     // Vertex Positions
     glEnableVertexAttribArray(0);
@@ -321,7 +481,7 @@ void Mesh::MeshNode::setup_buffers() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
                           (void*)offsetof(Vertex, texcoords));
 
-    glBindVertexArray(0);
+    GLSTATE->bind_vertex_array(0);
 }
 
 //=========================================================================
@@ -382,20 +542,29 @@ void Material::load_material(const aiMaterial* p_material) {
 }
 
 Texture2D* Material::load_texture(const aiMaterial* p_material, const aiTextureType& p_type) {
+    String path = get_texture_path(mesh->get_file(), p_material, p_type);
+
+    if (path.size() == 0) return nullptr;
+
+    // Held in a Ref by the material.
+    return CONTENT->LoadTexture(path, false);
+}
+
+String Material::get_texture_path(const File& p_mesh_file, const aiMaterial* p_material,
+                                  const aiTextureType& p_type) {
     if (p_material->GetTextureCount(p_type) > 0) {
         aiString Path;
 
         if (p_material->GetTexture(p_type, 0, &Path, NULL, NULL, NULL, NULL, NULL) == AI_SUCCESS) {
-            File f = mesh->get_file();
+            File f = p_mesh_file;
             f.go_up();
             String p = String(Path.C_Str());
             p.remove('/');
-            String path = f.operator String() + "/" + p;
 
-            return CONTENT->LoadTexture(path);
+            return f.operator String() + "/" + p;
         }
     }
-    return nullptr;
+    return String();
 }
 
 #undef CLASSNAME
@@ -407,11 +576,11 @@ Shader* Material::get_shader() const { return shader; }
 
 String Material::get_name() const { return name; }
 
-void Material::set_diffuse_color(const Color& p_color) {}
+void Material::set_diffuse_color(const Color& p_color) { diffuse_color = p_color; }
 
 Color Material::get_diffuse_color() const { return diffuse_color; }
 
-void Material::set_specular_color(const Color& p_color) {}
+void Material::set_specular_color(const Color& p_color) { specular_color = p_color; }
 
 Color Material::get_specular_color() const { return specular_color; }
 
@@ -423,7 +592,7 @@ void Material::set_emissive_color(const Color& p_color) { emissive_color = p_col
 
 Color Material::get_emissive_color() const { return emissive_color; }
 
-void Material::set_shininess(float p_shininess) {}
+void Material::set_shininess(float p_shininess) { shininess = p_shininess; }
 
 float Material::get_shininess() const { return shininess; }
 
@@ -435,6 +604,27 @@ Texture2D* Material::get_ambient_texture() const { return ambient_texture; }
 
 Mesh* Material::get_mesh() const { return mesh; }
 
+Material* Material::duplicate() const {
+    Material* copy = new Material;
+
+    copy->name = name;
+    copy->shader = shader;
+    copy->mesh = mesh;
+
+    copy->diffuse_texture = diffuse_texture;
+    copy->specular_texture = specular_texture;
+    copy->ambient_texture = ambient_texture;
+
+    copy->diffuse_color = diffuse_color;
+    copy->specular_color = specular_color;
+    copy->ambient_color = ambient_color;
+    copy->emissive_color = emissive_color;
+
+    copy->shininess = shininess;
+
+    return copy;
+}
+
 #undef CLASSNAME
 #define CLASSNAME Material
 
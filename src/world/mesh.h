@@ -23,16 +23,14 @@
 #include "sdl.h"
 #endif
 
+#include "math/boundingbox.h"
 #include "resources/shader.h"
 #include "resources/texture.h"
 
 class Material;
 class Model;
-
-struct BoundingBox {
-    vec3 min;
-    vec3 max;
-};
+class RenderQueue;
+struct DrawPacket;
 
 class SimpleMesh {
    public:
@@ -78,10 +76,15 @@ class Mesh : public Resource {
    public:
     Mesh();
     Mesh(const String& p_path);
+    Mesh(const String& p_path, const aiScene* p_scene);
 
     ~Mesh();
 
     friend class Model;
+    friend class MeshCache;
+
+    // Post-processing applied to every import, part of the mesh cache key.
+    static const unsigned IMPORT_FLAGS;
 
     struct Vertex {
         vec3 position;
@@ -106,10 +109,11 @@ class Mesh : public Resource {
     };
 
     struct MeshNode {
-        void draw();
+        void draw(Material* p_material);
 
         void init(aiMesh* p_mesh);
-        void setup_buffers();
+        void setup_buffers(const Vertex* p_vertices, unsigned p_vertex_count,
+                           const Face* p_faces, unsigned p_face_count);
 
         String name;
 
@@ -117,23 +121,51 @@ class Mesh : public Resource {
         Array<Vertex> vertices;
         Array<Color> colors;
 
+        // Meshes loaded from the cache keep no copy of the arrays above.
+        unsigned vertex_count = 0;
+        unsigned face_count = 0;
+        BoundingBox bounds;
+
         unsigned mat_index;
         Material* material;
 
         Mesh* parent;
 
-        GLuint VAO, VBO, EBO;
+        GLuint VAO = 0, VBO = 0, EBO = 0;
 
         Color modulate;
     };
 
     bool import(const String& p_filepath);
+    bool build(const aiScene* p_scene);
 
-    void draw();
+    // Imports the file again, models that draw this mesh keep it.
+    void reload() override;
+
+    // Deletes the nodes with their vertex buffers and the materials.
+    void free() override;
+
+    // Runs the Assimp import without touching GL, so it can run on a worker thread.
+    static const aiScene* read(Assimp::Importer& p_importer, const String& p_filepath);
+
+    // The materials are taken from p_model if given, see Model::get_material.
+    void draw(const Model* p_model = nullptr);
+
+    // Adds a packet for every node, p_packet holds the state of the model.
+    void collect(RenderQueue& r_queue, DrawPacket p_packet, const Model* p_model = nullptr);
+
+    // Drawn instead of this mesh until build has been called.
+    void set_placeholder(Mesh* p_placeholder);
+    bool is_ready() const override;
+
+    size_t get_cpu_size() const override;
+    size_t get_gpu_size() const override;
 
     BoundingBox get_bounding_box() const;
 
     Array<Variant> get_materials() const;
+
+    // Takes ownership of p_materials, materials left out are deleted. Models drop their copies.
     void set_materials(const Array<Variant>& p_materials);
 
     static void bind_methods();
@@ -141,6 +173,9 @@ class Mesh : public Resource {
    private:
     BoundingBox get_bounding_box(Mesh* p_mesh, const mat4& p_transform);
 
+    // Refits the models that draw this mesh in the spatial index of their world.
+    void set_bounding_box(const BoundingBox& p_bounding_box);
+
     MeshNode* root;
 
     Vector<Texture2D> textures;
@@ -149,13 +184,15 @@ class Mesh : public Resource {
 
     BoundingBox bounding_box;
 
-    Model* model;
+    Mesh* placeholder = nullptr;
+    Array<Model*> models;
 };
 
 class Material : public Resource {
     OBJ_DEFINITION(Material, Resource);
 
     friend class Mesh;
+    friend class MeshCache;
 
    public:
     Material();
@@ -186,6 +223,12 @@ class Material : public Resource {
 
     Mesh* get_mesh() const;
 
+    // A new material with the same shader, colours and textures.
+    Material* duplicate() const;
+
+    static String get_texture_path(const File& p_mesh_file, const aiMaterial* p_material,
+                                   const aiTextureType& p_type);
+
     static void bind_methods();
 
    private:
@@ -199,9 +242,9 @@ class Material : public Resource {
     Shader* shader;
     Mesh* mesh;
 
-    Texture2D* diffuse_texture;
-    Texture2D* specular_texture;
-    Texture2D* ambient_texture;
+    Ref<Texture2D> diffuse_texture;
+    Ref<Texture2D> specular_texture;
+    Ref<Texture2D> ambient_texture;
 
     Color diffuse_color;
     Color specular_color;
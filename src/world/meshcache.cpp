@@ -0,0 +1,359 @@
+#include "meshcache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "core/contentmanager.h"
+#include "meshiosystem.h"
+#include "resources/assetcache.h"
+
+namespace {
+const char MAGIC[4] = {'T', 'M', 'S', 'H'};
+
+// Vertex blobs start on a 16 byte boundary inside the entry.
+const size_t BLOB_ALIGNMENT = 16;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t dependency_count;
+    uint32_t material_count;
+    uint32_t node_count;
+    vec3 min;
+    vec3 max;
+};
+
+struct Writer {
+    std::vector<char> buffer;
+
+    template <typename T>
+    void write(const T& p_value) {
+        const char* bytes = reinterpret_cast<const char*>(&p_value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void write(const void* p_data, size_t p_size) {
+        const char* bytes = static_cast<const char*>(p_data);
+        buffer.insert(buffer.end(), bytes, bytes + p_size);
+    }
+
+    void write_blob(const void* p_data, size_t p_size) {
+        align();
+        if (p_size > 0) write(p_data, p_size);
+    }
+
+    void write_string(const String& p_string) {
+        write<uint32_t>(p_string.size());
+        write(p_string.c_str(), p_string.size());
+    }
+
+    void write_color(const Color& p_color) {
+        write<vec4>(vec4(p_color.x, p_color.y, p_color.z, p_color.w));
+    }
+
+    void align() { buffer.resize((buffer.size() + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1)); }
+};
+
+struct Reader {
+    const char* data;
+    size_t size;
+    size_t position;
+
+    bool valid = true;
+
+    template <typename T>
+    T read() {
+        T value = T();
+
+        if (position + sizeof(T) > size) {
+            valid = false;
+            return value;
+        }
+
+        memcpy(&value, data + position, sizeof(T));
+        position += sizeof(T);
+
+        return value;
+    }
+
+    // Returns a pointer into the mapping, the blob is not copied.
+    const char* read_blob(size_t p_size) {
+        if (position + p_size > size) {
+            valid = false;
+            return nullptr;
+        }
+
+        const char* result = data + position;
+        position += p_size;
+
+        return result;
+    }
+
+    String read_string() {
+        uint32_t length = read<uint32_t>();
+        const char* bytes = read_blob(length);
+
+        return bytes ? String(std::string(bytes, length)) : String();
+    }
+
+    Color read_color() {
+        vec4 c = read<vec4>();
+        return Color(c.x, c.y, c.z, c.w);
+    }
+
+    void align() { position = (position + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1); }
+};
+
+String get_texture_path(const Ref<Texture2D>& p_texture) {
+    Texture2D* texture = p_texture;
+    return texture ? texture->get_file() : String();
+}
+
+// Paths inside the assets are kept relative, so a packed cache still matches on another machine.
+String get_stored_path(const File& p_file) {
+    String path = p_file.get_relative_path();
+    return path.size() > 0 ? path : p_file.get_absolute_path();
+}
+
+Texture2D* load_texture(const String& p_path) {
+    // Held in a Ref by the material.
+    return p_path.size() > 0 ? CONTENT->LoadTexture(p_path, false) : nullptr;
+}
+}  // namespace
+
+MeshCache::MeshCache(const File& p_source) {
+    source = p_source;
+    key = 0;
+    hashed = false;
+}
+
+bool MeshCache::open() {
+    uint64_t k = get_key();
+    if (!k) return false;
+
+    entry = AssetCache::get_file("meshes", k, "tmesh");
+
+    if (!entry.is_file() || !mapped.open(entry)) return false;
+
+    bool stale = false;
+
+    if (!parse(stale)) {
+        if (!stale) T_WARNING("Ignoring corrupt mesh cache entry: " + entry.get_absolute_path());
+        mapped.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MeshCache::is_open() const { return mapped.is_open(); }
+
+Array<String> MeshCache::get_texture_paths() const {
+    Array<String> result;
+
+    for (const CachedMaterial& material : materials) {
+        if (material.diffuse_texture.size() > 0) result.push_back(material.diffuse_texture);
+        if (material.specular_texture.size() > 0) result.push_back(material.specular_texture);
+        if (material.ambient_texture.size() > 0) result.push_back(material.ambient_texture);
+    }
+
+    return result;
+}
+
+bool MeshCache::build(Mesh* p_mesh) {
+    if (!is_open()) return false;
+
+    p_mesh->placeholder = nullptr;
+
+    for (const CachedMaterial& cached : materials) {
+        Material* material = new Material;
+        material->mesh = p_mesh;
+        material->name = cached.name;
+        material->diffuse_color = cached.diffuse_color;
+        material->specular_color = cached.specular_color;
+        material->ambient_color = cached.ambient_color;
+        material->emissive_color = cached.emissive_color;
+        material->shininess = cached.shininess;
+        material->diffuse_texture = load_texture(cached.diffuse_texture);
+        material->specular_texture = load_texture(cached.specular_texture);
+        material->ambient_texture = load_texture(cached.ambient_texture);
+        material->shader = CONTENT->LoadShader("engine/shaders/Shader3D");
+
+        p_mesh->materials.push_back(material);
+    }
+
+    for (const CachedNode& cached : nodes) {
+        Mesh::MeshNode* node = new Mesh::MeshNode;
+        node->mat_index = cached.mat_index;
+        node->material = p_mesh->materials[cached.mat_index];
+        node->parent = p_mesh;
+        node->bounds = cached.bounds;
+        node->setup_buffers(cached.vertices, cached.vertex_count, cached.faces, cached.face_count);
+
+        p_mesh->meshes.push_back(node);
+    }
+
+    p_mesh->set_bounding_box(bounding_box);
+
+    // The blobs live in GL buffers now.
+    mapped.close();
+    nodes.clear();
+
+    return true;
+}
+
+bool MeshCache::save(const Mesh* p_mesh, const Assimp::Importer& p_importer) {
+    // Embedded textures are only available through the Assimp scene.
+    if (p_mesh->textures.size() > 0) return false;
+
+    uint64_t k = get_key();
+    if (!k) return false;
+
+    Array<String> dependencies = get_dependencies(p_mesh, p_importer);
+
+    Writer writer;
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = k;
+    header.dependency_count = dependencies.size();
+    header.material_count = p_mesh->materials.size();
+    header.node_count = p_mesh->meshes.size();
+    header.min = p_mesh->bounding_box.min;
+    header.max = p_mesh->bounding_box.max;
+    writer.write(header);
+
+    for (const String& dependency : dependencies) {
+        writer.write_string(dependency);
+        writer.write<uint64_t>(AssetCache::hash_file(dependency));
+    }
+
+    for (const Material* material : p_mesh->materials) {
+        writer.write_string(material->name);
+        writer.write_color(material->diffuse_color);
+        writer.write_color(material->specular_color);
+        writer.write_color(material->ambient_color);
+        writer.write_color(material->emissive_color);
+        writer.write<float>(material->shininess);
+        writer.write_string(get_texture_path(material->diffuse_texture));
+        writer.write_string(get_texture_path(material->specular_texture));
+        writer.write_string(get_texture_path(material->ambient_texture));
+    }
+
+    for (const Mesh::MeshNode* node : p_mesh->meshes) {
+        writer.write<uint32_t>(node->mat_index);
+        writer.write<vec3>(node->bounds.min);
+        writer.write<vec3>(node->bounds.max);
+        writer.write<uint32_t>(node->vertices.size());
+        writer.write<uint32_t>(node->faces.size());
+
+        writer.write_blob(node->vertices.data(), node->vertices.size() * sizeof(Mesh::Vertex));
+        writer.write_blob(node->faces.data(), node->faces.size() * sizeof(Mesh::Face));
+    }
+
+    entry = AssetCache::get_file("meshes", k, "tmesh");
+
+    return AssetCache::write(entry, writer.buffer.data(), writer.buffer.size());
+}
+
+bool MeshCache::parse(bool& r_stale) {
+    Reader reader = {mapped.get_data(), mapped.get_size(), 0};
+    Header header = reader.read<Header>();
+
+    if (!reader.valid || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION || header.key != key)
+        return false;
+
+    bounding_box.min = header.min;
+    bounding_box.max = header.max;
+
+    materials.clear();
+    nodes.clear();
+
+    for (uint32_t c = 0; c < header.dependency_count && reader.valid; c++) {
+        String dependency = reader.read_string();
+        uint64_t hash = reader.read<uint64_t>();
+
+        if (reader.valid && AssetCache::hash_file(dependency) != hash) {
+            r_stale = true;
+            return false;
+        }
+    }
+
+    for (uint32_t c = 0; c < header.material_count && reader.valid; c++) {
+        CachedMaterial material;
+        material.name = reader.read_string();
+        material.diffuse_color = reader.read_color();
+        material.specular_color = reader.read_color();
+        material.ambient_color = reader.read_color();
+        material.emissive_color = reader.read_color();
+        material.shininess = reader.read<float>();
+        material.diffuse_texture = reader.read_string();
+        material.specular_texture = reader.read_string();
+        material.ambient_texture = reader.read_string();
+
+        materials.push_back(material);
+    }
+
+    for (uint32_t c = 0; c < header.node_count && reader.valid; c++) {
+        CachedNode node;
+        node.mat_index = reader.read<uint32_t>();
+        node.bounds.min = reader.read<vec3>();
+        node.bounds.max = reader.read<vec3>();
+        node.vertex_count = reader.read<uint32_t>();
+        node.face_count = reader.read<uint32_t>();
+
+        if (node.mat_index >= header.material_count) return false;
+
+        reader.align();
+        node.vertices = reinterpret_cast<const Mesh::Vertex*>(
+            reader.read_blob(size_t(node.vertex_count) * sizeof(Mesh::Vertex)));
+        reader.align();
+        node.faces = reinterpret_cast<const Mesh::Face*>(
+            reader.read_blob(size_t(node.face_count) * sizeof(Mesh::Face)));
+
+        nodes.push_back(node);
+    }
+
+    return reader.valid;
+}
+
+uint64_t MeshCache::get_key() {
+    if (hashed) return key;
+
+    uint32_t version = VERSION;
+    uint32_t flags = Mesh::IMPORT_FLAGS;
+
+    uint64_t seed = AssetCache::hash(&version, sizeof(version));
+    seed = AssetCache::hash(&flags, sizeof(flags), seed);
+
+    key = AssetCache::hash_file(source, seed);
+    hashed = true;
+
+    return key;
+}
+
+Array<String> MeshCache::get_dependencies(const Mesh* p_mesh,
+                                          const Assimp::Importer& p_importer) const {
+    Array<String> result;
+    String source_path = get_stored_path(source);
+
+    auto add = [&](const String& p_path) {
+        if (p_path.size() == 0) return;
+
+        String path = get_stored_path(p_path);
+        if (path != source_path && !result.contains(path)) result.push_back(path);
+    };
+
+    for (const String& path : MeshIOSystem::get_opened_files(p_importer)) add(path);
+
+    for (const Material* material : p_mesh->materials) {
+        add(get_texture_path(material->diffuse_texture));
+        add(get_texture_path(material->specular_texture));
+        add(get_texture_path(material->ambient_texture));
+    }
+
+    return result;
+}
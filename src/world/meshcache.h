@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+
+#include "resources/mappedfile.h"
+#include "world/mesh.h"
+
+// Binary cache of Assimp imports.
+//
+// An entry holds the vertex and index blobs and the bounds of every mesh node, the materials and
+// the bounding box, keyed by the contents of the source file and the import flags. It also lists
+// the other files the import depends on, like the material library of an OBJ and the textures,
+// with a hash of their contents, and is ignored when one of them changed. Entries are
+// memory-mapped and the blobs are uploaded to the vertex buffers directly, without going through
+// Assimp or copying them into arrays first.
+class MeshCache {
+   public:
+    MeshCache(const File& p_source);
+
+    // Hashes the source and maps a matching entry. Does not touch GL, so it can run on a worker.
+    bool open();
+    bool is_open() const;
+
+    // Texture files referenced by the cached materials.
+    Array<String> get_texture_paths() const;
+
+    // Creates the materials and vertex buffers, must run on the render thread.
+    bool build(Mesh* p_mesh);
+
+    // Writes an entry for a mesh that was just built from the scene imported by p_importer.
+    bool save(const Mesh* p_mesh, const Assimp::Importer& p_importer);
+
+    static const uint32_t VERSION = 3;
+
+   private:
+    struct CachedMaterial {
+        String name;
+
+        Color diffuse_color;
+        Color specular_color;
+        Color ambient_color;
+        Color emissive_color;
+
+        float shininess;
+
+        String diffuse_texture;
+        String specular_texture;
+        String ambient_texture;
+    };
+
+    struct CachedNode {
+        uint32_t mat_index;
+        BoundingBox bounds;
+
+        const Mesh::Vertex* vertices;
+        uint32_t vertex_count;
+
+        const Mesh::Face* faces;
+        uint32_t face_count;
+    };
+
+    // r_stale is set if the entry is intact but a dependency changed.
+    bool parse(bool& r_stale);
+    uint64_t get_key();
+
+    // Files other than the source that the import read or the materials refer to.
+    Array<String> get_dependencies(const Mesh* p_mesh, const Assimp::Importer& p_importer) const;
+
+    File source;
+    File entry;
+
+    uint64_t key;
+    bool hashed;
+
+    MappedFile mapped;
+
+    Array<CachedMaterial> materials;
+    Array<CachedNode> nodes;
+    BoundingBox bounding_box;
+};
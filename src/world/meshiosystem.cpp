@@ -0,0 +1,82 @@
+#include "meshiosystem.h"
+
+#include <cstring>
+
+#include "math/math.h"
+#include "resources/mappedfile.h"
+#include "resources/virtualfilesystem.h"
+
+namespace {
+// Reads from the mapping of a loose or archived file.
+class MappedStream : public Assimp::IOStream {
+   public:
+    MappedStream() { position = 0; }
+
+    bool open(const File& p_file) { return mapped.open(p_file); }
+
+    size_t Read(void* p_buffer, size_t p_size, size_t p_count) override {
+        if (p_size == 0) return 0;
+
+        size_t count = MIN(p_count, (mapped.get_size() - position) / p_size);
+        memcpy(p_buffer, mapped.get_data() + position, count * p_size);
+        position += count * p_size;
+
+        return count;
+    }
+
+    size_t Write(const void*, size_t, size_t) override { return 0; }
+
+    aiReturn Seek(size_t p_offset, aiOrigin p_origin) override {
+        size_t base = 0;
+
+        if (p_origin == aiOrigin_CUR)
+            base = position;
+        else if (p_origin == aiOrigin_END)
+            base = mapped.get_size();
+
+        if (base + p_offset > mapped.get_size()) return aiReturn_FAILURE;
+
+        position = base + p_offset;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override { return position; }
+
+    size_t FileSize() const override { return mapped.get_size(); }
+
+    void Flush() override {}
+
+   private:
+    MappedFile mapped;
+    size_t position;
+};
+}  // namespace
+
+bool MeshIOSystem::Exists(const char* p_file) const { return VFS->is_file(File(p_file)); }
+
+char MeshIOSystem::getOsSeparator() const { return '/'; }
+
+Assimp::IOStream* MeshIOSystem::Open(const char* p_file, const char* p_mode) {
+    if (strchr(p_mode, 'w') || strchr(p_mode, 'a')) return nullptr;
+
+    MappedStream* stream = new MappedStream;
+
+    if (!stream->open(File(p_file))) {
+        delete stream;
+        return nullptr;
+    }
+
+    if (!opened_files.contains(p_file)) opened_files.push_back(p_file);
+
+    return stream;
+}
+
+void MeshIOSystem::Close(Assimp::IOStream* p_stream) { delete p_stream; }
+
+const Array<String>& MeshIOSystem::get_opened_files() const { return opened_files; }
+
+Array<String> MeshIOSystem::get_opened_files(const Assimp::Importer& p_importer) {
+    MeshIOSystem* io = dynamic_cast<MeshIOSystem*>(p_importer.GetIOHandler());
+
+    return io ? io->get_opened_files() : Array<String>();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "assimp/IOStream.hpp"
+#include "assimp/IOSystem.hpp"
+#include "assimp/Importer.hpp"
+#include "core/array.h"
+#include "core/string.h"
+
+// File access of Assimp imports through the virtual file system, so files an archived model
+// refers to, such as the material library of an OBJ, are found in the archive as well.
+//
+// Every file an import opens is recorded, so the mesh cache can tell when one of them changes.
+// Files are read-only.
+class MeshIOSystem : public Assimp::IOSystem {
+   public:
+    bool Exists(const char* p_file) const override;
+    char getOsSeparator() const override;
+
+    Assimp::IOStream* Open(const char* p_file, const char* p_mode = "rb") override;
+    void Close(Assimp::IOStream* p_stream) override;
+
+    const Array<String>& get_opened_files() const;
+
+    // The files opened by the last import of p_importer, empty if it used another IO system.
+    static Array<String> get_opened_files(const Assimp::Importer& p_importer);
+
+   private:
+    Array<String> opened_files;
+};
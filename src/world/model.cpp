@@ -1,20 +1,22 @@
 #include "model.h"
 
 #include "graphics/renderer.h"
+#include "graphics/renderqueue.h"
 #include "graphics/view.h"
 #include "sky.h"
 #include "world.h"
 
 Model::Model() {
-    shader = CONTENT->LoadShader("engine/shaders/Shader3D");
+    shader = nullptr;
     color_id = vec3(0.0, 1.0, 0.5);
+    instancing_enabled = true;
 }
 
 Model::Model(const String& p_path) : Model() { load_mesh(p_path); }
 
 Model::Model(Mesh* p_mesh) : Model() { set_mesh(p_mesh); }
 
-Model::~Model() {}
+Model::~Model() { set_mesh(nullptr); }
 
 void Model::draw() {
     if (!mesh) {
@@ -22,24 +24,40 @@ void Model::draw() {
         return;
     }
 
+    Shader* shader = get_shader();
+
     shader->bind();
-    shader->set_uniform("view", RENDERER->get_final_matrix());
     shader->set_uniform("model", get_transform().get_model());
     shader->set_uniform("color_id", color_id);
     shader->set_uniform("color", get_color());
 
-    mesh->draw();
+    mesh->draw(this);
+}
+
+bool Model::collect(RenderQueue& r_queue) {
+    if (!mesh) return false;
+
+    DrawPacket packet;
+    packet.shader = get_shader();
+    packet.model = get_transform().get_model();
+    packet.color = get_color();
+    packet.color_id = color_id;
+    packet.instancing = instancing_enabled;
+
+    mesh->collect(r_queue, packet, this);
+    return true;
 }
 
 void Model::shadow_draw() {
+    Shader* shader = get_shader();
+
     shader->bind();
-    shader->set_uniform("view", RENDERER->get_final_matrix());
     shader->set_uniform("model", get_transform().get_model());
     shader->set_uniform("color", get_color());
     shader->set_uniform("texture_enabled", true);
     shader->set_uniform("ambient", vec3(0.3f));
 
-    mesh->draw();
+    mesh->draw(this);
 
     shader->set_uniform("color", Color::White);
 }
@@ -50,17 +68,80 @@ void Model::load_mesh(const String& p_path) {
 }
 
 void Model::set_mesh(Mesh* p_mesh) {
+    if (mesh) {
+        Array<Model*>& models = mesh->models;
+
+        for (int c = 0; c < models.size(); c++) {
+            if (models[c] == this) {
+                models.clear(c);
+                break;
+            }
+        }
+    }
+
     mesh = p_mesh;
+    materials.clear();
 
-    if (mesh) mesh->model = this;
+    if (mesh) mesh->models.push_back(this);
+
+    update_bounds();
 }
 
 Mesh* Model::get_mesh() const { return mesh; }
 
+Material* Model::get_material(int p_index) const {
+    if (p_index < materials.size() && materials[p_index]) return materials[p_index];
+
+    if (!mesh || p_index < 0 || p_index >= mesh->materials.size()) return nullptr;
+
+    return mesh->materials[p_index];
+}
+
+Material* Model::edit_material(int p_index) {
+    Material* material = get_material(p_index);
+    if (!material) return nullptr;
+
+    // Only the copies are counted, the materials of the mesh are owned by it.
+    Material* own = p_index < materials.size() ? materials[p_index].ptr() : nullptr;
+    if (own && own->get_ref_count() == 1) return own;
+
+    while (materials.size() <= p_index) materials.push_back(Ref<Material>());
+    materials[p_index] = material->duplicate();
+
+    return materials[p_index];
+}
+
+void Model::clone_to(Node* p_copy) const {
+    Model* copy = dynamic_cast<Model*>(p_copy);
+
+    if (copy && copy->get_mesh() == get_mesh()) copy->materials = materials;
+}
+
+Shader* Model::get_shader() {
+    if (!shader) shader = CONTENT->LoadShader("engine/shaders/Shader3D");
+
+    return shader;
+}
+
 void Model::set_color_id(const vec3& p_color_id) { color_id = p_color_id; }
 
 vec3 Model::get_color_id() const { return color_id; }
 
+void Model::set_instancing_enabled(bool p_enabled) { instancing_enabled = p_enabled; }
+
+bool Model::get_instancing_enabled() const { return instancing_enabled; }
+
+BoundingBox Model::get_bounding_box() const {
+    return mesh ? mesh->get_bounding_box() : BoundingBox();
+}
+
+bool Model::get_local_bounds(BoundingBox& r_bounds) const {
+    if (!mesh) return false;
+
+    r_bounds = mesh->get_bounding_box();
+    return true;
+}
+
 #undef CLASSNAME
 #define CLASSNAME Model
 
@@ -68,4 +149,8 @@ void Model::bind_methods() {
     REG_CSTR(0);
 
     REG_PROPERTY(mesh);
+    REG_PROPERTY(instancing_enabled);
+
+    REG_METHOD(get_material);
+    REG_METHOD(edit_material);
 }
@@ -17,22 +17,46 @@ class Model : public WorldObject {
 
     void draw() override;
     void shadow_draw() override;
+    bool collect(RenderQueue& r_queue) override;
 
     void load_mesh(const String& p_path);
 
     void set_mesh(Mesh* p_mesh);
     Mesh* get_mesh() const;
 
+    // Material p_index of the mesh as this model draws it.
+    Material* get_material(int p_index) const;
+
+    // Gives this model its own copy of material p_index before it is changed, unless it has one
+    // that no other model shares. Models that share the mesh, like the instances of a prefab,
+    // keep drawing the original.
+    Material* edit_material(int p_index);
+
+    void clone_to(Node* p_copy) const override;
+
     void set_color_id(const vec3& p_color_id);
     vec3 get_color_id() const;
 
+    // Lets the render queue draw this model as an instance of others sharing its mesh and state.
+    void set_instancing_enabled(bool p_enabled);
+    bool get_instancing_enabled() const;
+
     BoundingBox get_bounding_box() const;
+    bool get_local_bounds(BoundingBox& r_bounds) const override;
 
     static void bind_methods();
 
    private:
-    Mesh* mesh;
+    // Loaded when first drawn, so models can be made without a GL context.
+    Shader* get_shader();
+
+    Ref<Mesh> mesh;
     Shader* shader;
 
+    // Copies made by edit_material, null where the material of the mesh is drawn. Clones share
+    // the copies until one of them is edited.
+    Array<Ref<Material>> materials;
+
     vec3 color_id;
+    bool instancing_enabled;
 };
@@ -26,7 +26,6 @@ void Plane::draw() {
     t.update();
 
     shader->bind();
-    shader->set_uniform("view", RENDERER->get_final_matrix());
     shader->set_uniform("model", t.get_model());
     shader->set_uniform("color", get_color());
 
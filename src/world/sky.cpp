@@ -66,10 +66,8 @@ void Sky::draw() {
     vec3 light_dir = light->get_direction();
 
     shader->bind();
-    shader->set_uniform("view", RENDERER->get_final_matrix());
     shader->set_uniform("sun_direction", light_dir);
     shader->set_uniform("sky_color", get_sky_color().get_rgb());
-    shader->set_uniform("camera_position", ACTIVE_WORLD->get_active_camera()->get_pos());
 
     MeshHandler::get_singleton()->get_cube()->bind();
     MeshHandler::get_singleton()->get_cube()->draw();
@@ -83,7 +83,9 @@ void Sprite::draw() {
     t.update();
 
     shader->bind();
-    shader->set_uniform("view", RENDERER->get_final_matrix());
+
+    // Custom shaders may still take the view as a uniform instead of including Uniforms.glsl.
+    shader->set_uniform(shader->get_uniform<mat4>("view"_uniform), RENDERER->get_final_matrix());
     shader->set_uniform("model", t.get_model());
     shader->set_uniform("color", Color::White);
     shader->set_uniform("color_id", TO_RGB(vec3i(255, 0, 0)).get_rgb());
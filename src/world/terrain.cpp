@@ -1,6 +1,7 @@
 #include "terrain.h"
 
 #include "core/contentmanager.h"
+#include "graphics/glstate.h"
 #include "graphics/renderer.h"
 #include "graphics/view.h"
 #include "math/noise.h"
@@ -165,7 +166,7 @@ void Terrain::init() {
     unsigned id = 0;
 
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLSTATE->bind_texture(GL_TEXTURE_2D, id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -245,10 +246,10 @@ void Terrain::setup_buffers() {
     vertices[index++] = {vec3(1.0f, 1.0f, 0.0f)};
 
     glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    GLSTATE->bind_vertex_array(VAO);
 
     glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLSTATE->bind_buffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices_count, &vertices[0], GL_STATIC_DRAW);
 
     glEnableVertexAttribArray(0);
@@ -256,7 +257,7 @@ void Terrain::setup_buffers() {
 
     glPatchParameteri(GL_PATCH_VERTICES, vertices_count);
 
-    glBindVertexArray(0);
+    GLSTATE->bind_vertex_array(0);
 }
 
 float Terrain::get_height(const vec2& p_pos) const { return 0.0f; }
@@ -277,8 +278,9 @@ void Terrain::draw() {
     Water* water = get_parent()->get_child_by_type<Water*>();
     if (water) shader->set_uniform("water_height", water->get_pos().z);
 
-    shader->set_uniform("view", RENDERER->get_final_matrix());
     shader->set_uniform("model", get_transform().get_model());
+
+    // Of the main camera in every pass, so shadows and reflections see the same tessellation.
     shader->set_uniform("camera_pos", ACTIVE_WORLD->get_active_camera()->get_pos());
     shader->set_uniform("terrain_size", get_size());
 
@@ -298,7 +300,7 @@ void Terrain::draw() {
     shader->set_uniform("indirection", textures.size() + 3);
     DEFERRED_RENDERER->get_texture(DEFERRED_RENDERER->INDIRECTION)->bind(textures.size() + 3);
 
-    glBindVertexArray(VAO);
+    GLSTATE->bind_vertex_array(VAO);
     glEnableVertexAttribArray(0);
 
     for (int c = 0; c < nodes.size(); c++) {
@@ -307,7 +309,7 @@ void Terrain::draw() {
         glDrawArrays(GL_PATCHES, 0, 16);
     }
 
-    glBindVertexArray(0);
+    GLSTATE->bind_vertex_array(0);
     glDisableVertexAttribArray(0);
 }
 
@@ -342,10 +344,8 @@ void Water::draw() {
     set_pos(vec3(cam->get_pos().get_xy(), get_pos().z));
 
     shader->bind();
-    shader->set_uniform("view", RENDERER->get_final_matrix());
     shader->set_uniform("model", get_transform().get_model());
     shader->set_uniform("ambient", Color::FromRGB(vec3i(66, 173, 244)).get_rgb());
-    shader->set_uniform("time", TIME->get_absolutetime() / 1000.0f);
     shader->set_uniform("normals", 0);
     shader->set_uniform("reflection_tex", 1);
 
@@ -445,7 +445,7 @@ void Vegetation::update_buffer() {
     }
 
     ubo->set_data(positions);
-    ubo->bind_at_index(0);
+    ubo->bind_at_index(UBO::BINDING_FIRST_FREE);
 
     shader->bind();
     shader->bind_block("matrix_block", ubo);
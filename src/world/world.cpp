@@ -1,5 +1,7 @@
 #include "world.h"
 
+#include <algorithm>
+
 #include "core/corenames.h"
 #include "graphics/renderer.h"
 #include "graphics/view.h"
@@ -23,8 +25,10 @@ void World::add_child(Node* p_child) {
     if (!world_object) return;
 
     Node::add_child(world_object);
+    world_object->draw_order = next_draw_order++;
     world_object->register_in_world(this);
     world_object->set_layer(GetLayer(0));
+    update_bounds(world_object);
 
     if (!active_camera && p_child->is_of_type<Camera>())
         set_active_camera(world_object->cast_to_type<Camera*>());
@@ -32,7 +36,63 @@ void World::add_child(Node* p_child) {
     world_object->notificate(WorldObject::NOTIFICATION_READY);
 }
 
-void World::remove_child(Node* p_child) { Node::remove_child(p_child); }
+void World::remove_child(Node* p_child) {
+    unregister(p_child);
+
+    Node::remove_child(p_child);
+}
+
+void World::release_child(Node* p_child) {
+    unregister(p_child);
+
+    Node::release_child(p_child);
+}
+
+void World::move_child(Node* p_child, int p_index) {
+    if (get_index(p_child) == p_index) return;
+
+    Node::move_child(p_child, p_index);
+
+    // Adding and removing keep the order of the others, moving renumbers them.
+    next_draw_order = 0;
+
+    for (Node* child : children) {
+        WorldObject* world_object = child->cast_to_type<WorldObject*>();
+        if (world_object) world_object->draw_order = next_draw_order++;
+    }
+}
+
+void World::unregister(Node* p_child) {
+    WorldObject* world_object = p_child->cast_to_type<WorldObject*>();
+
+    if (!world_object) return;
+
+    if (world_object->proxy != -1) {
+        bvh.destroy_proxy(world_object->proxy);
+        world_object->proxy = -1;
+    }
+
+    set_unbounded(world_object, false);
+    world_object->register_in_world(nullptr);
+}
+
+void World::set_unbounded(WorldObject* p_object, bool p_unbounded) {
+    if (p_object->unbounded == p_unbounded) return;
+
+    p_object->unbounded = p_unbounded;
+
+    if (p_unbounded) {
+        unbounded.push_back(p_object);
+        return;
+    }
+
+    for (int c = 0; c < unbounded.size(); c++) {
+        if (unbounded[c] == p_object) {
+            unbounded.clear(c);
+            return;
+        }
+    }
+}
 
 WorldObject* World::get_worldobject(const String& name) {
     for (Node* obj : children) {
@@ -104,6 +164,170 @@ void World::draw() {
     }
 }
 
+void World::draw(const Frustum& p_frustum, CullStats& r_stats, RenderQueue& r_queue) {
+    r_stats = CullStats();
+    visible.clear();
+
+    // The index holds grown boxes, the exact bounds decide.
+    bvh.query(p_frustum, [this, &p_frustum](int p_proxy) {
+        WorldObject* object = get_object(p_proxy);
+        BoundingBox bounds;
+
+        if (object->get_visible() &&
+            (!object->get_world_bounds(bounds) || p_frustum.intersects(bounds)))
+            visible.push_back(object);
+
+        return true;
+    });
+
+    // Hidden objects count as culled as well.
+    r_stats.culled = bvh.get_proxy_count() - visible.size();
+
+    for (WorldObject* object : unbounded)
+        if (object->get_visible()) visible.push_back(object);
+
+    // Objects that draw immediately keep their child order among each other. The ones collected
+    // into r_queue are submitted after all of them, in the order of the queue.
+    std::sort(visible.begin(), visible.end(), [](WorldObject* p_left, WorldObject* p_right) {
+        return p_left->draw_order < p_right->draw_order;
+    });
+
+    for (WorldObject* object : visible) {
+        if (object->has_script() || !object->collect(r_queue))
+            object->notificate(WorldObject::NOTIFICATION_DRAW);
+    }
+
+    r_stats.drawn = visible.size();
+}
+
+void World::update_bounds(WorldObject* p_object) {
+    BoundingBox bounds;
+
+    if (!p_object->get_world_bounds(bounds)) {
+        if (p_object->proxy != -1) bvh.destroy_proxy(p_object->proxy);
+
+        p_object->proxy = -1;
+        set_unbounded(p_object, true);
+        return;
+    }
+
+    set_unbounded(p_object, false);
+
+    if (p_object->proxy == -1)
+        p_object->proxy = bvh.create_proxy(bounds, p_object);
+    else
+        bvh.move_proxy(p_object->proxy, bounds);
+}
+
+Array<WorldObject*> World::query(const BoundingBox& p_box) {
+    Array<WorldObject*> result;
+
+    bvh.query(p_box, [this, &p_box, &result](int p_proxy) {
+        WorldObject* object = get_object(p_proxy);
+        BoundingBox bounds;
+
+        if (object->get_world_bounds(bounds) && bounds.intersects(p_box)) result.push_back(object);
+        return true;
+    });
+
+    return result;
+}
+
+Array<WorldObject*> World::query(const Frustum& p_frustum) {
+    Array<WorldObject*> result;
+
+    bvh.query(p_frustum, [this, &p_frustum, &result](int p_proxy) {
+        WorldObject* object = get_object(p_proxy);
+        BoundingBox bounds;
+
+        if (object->get_world_bounds(bounds) && p_frustum.intersects(bounds))
+            result.push_back(object);
+        return true;
+    });
+
+    return result;
+}
+
+Array<WorldObject*> World::query_sphere(const vec3& p_center, float p_radius) {
+    Array<WorldObject*> result;
+
+    bvh.query_sphere(p_center, p_radius, [this, &p_center, p_radius, &result](int p_proxy) {
+        WorldObject* object = get_object(p_proxy);
+        BoundingBox bounds;
+
+        if (object->get_world_bounds(bounds) && bounds.intersects(p_center, p_radius))
+            result.push_back(object);
+        return true;
+    });
+
+    return result;
+}
+
+WorldObject* World::raycast(const vec3& p_origin, const vec3& p_direction, float p_max_distance,
+                            float& r_distance) {
+    vec3 inverse = vec3(1.0f / p_direction.x, 1.0f / p_direction.y, 1.0f / p_direction.z);
+    WorldObject* nearest = nullptr;
+    r_distance = p_max_distance;
+
+    bvh.raycast(p_origin, p_direction, p_max_distance, [&](int p_proxy, float) {
+        WorldObject* object = get_object(p_proxy);
+        BoundingBox bounds;
+        float distance;
+
+        if (object->get_world_bounds(bounds) &&
+            bounds.intersects_ray(p_origin, inverse, r_distance, distance) &&
+            (!nearest || distance < r_distance)) {
+            nearest = object;
+            r_distance = distance;
+        }
+
+        // Only boxes that start closer than the nearest hit are visited from here on.
+        return r_distance;
+    });
+
+    return nearest;
+}
+
+const BVH& World::get_bvh() const { return bvh; }
+
+Array<Variant> World::get_objects_in_box(const vec3& p_min, const vec3& p_max) {
+    Array<WorldObject*> objects = query(BoundingBox{p_min, p_max});
+    Array<Variant> result;
+
+    for (int c = 0; c < objects.size(); c++) result.push_back(objects[c]);
+
+    return result;
+}
+
+Array<Variant> World::get_objects_in_sphere(const vec3& p_center, float p_radius) {
+    Array<WorldObject*> objects = query_sphere(p_center, p_radius);
+    Array<Variant> result;
+
+    for (int c = 0; c < objects.size(); c++) result.push_back(objects[c]);
+
+    return result;
+}
+
+Array<Variant> World::get_objects_in_view(Camera* p_camera) {
+    Array<Variant> result;
+    if (!p_camera) return result;
+
+    Array<WorldObject*> objects = query(Frustum(p_camera->get_final_matrix()));
+
+    for (int c = 0; c < objects.size(); c++) result.push_back(objects[c]);
+
+    return result;
+}
+
+WorldObject* World::cast_ray(const vec3& p_from, const vec3& p_to) {
+    float distance;
+    return raycast(p_from, p_to - p_from, 1.0f, distance);
+}
+
+WorldObject* World::get_object(int p_proxy) const {
+    return static_cast<WorldObject*>(bvh.get_data(p_proxy));
+}
+
 void World::Free() { children.clean(); }
 
 void World::set_active_camera(Camera* p_camera) { active_camera = p_camera; }
@@ -125,4 +349,9 @@ void World::bind_methods() {
     REG_CSTR(0);
 
     REG_METHOD(get_viewport);
+
+    REG_METHOD(get_objects_in_box);
+    REG_METHOD(get_objects_in_sphere);
+    REG_METHOD(get_objects_in_view);
+    REG_METHOD(cast_ray);
 }
@@ -2,10 +2,13 @@
 
 #include "camera.h"
 #include "core/node.h"
+#include "math/bvh.h"
+#include "math/frustum.h"
 #include "ui/layer.h"
 #include "worldobject.h"
 
 class Viewport;
+class RenderQueue;
 class PhysicsWorld2D;
 class PhysicsWorld3D;
 class DirectionalLight;
@@ -19,6 +22,8 @@ class World : public Node {
 
     void add_child(Node* p_child) override;
     void remove_child(Node* p_child) override;
+    void release_child(Node* p_child) override;
+    void move_child(Node* p_child, int p_index) override;
     WorldObject* get_worldobject(const String& name);
 
     Viewport* get_viewport() const;
@@ -36,6 +41,32 @@ class World : public Node {
     void draw();
     void Free();
 
+    // Draws the visible objects whose bounds intersect the view volume, objects that support it
+    // are added to the queue instead.
+    void draw(const Frustum& p_frustum, CullStats& r_stats, RenderQueue& r_queue);
+
+    // Adds, moves or removes the object in the spatial index.
+    void update_bounds(WorldObject* p_object);
+
+    // The objects whose bounds overlap, in no particular order. Objects without bounds are never
+    // found.
+    Array<WorldObject*> query(const BoundingBox& p_box);
+    Array<WorldObject*> query(const Frustum& p_frustum);
+    Array<WorldObject*> query_sphere(const vec3& p_center, float p_radius);
+
+    // The object whose bounds the ray enters first, nullptr when it hits none before
+    // p_max_distance.
+    WorldObject* raycast(const vec3& p_origin, const vec3& p_direction, float p_max_distance,
+                         float& r_distance);
+
+    const BVH& get_bvh() const;
+
+    // Script versions of the queries.
+    Array<Variant> get_objects_in_box(const vec3& p_min, const vec3& p_max);
+    Array<Variant> get_objects_in_sphere(const vec3& p_center, float p_radius);
+    Array<Variant> get_objects_in_view(Camera* p_camera);
+    WorldObject* cast_ray(const vec3& p_from, const vec3& p_to);
+
     void set_active_camera(Camera* p_camera);
     Camera* get_active_camera() const;
 
@@ -49,7 +80,24 @@ class World : public Node {
     static void bind_methods();
 
    private:
+    WorldObject* get_object(int p_proxy) const;
+
+    // Takes p_child out of the spatial index when it leaves the world.
+    void unregister(Node* p_child);
+
+    void set_unbounded(WorldObject* p_object, bool p_unbounded);
+
     Camera* active_camera;
     PhysicsWorld2D* physics_2d;
     PhysicsWorld3D* physics_3d;
+
+    BVH bvh;
+
+    // Objects without bounds, which the spatial index can not find.
+    Array<WorldObject*> unbounded;
+
+    // Drawn by the last culled draw, kept to reuse its memory.
+    Array<WorldObject*> visible;
+
+    uint64_t next_draw_order = 0;
 };
@@ -117,8 +117,10 @@ RenderComponent* WorldObject::get_rendercomponent() const { return rendercompone
 //}
 
 Transform WorldObject::get_transform() const { return transformcomponent->transform; }
-void WorldObject::set_transform(const Transform& p_transform) const {
+void WorldObject::set_transform(const Transform& p_transform) {
     transformcomponent->transform = p_transform;
+
+    update_bounds();
 }
 
 vec3 WorldObject::get_pos() const { return get_transform().get_pos(); }
@@ -129,6 +131,8 @@ void WorldObject::set_pos(const vec3& p_pos) {
     transform.set_pos(p_pos);
     transform.update();
 
+    update_bounds();
+
     RigidBody2D* body = get_child_by_type<RigidBody2D*>();
 
     if (body) body->set_transform(transform);
@@ -142,6 +146,8 @@ void WorldObject::set_size(const vec3& p_size) {
     transform.set_size(p_size);
     transform.update();
 
+    update_bounds();
+
     RigidBody2D* body = get_child_by_type<RigidBody2D*>();
 
     if (body) body->set_transform(transform);
@@ -155,6 +161,8 @@ void WorldObject::set_rotation(const vec3& p_rotation) {
     transform.set_rotation(p_rotation);
     transform.update();
 
+    update_bounds();
+
     // if (physicscomponent)
     //	physicscomponent->set_transform(transform);
 }
@@ -218,6 +226,27 @@ bool WorldObject::CheckOverlap(const vec2& p) const {
            p.y < pos.y + size.y;
 }
 
+bool WorldObject::get_world_bounds(BoundingBox& r_bounds) {
+    BoundingBox local;
+    if (!get_local_bounds(local)) return false;
+
+    const mat4& model = transformcomponent->transform.get_model();
+
+    if (!bounds.valid || bounds.model != model || bounds.local != local) {
+        bounds.valid = true;
+        bounds.model = model;
+        bounds.local = local;
+        bounds.world = local.transformed(model);
+    }
+
+    r_bounds = bounds.world;
+    return true;
+}
+
+void WorldObject::update_bounds() {
+    if (world) world->update_bounds(this);
+}
+
 #undef CLASSNAME
 #define CLASSNAME WorldObject
 
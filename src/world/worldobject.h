@@ -4,6 +4,7 @@
 #include "core/node.h"
 #include "core/vector.h"
 #include "input/event.h"
+#include "math/boundingbox.h"
 #include "math/color.h"
 #include "math/transform.h"
 #include "ui/layer.h"
@@ -11,6 +12,7 @@
 class TransformComponent;
 class ScriptComponent;
 class RenderComponent;
+class RenderQueue;
 class World;
 
 class WorldObject : public Node {
@@ -35,9 +37,13 @@ class WorldObject : public Node {
     virtual void draw() {}
     virtual void shadow_draw() {}
 
+    // Adds draw packets to a sorted queue instead of drawing, objects that return false are drawn
+    // immediately with draw().
+    virtual bool collect(RenderQueue&) { return false; }
+
     // Get or set the most important properties
     Transform get_transform() const;
-    void set_transform(const Transform& p_transform) const;
+    void set_transform(const Transform& p_transform);
 
     vec3 get_pos() const;
     void set_pos(const vec3& p_pos);
@@ -89,8 +95,39 @@ class WorldObject : public Node {
     // Check Overlap of bounding box with a vector
     virtual bool CheckOverlap(const vec2& p) const;
 
+    // Box around the object in model space, objects without one are never culled.
+    virtual bool get_local_bounds(BoundingBox&) const { return false; }
+
+    // The local bounds in world space, recomputed when the transform or local bounds changed.
+    bool get_world_bounds(BoundingBox& r_bounds);
+
+    // Moves the object in the spatial index of its world, called after the transform or the local
+    // bounds changed.
+    void update_bounds();
+
     static void bind_methods();
 
     World* world = nullptr;
     Layer* layer = nullptr;
+
+   private:
+    friend class World;
+
+    struct BoundsCache {
+        bool valid = false;
+        mat4 model;
+        BoundingBox local;
+        BoundingBox world;
+    };
+
+    BoundsCache bounds;
+
+    // Proxy in the spatial index of the world, -1 without bounds.
+    int proxy = -1;
+
+    // Listed by the world as drawn without culling, for lack of bounds.
+    bool unbounded = false;
+
+    // Increases in the child order of the world, culled draws are sorted by it.
+    uint64_t draw_order = 0;
 };
@@ -0,0 +1,259 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "math/bvh.h"
+
+namespace {
+struct Scene {
+    std::vector<BoundingBox> boxes;
+    std::vector<int> proxies;
+    BVH tree;
+
+    Scene(int p_count, float p_extent, unsigned p_seed) : random(p_seed), position(0, p_extent) {
+        for (int c = 0; c < p_count; c++) {
+            boxes.push_back(make_box());
+            proxies.push_back(tree.create_proxy(boxes.back(), reinterpret_cast<void*>(c + 1)));
+        }
+    }
+
+    BoundingBox make_box() {
+        vec3 min = vec3(position(random), position(random), position(random));
+        return {min, min + vec3(size(random), size(random), size(random))};
+    }
+
+    int get_index(int p_proxy) const {
+        return int(reinterpret_cast<intptr_t>(tree.get_data(p_proxy))) - 1;
+    }
+
+    std::mt19937 random;
+    std::uniform_real_distribution<float> position;
+    std::uniform_real_distribution<float> size = std::uniform_real_distribution<float>(0.1f, 4.0f);
+};
+
+double get_milliseconds(std::chrono::steady_clock::time_point p_start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p_start)
+        .count();
+}
+
+// Each pair is a point just inside and one just outside one of the six planes.
+void expect_planes(const Frustum& p_frustum, const vec3 (&p_points)[6][2]) {
+    for (int c = 0; c < 6; c++) {
+        EXPECT_TRUE(p_frustum.contains(p_points[c][0])) << "plane " << c;
+        EXPECT_FALSE(p_frustum.contains(p_points[c][1])) << "plane " << c;
+    }
+}
+}  // namespace
+
+// The tree returns boxes grown by a margin, so it must find at least every exact overlap.
+TEST(BVH, QueriesMatchLinearSearch) {
+    Scene scene(2000, 200.0f, 1);
+
+    // Moves and removes some proxies so the incremental updates are covered too.
+    for (int c = 0; c < 500; c++) {
+        scene.boxes[c] = scene.make_box();
+        scene.tree.move_proxy(scene.proxies[c], scene.boxes[c]);
+    }
+
+    for (int c = 1500; c < 2000; c++) scene.tree.destroy_proxy(scene.proxies[c]);
+
+    ASSERT_EQ(scene.tree.get_proxy_count(), 1500);
+    ASSERT_LE(scene.tree.get_height(), 30);
+
+    for (int q = 0; q < 100; q++) {
+        BoundingBox box = scene.make_box().grown(10.0f);
+        std::set<int> found;
+
+        scene.tree.query(box, [&](int p_proxy) {
+            found.insert(scene.get_index(p_proxy));
+            return true;
+        });
+
+        for (int c = 0; c < 1500; c++) {
+            if (scene.boxes[c].intersects(box)) {
+                ASSERT_TRUE(found.count(c));
+            }
+        }
+
+        for (int index : found) ASSERT_TRUE(scene.boxes[index].grown(BVH::MARGIN).intersects(box));
+
+        vec3 center = box.get_center();
+        found.clear();
+
+        scene.tree.query_sphere(center, 15.0f, [&](int p_proxy) {
+            found.insert(scene.get_index(p_proxy));
+            return true;
+        });
+
+        for (int c = 0; c < 1500; c++) {
+            if (scene.boxes[c].intersects(center, 15.0f)) {
+                ASSERT_TRUE(found.count(c));
+            }
+        }
+    }
+}
+
+TEST(BVH, FrustumQuery) {
+    Scene scene(2000, 200.0f, 2);
+
+    mat4 projection, view;
+    projection.perspective(rect2(), 60.0f, 1.0f, 0.1f, 150.0f);
+
+    // From the middle of the scene, so part of it is in view in every direction.
+    view.translate(vec3(-100.0f));
+
+    Frustum frustum(projection * view);
+    std::set<int> found;
+
+    scene.tree.query(frustum, [&](int p_proxy) {
+        found.insert(scene.get_index(p_proxy));
+        return true;
+    });
+
+    int visible = 0;
+
+    for (int c = 0; c < 2000; c++) {
+        if (!frustum.intersects(scene.boxes[c])) continue;
+
+        ASSERT_TRUE(found.count(c));
+        visible++;
+    }
+
+    ASSERT_GT(visible, 0);
+    ASSERT_LT(visible, 2000);
+}
+
+TEST(BVH, FrustumPlanesPerspective) {
+    mat4 projection;
+
+    // 90 degrees, so at a distance d the sides are at x and y = -d and d.
+    projection.perspective(rect2(), 90.0f, 1.0f, 1.0f, 10.0f);
+
+    const vec3 points[6][2] = {
+        {vec3(-4.9f, 0.0f, -5.0f), vec3(-5.1f, 0.0f, -5.0f)},
+        {vec3(4.9f, 0.0f, -5.0f), vec3(5.1f, 0.0f, -5.0f)},
+        {vec3(0.0f, -4.9f, -5.0f), vec3(0.0f, -5.1f, -5.0f)},
+        {vec3(0.0f, 4.9f, -5.0f), vec3(0.0f, 5.1f, -5.0f)},
+        {vec3(0.0f, 0.0f, -1.1f), vec3(0.0f, 0.0f, -0.9f)},
+        {vec3(0.0f, 0.0f, -9.9f), vec3(0.0f, 0.0f, -10.1f)},
+    };
+
+    expect_planes(Frustum(projection), points);
+}
+
+TEST(BVH, FrustumPlanesOrthographic) {
+    mat4 projection;
+
+    // Off center, so a plane mixed up with its opposite one fails.
+    projection.orthographic(rect2(-4.0f, 6.0f, 3.0f, -2.0f), 1.0f, 10.0f);
+
+    const vec3 points[6][2] = {
+        {vec3(-3.9f, 0.0f, -5.0f), vec3(-4.1f, 0.0f, -5.0f)},
+        {vec3(5.9f, 0.0f, -5.0f), vec3(6.1f, 0.0f, -5.0f)},
+        {vec3(0.0f, -1.9f, -5.0f), vec3(0.0f, -2.1f, -5.0f)},
+        {vec3(0.0f, 2.9f, -5.0f), vec3(0.0f, 3.1f, -5.0f)},
+        {vec3(0.0f, 0.0f, -1.1f), vec3(0.0f, 0.0f, -0.9f)},
+        {vec3(0.0f, 0.0f, -9.9f), vec3(0.0f, 0.0f, -10.1f)},
+    };
+
+    expect_planes(Frustum(projection), points);
+}
+
+TEST(BVH, NearestRaycast) {
+    Scene scene(2000, 200.0f, 3);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+    for (int q = 0; q < 100; q++) {
+        vec3 origin = vec3(-10.0f, scene.position(scene.random), scene.position(scene.random));
+        vec3 dir = vec3(1.0f, direction(scene.random) * 0.3f, direction(scene.random) * 0.3f);
+        vec3 inverse = vec3(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+
+        int nearest = -1;
+        float nearest_distance = 1000.0f;
+
+        scene.tree.raycast(origin, dir, 1000.0f, [&](int p_proxy, float) {
+            // The grown box is hit first, the exact box decides.
+            int index = scene.get_index(p_proxy);
+            float distance;
+
+            if (scene.boxes[index].intersects_ray(origin, inverse, nearest_distance, distance) &&
+                distance < nearest_distance) {
+                nearest = index;
+                nearest_distance = distance;
+            }
+
+            return nearest_distance;
+        });
+
+        int expected = -1;
+        float expected_distance = 1000.0f;
+
+        for (int c = 0; c < 2000; c++) {
+            float distance;
+
+            if (scene.boxes[c].intersects_ray(origin, inverse, expected_distance, distance) &&
+                distance < expected_distance) {
+                expected = c;
+                expected_distance = distance;
+            }
+        }
+
+        ASSERT_EQ(nearest, expected);
+    }
+}
+
+// Not a correctness test, prints how building, moving and querying scale compared to testing
+// every box. Disabled, run it with --gtest_also_run_disabled_tests.
+TEST(BVH, DISABLED_Benchmark) {
+    const int counts[] = {1000, 10000, 100000};
+
+    for (int count : counts) {
+        // The density stays the same, so every query returns a similar number of objects.
+        float extent = std::cbrt(float(count)) * 20.0f;
+
+        auto start = std::chrono::steady_clock::now();
+        Scene scene(count, extent, 4);
+        double build = get_milliseconds(start);
+
+        std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+
+        start = std::chrono::steady_clock::now();
+        for (int c = 0; c < count; c++) {
+            vec3 delta = vec3(offset(scene.random), offset(scene.random), offset(scene.random));
+            scene.boxes[c] = {scene.boxes[c].min + delta, scene.boxes[c].max + delta};
+            scene.tree.move_proxy(scene.proxies[c], scene.boxes[c]);
+        }
+        double move = get_milliseconds(start);
+
+        std::vector<BoundingBox> queries;
+        for (int q = 0; q < 1000; q++) queries.push_back(scene.make_box().grown(10.0f));
+
+        int tree_hits = 0, linear_hits = 0;
+
+        start = std::chrono::steady_clock::now();
+        for (const BoundingBox& box : queries) {
+            scene.tree.query(box, [&tree_hits](int) {
+                tree_hits++;
+                return true;
+            });
+        }
+        double tree_query = get_milliseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for (const BoundingBox& box : queries)
+            for (const BoundingBox& object : scene.boxes) linear_hits += object.intersects(box);
+        double linear_query = get_milliseconds(start);
+
+        ASSERT_GE(tree_hits, linear_hits);
+
+        std::cout << count << " objects, height " << scene.tree.get_height()
+                  << ": build " << build << " ms, move all " << move
+                  << " ms, 1000 box queries " << tree_query << " ms (linear " << linear_query
+                  << " ms)" << std::endl;
+    }
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include "world/mesh.h"
+#include "world/model.h"
+
+namespace {
+struct Instances {
+    Mesh* mesh;
+    Model first;
+    Model second;
+
+    Instances() : mesh(make_mesh()), first(mesh), second(mesh) {}
+
+    static Mesh* make_mesh() {
+        Material* material = new Material;
+        material->set_ambient_color(Color::White);
+
+        Mesh* mesh = new Mesh;
+        mesh->set_materials(Array<Variant>(material));
+        return mesh;
+    }
+};
+}  // namespace
+
+TEST(ModelTests, EditMaterialLeavesSiblingsUnchanged) {
+    Instances instances;
+    Material* shared = instances.first.get_material(0);
+    ASSERT_NE(shared, nullptr);
+
+    Material* edited = instances.first.edit_material(0);
+    ASSERT_NE(edited, nullptr);
+    EXPECT_NE(edited, shared);
+    edited->set_ambient_color(Color::Red);
+
+    EXPECT_EQ(instances.first.get_material(0), edited);
+    EXPECT_EQ(instances.second.get_material(0), shared);
+    EXPECT_EQ(shared->get_ambient_color(), Color::White);
+    EXPECT_EQ(instances.first.edit_material(0), edited);
+}
+
+TEST(ModelTests, ClonesShareCopiesUntilEdited) {
+    Instances instances;
+    Material* edited = instances.first.edit_material(0);
+    instances.first.clone_to(&instances.second);
+
+    EXPECT_EQ(instances.second.get_material(0), edited);
+
+    Material* own = instances.second.edit_material(0);
+    own->set_ambient_color(Color::Blue);
+
+    EXPECT_NE(own, edited);
+    EXPECT_EQ(edited->get_ambient_color(), Color::White);
+}
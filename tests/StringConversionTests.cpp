@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+#include "core/serializer.h"
+#include "core/time.h"
+#include "utility/stringutils.h"
+
+static float parse(const char* p_begin, const char* p_end) {
+    float value = 0.0f;
+    EXPECT_NE(StringUtils::parse_float(p_begin, p_end, value), p_begin);
+    return value;
+}
+
+static bool same_bits(float p_left, float p_right) {
+    return memcmp(&p_left, &p_right, sizeof(float)) == 0;
+}
+
+TEST(NumberConversion, FloatRoundTrip) {
+    std::mt19937 random(1234);
+    char buffer[StringUtils::NUMBER_SIZE];
+
+    for (int c = 0; c < 1000000; c++) {
+        uint32_t bits = random();
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+
+        if (!std::isfinite(value)) continue;
+
+        char* end = StringUtils::format_float(buffer, value);
+        ASSERT_TRUE(same_bits(value, parse(buffer, end))) << std::string(buffer, end);
+    }
+}
+
+TEST(NumberConversion, FloatEdgeCases) {
+    const float values[] = {0.0f,
+                            -0.0f,
+                            0.1f,
+                            1.0f / 3.0f,
+                            16777216.0f,
+                            std::numeric_limits<float>::min(),
+                            std::numeric_limits<float>::denorm_min(),
+                            std::numeric_limits<float>::max(),
+                            std::numeric_limits<float>::lowest(),
+                            std::numeric_limits<float>::infinity(),
+                            -std::numeric_limits<float>::infinity()};
+
+    char buffer[StringUtils::NUMBER_SIZE];
+
+    for (float value : values) {
+        char* end = StringUtils::format_float(buffer, value);
+        ASSERT_TRUE(same_bits(value, parse(buffer, end))) << std::string(buffer, end);
+    }
+
+    char* end = StringUtils::format_float(buffer, std::numeric_limits<float>::quiet_NaN());
+    ASSERT_TRUE(std::isnan(parse(buffer, end)));
+
+    ASSERT_EQ(std::string(buffer, StringUtils::format_float(buffer, 0.1f)), "0.1");
+    ASSERT_EQ(std::string(buffer, StringUtils::format_float(buffer, 2.0f)), "2");
+}
+
+TEST(NumberConversion, IntRoundTrip) {
+    const int values[] = {0, 1, -1, 42, std::numeric_limits<int>::max(),
+                          std::numeric_limits<int>::min()};
+
+    for (int value : values) ASSERT_EQ(int(String(value)), value);
+
+    ASSERT_EQ(String(4000000000u), String("4000000000"));
+}
+
+TEST(NumberConversion, StringFormatting) {
+    const float values[] = {0.0f, 1.5f, -2.25f, 1.0f / 3.0f, 123456789.0f, 1e-7f, 16.6667f};
+
+    // String(float) keeps writing floats the way streams do.
+    for (float value : values) {
+        std::stringstream ss;
+        ss << value;
+        ASSERT_EQ(String(value), String(ss.str()));
+    }
+
+    ASSERT_EQ(StringUtils::FloatToString(2.5f), String("2.5"));
+    ASSERT_EQ(StringUtils::FloatToString(2.0f), String("2"));
+    ASSERT_EQ(StringUtils::FloatToString(0.12345f), String("0.123"));
+    ASSERT_EQ(StringUtils::FloatToString(-0.5f), String("-0.5"));
+}
+
+TEST(NumberConversion, StringParsing) {
+    ASSERT_EQ(int(String(" 42")), 42);
+    ASSERT_EQ(int(String("+7")), 7);
+    ASSERT_EQ(int(String("3.9")), 3);
+    ASSERT_EQ(int(String("abc")), 0);
+
+    ASSERT_EQ(float(String("2.5")), 2.5f);
+    ASSERT_EQ(float(String("1e3")), 1000.0f);
+    ASSERT_EQ(float(String("")), 0.0f);
+    ASSERT_EQ(StringUtils::StringToFloat("-0.25"), -0.25f);
+}
+
+TEST(NumberConversion, LeadingWhitespace) {
+    const char* text = "\t\n 12 \r\v\f-1.5 +3";
+    const char* end = text + strlen(text);
+    int whole = 0;
+    float fraction = 0.0f;
+
+    const char* next = StringUtils::parse_int(text, end, whole);
+    ASSERT_EQ(whole, 12);
+
+    next = StringUtils::parse_float(next, end, fraction);
+    ASSERT_EQ(fraction, -1.5f);
+
+    ASSERT_EQ(StringUtils::parse_int(next, end, whole), end);
+    ASSERT_EQ(whole, 3);
+
+    ASSERT_EQ(int(String("\t42")), 42);
+    ASSERT_EQ(float(String("\n 2.5")), 2.5f);
+
+    // Only one sign, and no whitespace after it.
+    const char* invalid = "+ 4";
+    ASSERT_EQ(StringUtils::parse_int(invalid, invalid + 3, whole), invalid);
+}
+
+TEST(NumberConversion, SerializerRoundTrip) {
+    Serializer serializer;
+    std::mt19937 random(5678);
+    std::uniform_real_distribution<float> distribution(-1e6f, 1e6f);
+
+    for (int c = 0; c < 10000; c++) {
+        float x = distribution(random), y = distribution(random) * 1e-9f;
+        float z = distribution(random), w = distribution(random);
+
+        Variant f = serializer.deserialize_value(Variant::FLOAT, serializer.serialize_value(x));
+        ASSERT_TRUE(same_bits(f.f, x));
+
+        Variant v2 =
+            serializer.deserialize_value(Variant::VEC2, serializer.serialize_value(vec2(x, y)));
+        ASSERT_TRUE(same_bits(v2.v2->x, x) && same_bits(v2.v2->y, y));
+
+        Variant v3 = serializer.deserialize_value(Variant::VEC3,
+                                                  serializer.serialize_value(vec3(x, y, z)));
+        ASSERT_TRUE(*v3.v3 == vec3(x, y, z));
+
+        Variant v4 = serializer.deserialize_value(Variant::VEC4,
+                                                  serializer.serialize_value(vec4(x, y, z, w)));
+        ASSERT_TRUE(*v4.v4 == vec4(x, y, z, w));
+
+        Variant color = serializer.deserialize_value(
+            Variant::COLOR, serializer.serialize_value(Color(x, y, z, w)));
+        ASSERT_TRUE(color.c->r == x && color.c->g == y && color.c->b == z && color.c->a == w);
+
+        Transform transform(vec3(x, y, z), vec3(w, x, y), vec3());
+        Variant t =
+            serializer.deserialize_value(Variant::TRANSFORM, serializer.serialize_value(transform));
+        ASSERT_TRUE(t.t->get_pos() == transform.get_pos());
+        ASSERT_TRUE(t.t->get_size() == transform.get_size());
+    }
+}
+
+// Not a correctness test, prints how long writing and reading vectors takes with the previous
+// conversions and with the current ones. Disabled, run it with --gtest_also_run_disabled_tests.
+TEST(NumberConversion, DISABLED_Throughput) {
+    const int count = 200000;
+
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+    std::vector<vec3> values(count);
+
+    for (vec3& value : values)
+        value = vec3(distribution(random), distribution(random), distribution(random));
+
+    Serializer serializer;
+    Stopwatch watch;
+    float checksum = 0.0f;
+
+    watch.start();
+    for (const vec3& value : values) {
+        std::stringstream ss;
+        ss << value.x << ", " << value.y << ", " << value.z;
+
+        Array<String> parts = String(ss.str()).split(',');
+        for (int c = 0; c < parts.size(); c++) checksum += std::stof(parts[c].c_str());
+    }
+    float streams = watch.stop();
+
+    watch.start();
+    for (const vec3& value : values) {
+        String text = serializer.serialize_value(value);
+        checksum += serializer.deserialize_value(Variant::VEC3, text).v3->x;
+    }
+    float current = watch.stop();
+
+    std::cout << count << " vec3 values, streams: " << streams * 1000.0f
+              << " ms, serializer: " << current * 1000.0f << " ms (" << checksum << ")"
+              << std::endl;
+}
+
+TEST(TextEncoding, Utf8RoundTrip) {
+    const uint32_t codepoints[] = {0x24, 0xA2, 0x939, 0x20AC, 0xD55C, 0x10348, 0x10FFFF};
+    char buffer[4];
+
+    for (uint32_t codepoint : codepoints) {
+        char* end = StringUtils::encode_utf8(buffer, codepoint);
+        uint32_t decoded = 0;
+
+        EXPECT_EQ(StringUtils::decode_utf8(buffer, end, decoded), end);
+        EXPECT_EQ(decoded, codepoint);
+    }
+}
+
+TEST(TextEncoding, Utf8Invalid) {
+    // A lone continuation byte, an overlong '/', a surrogate and a truncated sequence.
+    const char* invalid[] = {"\x80", "\xC0\xAF", "\xED\xA0\x80", "\xE2\x82"};
+
+    for (const char* text : invalid) {
+        const char* end = text + strlen(text);
+        uint32_t decoded = 0;
+
+        EXPECT_EQ(StringUtils::decode_utf8(text, end, decoded), text + 1);
+        EXPECT_EQ(decoded, 0xFFFDu);
+    }
+}